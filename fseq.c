@@ -2,6 +2,11 @@
 // Copyright (c) 2019-2021 Darby Johnston
 // All rights reserved.
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// Needed for copy_file_range() and renameat2().
+#define _GNU_SOURCE
+#endif // __linux__
+
 #include "fseq.h"
 
 #include <assert.h>
@@ -9,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #if defined(WIN32) || defined(_WIN32)
 #ifndef WIN32_LEAN_AND_MEAN
@@ -20,7 +26,28 @@
 #include <windows.h>
 #else
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif // __linux__
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _FSEQ_SSE2
 #endif
 
 void fseqFileNameOptionsInit(struct FSeqFileNameOptions* value)
@@ -54,29 +81,32 @@ void fseqFileNameSizesInit(struct FSeqFileNameSizes* value)
      '8' == V || \
      '9' == V)
 
-unsigned short fseqFileNameParseSizes(
+// Parse the file name component sizes of a string with a known length.
+static void _fseqFileNameParseSizes(
     const char*                       in,
+    unsigned short                    len,
     struct FSeqFileNameSizes*         out,
-    size_t                            max,
     const struct FSeqFileNameOptions* options)
 {
-    unsigned short len               = 0;
-    int            lastPathSeparator = -1;
-    int            lastDot           = -1;
-    int            start             = 0;
-    int            end               = 0;
-    const char*    p                 = in;
-    size_t         digits            = 0;
+    int         lastPathSeparator = -1;
+    int         lastDot           = -1;
+    int         start             = 0;
+    int         end               = 0;
+    const char* p                 = in + len;
+    size_t      digits            = 0;
 
-    // Iterate over the characters to find the last path separator,
-    // the last dot, and the end of the string.
-    for (; *p && len < max; ++p, ++len)
+    // Iterate backwards over the characters to find the last path
+    // separator and the last dot after it. Only the last component of the
+    // path is visited.
+    while (p > in)
     {
+        --p;
         if (_IS_PATH_SEPARATOR(*p))
         {
             lastPathSeparator = (int)(p - in);
+            break;
         }
-        else if (_IS_DOT(*p))
+        else if (-1 == lastDot && _IS_DOT(*p))
         {
             lastDot = (int)(p - in);
         }
@@ -137,6 +167,17 @@ unsigned short fseqFileNameParseSizes(
         // Whatever is leftover is the base.
         out->base = end - start + 1;
     }
+}
+
+unsigned short fseqFileNameParseSizes(
+    const char*                       in,
+    struct FSeqFileNameSizes*         out,
+    size_t                            max,
+    const struct FSeqFileNameOptions* options)
+{
+    const char*    end = (const char*)memchr(in, 0, max);
+    unsigned short len = (unsigned short)(end ? (size_t)(end - in) : max);
+    _fseqFileNameParseSizes(in, len, out, options);
     return len;
 }
 
@@ -245,27 +286,498 @@ FSeqBool fseqFileNameMatch(
         FSEQ_FALSE;
 }
 
+void fseqFrameSetInit(struct FSeqFrameSet* value)
+{
+    value->first     = 0;
+    value->words     = NULL;
+    value->wordCount = 0;
+}
+
+void fseqFrameSetDel(struct FSeqFrameSet* value)
+{
+    free(value->words);
+    fseqFrameSetInit(value);
+}
+
+// Bitwise kernels, using SSE2 when it is available.
+static void _fseqWordsOr(uint64_t* dst, const uint64_t* src, size_t count)
+{
+    size_t i = 0;
+#if defined(_FSEQ_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(a, b));
+    }
+#endif // _FSEQ_SSE2
+    for (; i < count; ++i)
+    {
+        dst[i] |= src[i];
+    }
+}
+
+static void _fseqWordsAnd(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t count)
+{
+    size_t i = 0;
+#if defined(_FSEQ_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_and_si128(va, vb));
+    }
+#endif // _FSEQ_SSE2
+    for (; i < count; ++i)
+    {
+        dst[i] = a[i] & b[i];
+    }
+}
+
+static void _fseqWordsAndNot(uint64_t* dst, const uint64_t* src, size_t count)
+{
+    size_t i = 0;
+#if defined(_FSEQ_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_andnot_si128(b, a));
+    }
+#endif // _FSEQ_SSE2
+    for (; i < count; ++i)
+    {
+        dst[i] &= ~src[i];
+    }
+}
+
+static int _fseqPopCount(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ull);
+    value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+    value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (int)((value * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+static int _fseqCountTrailingZeros(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int out = 0;
+    for (; !(value & 1); value >>= 1, ++out)
+        ;
+    return out;
+#endif
+}
+
+#define _FSEQ_WORD_START(V) ((V) & ~(int64_t)63)
+
+// Grow a frame set so that it contains the given range of frames. The set
+// grows geometrically so that adding frames one at a time is not quadratic.
+static FSeqBool _fseqFrameSetReserve(struct FSeqFrameSet* set, int64_t min, int64_t max)
+{
+    int64_t   first = _FSEQ_WORD_START(min);
+    int64_t   last  = _FSEQ_WORD_START(max);
+    uint64_t  span  = 0;
+    size_t    count = 0;
+    uint64_t* words = NULL;
+
+    if (set->wordCount)
+    {
+        const int64_t setLast = set->first + (int64_t)(set->wordCount - 1) * 64;
+        const int64_t extra   = (int64_t)set->wordCount * 64;
+        if (first >= set->first && last <= setLast)
+        {
+            return FSEQ_TRUE;
+        }
+        if (first < set->first)
+        {
+            first = set->first >= INT64_MIN + extra ? FSEQ_MIN(first, set->first - extra) : first;
+        }
+        else
+        {
+            first = set->first;
+        }
+        if (last > setLast)
+        {
+            last = setLast <= INT64_MAX - 63 - extra ? FSEQ_MAX(last, setLast + extra) : last;
+        }
+        else
+        {
+            last = setLast;
+        }
+    }
+
+    span = ((uint64_t)last - (uint64_t)first) >> 6;
+    if (span >= SIZE_MAX / sizeof(uint64_t) - 1)
+    {
+        return FSEQ_FALSE;
+    }
+    count = (size_t)span + 1;
+    words = (uint64_t*)calloc(count, sizeof(uint64_t));
+    if (!words)
+    {
+        return FSEQ_FALSE;
+    }
+    if (set->wordCount)
+    {
+        memcpy(
+            words + (((uint64_t)set->first - (uint64_t)first) >> 6),
+            set->words,
+            set->wordCount * sizeof(uint64_t));
+    }
+    free(set->words);
+    set->first     = first;
+    set->words     = words;
+    set->wordCount = count;
+    return FSEQ_TRUE;
+}
+
+// Remove the empty words from the start and end of a frame set.
+static void _fseqFrameSetTrim(struct FSeqFrameSet* set)
+{
+    size_t start = 0;
+    size_t end   = set->wordCount;
+    for (; start < end && !set->words[start]; ++start)
+        ;
+    for (; end > start && !set->words[end - 1]; --end)
+        ;
+    if (start == end)
+    {
+        fseqFrameSetDel(set);
+    }
+    else if (start > 0 || end < set->wordCount)
+    {
+        memmove(set->words, set->words + start, (end - start) * sizeof(uint64_t));
+        set->first += (int64_t)start * 64;
+        set->wordCount = end - start;
+    }
+}
+
+FSeqBool fseqFrameSetCopy(const struct FSeqFrameSet* value, struct FSeqFrameSet* out)
+{
+    struct FSeqFrameSet tmp;
+    fseqFrameSetInit(&tmp);
+    if (value->wordCount)
+    {
+        tmp.words = (uint64_t*)malloc(value->wordCount * sizeof(uint64_t));
+        if (!tmp.words)
+        {
+            return FSEQ_FALSE;
+        }
+        memcpy(tmp.words, value->words, value->wordCount * sizeof(uint64_t));
+        tmp.first     = value->first;
+        tmp.wordCount = value->wordCount;
+    }
+    fseqFrameSetDel(out);
+    *out = tmp;
+    return FSEQ_TRUE;
+}
+
+FSeqBool fseqFrameSetAdd(struct FSeqFrameSet* set, int64_t frame)
+{
+    uint64_t index = 0;
+    if (!_fseqFrameSetReserve(set, frame, frame))
+    {
+        return FSEQ_FALSE;
+    }
+    index = (uint64_t)frame - (uint64_t)set->first;
+    set->words[index >> 6] |= (uint64_t)1 << (index & 63);
+    return FSEQ_TRUE;
+}
+
+FSeqBool fseqFrameSetAddRange(struct FSeqFrameSet* set, int64_t min, int64_t max)
+{
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (min > max)
+    {
+        const int64_t tmp = min;
+        min = max;
+        max = tmp;
+    }
+    if (!_fseqFrameSetReserve(set, min, max))
+    {
+        return FSEQ_FALSE;
+    }
+    a = (uint64_t)min - (uint64_t)set->first;
+    b = (uint64_t)max - (uint64_t)set->first;
+    if (a >> 6 == b >> 6)
+    {
+        set->words[a >> 6] |= (~(uint64_t)0 << (a & 63)) & (~(uint64_t)0 >> (63 - (b & 63)));
+    }
+    else
+    {
+        set->words[a >> 6] |= ~(uint64_t)0 << (a & 63);
+        for (uint64_t i = (a >> 6) + 1; i < b >> 6; ++i)
+        {
+            set->words[i] = ~(uint64_t)0;
+        }
+        set->words[b >> 6] |= ~(uint64_t)0 >> (63 - (b & 63));
+    }
+    return FSEQ_TRUE;
+}
+
+FSeqBool fseqFrameSetContains(const struct FSeqFrameSet* set, int64_t frame)
+{
+    uint64_t index = 0;
+    if (!set->wordCount || frame < set->first)
+    {
+        return FSEQ_FALSE;
+    }
+    index = (uint64_t)frame - (uint64_t)set->first;
+    if ((index >> 6) >= set->wordCount)
+    {
+        return FSEQ_FALSE;
+    }
+    return (set->words[index >> 6] >> (index & 63)) & 1 ? FSEQ_TRUE : FSEQ_FALSE;
+}
+
+int64_t fseqFrameSetCount(const struct FSeqFrameSet* set)
+{
+    int64_t out = 0;
+    for (size_t i = 0; i < set->wordCount; ++i)
+    {
+        out += _fseqPopCount(set->words[i]);
+    }
+    return out;
+}
+
+FSeqBool fseqFrameSetNext(const struct FSeqFrameSet* set, int64_t frame, int64_t* out)
+{
+    uint64_t index = 0;
+    size_t   i     = 0;
+    uint64_t word  = 0;
+    if (!set->wordCount)
+    {
+        return FSEQ_FALSE;
+    }
+    if (frame < set->first)
+    {
+        frame = set->first;
+    }
+    index = (uint64_t)frame - (uint64_t)set->first;
+    i = (size_t)(index >> 6);
+    if (i >= set->wordCount)
+    {
+        return FSEQ_FALSE;
+    }
+    word = set->words[i] & (~(uint64_t)0 << (index & 63));
+    while (!word)
+    {
+        if (++i >= set->wordCount)
+        {
+            return FSEQ_FALSE;
+        }
+        word = set->words[i];
+    }
+    *out = set->first + (int64_t)i * 64 + _fseqCountTrailingZeros(word);
+    return FSEQ_TRUE;
+}
+
+FSeqBool fseqFrameSetUnion(
+    const struct FSeqFrameSet* a,
+    const struct FSeqFrameSet* b,
+    struct FSeqFrameSet*       out)
+{
+    struct FSeqFrameSet tmp;
+    int64_t             first = 0;
+    int64_t             end   = 0;
+
+    if (!a->wordCount)
+    {
+        return fseqFrameSetCopy(b, out);
+    }
+    else if (!b->wordCount)
+    {
+        return fseqFrameSetCopy(a, out);
+    }
+    first = FSEQ_MIN(a->first, b->first);
+    end   = FSEQ_MAX(a->first + (int64_t)a->wordCount * 64, b->first + (int64_t)b->wordCount * 64);
+    fseqFrameSetInit(&tmp);
+    tmp.first     = first;
+    tmp.wordCount = (size_t)(((uint64_t)end - (uint64_t)first) >> 6);
+    tmp.words     = (uint64_t*)calloc(tmp.wordCount, sizeof(uint64_t));
+    if (!tmp.words)
+    {
+        return FSEQ_FALSE;
+    }
+    memcpy(
+        tmp.words + (((uint64_t)a->first - (uint64_t)first) >> 6),
+        a->words,
+        a->wordCount * sizeof(uint64_t));
+    _fseqWordsOr(
+        tmp.words + (((uint64_t)b->first - (uint64_t)first) >> 6),
+        b->words,
+        b->wordCount);
+    fseqFrameSetDel(out);
+    *out = tmp;
+    return FSEQ_TRUE;
+}
+
+FSeqBool fseqFrameSetIntersection(
+    const struct FSeqFrameSet* a,
+    const struct FSeqFrameSet* b,
+    struct FSeqFrameSet*       out)
+{
+    struct FSeqFrameSet tmp;
+    int64_t             first = 0;
+    int64_t             end   = 0;
+
+    fseqFrameSetInit(&tmp);
+    if (a->wordCount && b->wordCount)
+    {
+        first = FSEQ_MAX(a->first, b->first);
+        end   = FSEQ_MIN(a->first + (int64_t)a->wordCount * 64, b->first + (int64_t)b->wordCount * 64);
+        if (first < end)
+        {
+            tmp.first     = first;
+            tmp.wordCount = (size_t)(((uint64_t)end - (uint64_t)first) >> 6);
+            tmp.words     = (uint64_t*)malloc(tmp.wordCount * sizeof(uint64_t));
+            if (!tmp.words)
+            {
+                return FSEQ_FALSE;
+            }
+            _fseqWordsAnd(
+                tmp.words,
+                a->words + (((uint64_t)first - (uint64_t)a->first) >> 6),
+                b->words + (((uint64_t)first - (uint64_t)b->first) >> 6),
+                tmp.wordCount);
+            _fseqFrameSetTrim(&tmp);
+        }
+    }
+    fseqFrameSetDel(out);
+    *out = tmp;
+    return FSEQ_TRUE;
+}
+
+FSeqBool fseqFrameSetDifference(
+    const struct FSeqFrameSet* a,
+    const struct FSeqFrameSet* b,
+    struct FSeqFrameSet*       out)
+{
+    struct FSeqFrameSet tmp;
+    int64_t             first = 0;
+    int64_t             end   = 0;
+
+    fseqFrameSetInit(&tmp);
+    if (!fseqFrameSetCopy(a, &tmp))
+    {
+        return FSEQ_FALSE;
+    }
+    if (tmp.wordCount && b->wordCount)
+    {
+        first = FSEQ_MAX(tmp.first, b->first);
+        end   = FSEQ_MIN(tmp.first + (int64_t)tmp.wordCount * 64, b->first + (int64_t)b->wordCount * 64);
+        if (first < end)
+        {
+            _fseqWordsAndNot(
+                tmp.words + (((uint64_t)first - (uint64_t)tmp.first) >> 6),
+                b->words + (((uint64_t)first - (uint64_t)b->first) >> 6),
+                (size_t)(((uint64_t)end - (uint64_t)first) >> 6));
+            _fseqFrameSetTrim(&tmp);
+        }
+    }
+    fseqFrameSetDel(out);
+    *out = tmp;
+    return FSEQ_TRUE;
+}
+
 void fseqDirEntryInit(struct FSeqDirEntry* value)
 {
     fseqFileNameInit(&value->fileName);
+    value->name            = NULL;
+    fseqFileNameSizesInit(&value->sizes);
+    value->type            = FSEQ_FILE_TYPE_UNKNOWN;
     value->frameMin        = 0;
     value->frameMax        = 0;
     value->framePadding    = 0;
+    value->frameCount      = 0;
+    fseqFrameSetInit(&value->frames);
     value->next            = NULL;
 }
 
 void fseqDirEntryDel(struct FSeqDirEntry* value)
 {
     fseqFileNameDel(&value->fileName);
+    free(value->name);
+    value->name = NULL;
+    fseqFrameSetDel(&value->frames);
     value->next = NULL;
 }
 
+// Whether the entry is padding notation without frames, for example
+// "render.####.exr" from fseqDirEntryParse().
+static FSeqBool _fseqDirEntryPattern(const struct FSeqDirEntry* value)
+{
+    return
+        value->fileName.number &&
+        '#' == value->fileName.number[0] &&
+        0 == value->frameCount;
+}
+
+FSeqBool fseqDirEntryFrames(const struct FSeqDirEntry* value, struct FSeqFrameSet* out)
+{
+    struct FSeqFrameSet tmp;
+    if (value->frames.wordCount)
+    {
+        return fseqFrameSetCopy(&value->frames, out);
+    }
+    fseqFrameSetInit(&tmp);
+    if (!_fseqDirEntryPattern(value) &&
+        ((value->fileName.number && value->fileName.number[0]) ||
+        (!value->fileName.number && value->sizes.number)))
+    {
+        if (!fseqFrameSetAddRange(&tmp, value->frameMin, value->frameMax))
+        {
+            return FSEQ_FALSE;
+        }
+    }
+    fseqFrameSetDel(out);
+    *out = tmp;
+    return FSEQ_TRUE;
+}
+
+FSeqBool fseqDirEntrySplit(struct FSeqDirEntry* value)
+{
+    if (value->fileName.path &&
+        value->fileName.base &&
+        value->fileName.number &&
+        value->fileName.extension)
+    {
+        return FSEQ_TRUE;
+    }
+    if (!value->name)
+    {
+        return FSEQ_FALSE;
+    }
+    fseqFileNameDel(&value->fileName);
+    if (!fseqFileNameSplit2(value->name, &value->sizes, &value->fileName))
+    {
+        fseqFileNameDel(&value->fileName);
+        return FSEQ_FALSE;
+    }
+    return FSEQ_TRUE;
+}
+
 void fseqDirOptionsInit(struct FSeqDirOptions* value)
 {
     value->dotAndDotDotDirs = FSEQ_FALSE;
     value->dotFiles         = FSEQ_FALSE;
     value->sequence         = FSEQ_TRUE;
+    value->splitFileNames   = FSEQ_TRUE;
+    value->frames           = FSEQ_FALSE;
     fseqFileNameOptionsInit(&value->fileNameOptions);
+    value->timeout          = 0;
+    value->source           = NULL;
+    value->throttle         = NULL;
+    value->throttled        = NULL;
+    value->partial          = NULL;
 }
 
 void fseqDirEntryToString(
@@ -281,7 +793,60 @@ void fseqDirEntryToString(
     assert(max > 0);
     out[0] = 0;
     const size_t l = strlen(PRId64);
-    if (path)
+    if (!value->fileName.base && value->name)
+    {
+        // The file name has not been split into components.
+        const struct FSeqFileNameSizes* sizes = &value->sizes;
+        const char* base = value->name + sizes->path;
+        const char* extension = base + sizes->base + sizes->number;
+        const int pathLen = path ? (int)sizes->path : 0;
+        if (sizes->number && (value->frameMin != value->frameMax))
+        {
+            snprintf(
+                out,
+                max,
+                "%.*s%.*s%0*" PRId64 "-%0*" PRId64 "%.*s",
+                pathLen,
+                value->name,
+                (int)sizes->base,
+                base,
+                (int)value->framePadding,
+                value->frameMin,
+                (int)value->framePadding,
+                value->frameMax,
+                (int)sizes->extension,
+                extension);
+        }
+        else if (sizes->number)
+        {
+            snprintf(
+                out,
+                max,
+                "%.*s%.*s%0*" PRId64 "%.*s",
+                pathLen,
+                value->name,
+                (int)sizes->base,
+                base,
+                (int)value->framePadding,
+                value->frameMin,
+                (int)sizes->extension,
+                extension);
+        }
+        else
+        {
+            snprintf(
+                out,
+                max,
+                "%.*s%.*s%.*s",
+                pathLen,
+                value->name,
+                (int)sizes->base,
+                base,
+                (int)sizes->extension,
+                extension);
+        }
+    }
+    else if (path)
     {
         if (value->fileName.path &&
             value->fileName.base &&
@@ -324,6 +889,18 @@ void fseqDirEntryToString(
                     value->frameMax,
                     value->fileName.extension);
             }
+            else if (_fseqDirEntryPattern(value))
+            {
+                // Padding notation without frames.
+                snprintf(
+                    out,
+                    max,
+                    "%s%s%s%s",
+                    value->fileName.path,
+                    value->fileName.base,
+                    value->fileName.number,
+                    value->fileName.extension);
+            }
             else if (value->fileName.number[0])
             {
                 size_t i = 0;
@@ -409,6 +986,17 @@ void fseqDirEntryToString(
                     value->frameMax,
                     value->fileName.extension);
             }
+            else if (_fseqDirEntryPattern(value))
+            {
+                // Padding notation without frames.
+                snprintf(
+                    out,
+                    max,
+                    "%s%s%s",
+                    value->fileName.base,
+                    value->fileName.number,
+                    value->fileName.extension);
+            }
             else if (value->fileName.number[0])
             {
                 size_t i = 0;
@@ -459,438 +1047,7873 @@ static void _fseqSetError(FSeqBool* error)
     }
 }
 
-struct _FSeqDirEntry
-{
-    char*                    fileName;
-    struct FSeqFileNameSizes sizes;
-    int64_t                  frameMin;
-    int64_t                  frameMax;
-    uint8_t                  framePadding;
-    struct _FSeqDirEntry*    next;
-};
-
-static int64_t _toInt64(const char* value)
+static char* _fseqStrDup(const char* value, size_t len)
 {
-    size_t max = 0;
-    for (; '0' == value[0] && value[1] && max < 256; ++value, ++max)
-        ;
-    return strtoll(value, NULL, 0);
+    char* out = (char*)malloc(len + 1);
+    if (out)
+    {
+        memcpy(out, value, len);
+        out[len] = 0;
+    }
+    return out;
 }
 
-static struct _FSeqDirEntry* _fseqDirEntryCreate(
-    const char*                     fileName,
-    size_t                          fileNameLen,
-    const struct FSeqFileNameSizes* sizes)
+// Format a frame number without using snprintf(), returns the length.
+static size_t _fseqFormatFrame(int64_t value, uint8_t padding, char* out)
 {
-    struct _FSeqDirEntry* out = (struct _FSeqDirEntry*)malloc(sizeof(struct _FSeqDirEntry));
-    if (!out)
+    char     buf[32];
+    size_t   len      = 0;
+    size_t   i        = 0;
+    uint64_t u        = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+
+    do
     {
-        return NULL;
+        buf[len++] = '0' + (char)(u % 10);
+        u /= 10;
+    } while (u);
+    if (value < 0)
+    {
+        out[i++] = '-';
+    }
+    for (; i + len < padding; ++i)
+    {
+        out[i] = '0';
+    }
+    while (len)
+    {
+        out[i++] = buf[--len];
     }
+    out[i] = 0;
+    return i;
+}
+
+FSeqBool fseqDirEntryFrameName(
+    const struct FSeqDirEntry* value,
+    int64_t                    frame,
+    FSeqBool                   path,
+    char*                      out,
+    size_t                     max)
+{
+    const char* dir       = NULL;
+    const char* base      = NULL;
+    const char* extension = NULL;
+    size_t      dirLen    = 0;
+    size_t      baseLen   = 0;
+    size_t      extLen    = 0;
+    FSeqBool    number    = FSEQ_FALSE;
+    char        buf[32];
+    size_t      bufLen    = 0;
 
-    out->fileName = (char*)malloc((fileNameLen + 1) * sizeof(char));
-    if (!out->fileName)
+    if (value->fileName.base)
     {
-        free(out);
-        return NULL;
+        dir       = value->fileName.path ? value->fileName.path : "";
+        base      = value->fileName.base;
+        extension = value->fileName.extension ? value->fileName.extension : "";
+        dirLen    = strlen(dir);
+        baseLen   = strlen(base);
+        extLen    = strlen(extension);
+        number    = value->fileName.number && value->fileName.number[0];
     }
-    memcpy(out->fileName, fileName, fileNameLen);
-    out->fileName[fileNameLen] = 0;
-    
-    out->sizes = *sizes;
-    if (sizes->number)
+    else if (value->name)
     {
-        char buf[FSEQ_STRING_LEN];
-        memcpy(buf, fileName + sizes->path + sizes->base, sizes->number);
-        buf[sizes->number] = 0;
-        out->frameMin = out->frameMax = _toInt64(buf);
-        if ('0' == fileName[sizes->number] && _IS_NUMBER(fileName[sizes->number + 1]))
-        {
-            out->framePadding = (char)FSEQ_MIN(sizes->number, 255);
-        }
-        else
-        {
-            out->framePadding = 0;
-        }
+        dir       = value->name;
+        base      = value->name + value->sizes.path;
+        extension = base + value->sizes.base + value->sizes.number;
+        dirLen    = value->sizes.path;
+        baseLen   = value->sizes.base;
+        extLen    = value->sizes.extension;
+        number    = value->sizes.number > 0;
     }
     else
     {
-        out->frameMin     = 0;
-        out->frameMax     = 0;
-        out->framePadding = 0;
+        return FSEQ_FALSE;
     }
-
-    out->next = NULL;
-    return out;
+    if (!path)
+    {
+        dirLen = 0;
+    }
+    if (number)
+    {
+        bufLen = _fseqFormatFrame(frame, value->framePadding, buf);
+    }
+    if (dirLen + baseLen + bufLen + extLen >= max)
+    {
+        return FSEQ_FALSE;
+    }
+    memcpy(out, dir, dirLen);
+    out += dirLen;
+    memcpy(out, base, baseLen);
+    out += baseLen;
+    memcpy(out, buf, bufLen);
+    out += bufLen;
+    memcpy(out, extension, extLen);
+    out[extLen] = 0;
+    return FSEQ_TRUE;
 }
 
-static void _fseqDirEntryDel(struct _FSeqDirEntry* value)
+// Get the file name of a frame in a directory.
+static FSeqBool _fseqFrameFileName(
+    const char*                path,
+    const struct FSeqDirEntry* entry,
+    int64_t                    frame,
+    char*                      out,
+    size_t                     max)
 {
-    free(value->fileName);
-    value->fileName = NULL;
-    value->next     = NULL;
+    size_t len = 0;
+    if (path)
+    {
+        len = strlen(path);
+        if (len + 1 >= max)
+        {
+            return FSEQ_FALSE;
+        }
+        memcpy(out, path, len);
+    }
+    if (len > 0 && out[len - 1] != '/' && out[len - 1] != '\\')
+    {
+        out[len++] = '/';
+    }
+    return fseqDirEntryFrameName(entry, frame, FSEQ_TRUE, out + len, max - len);
 }
 
-#define _IS_DOT_DIR(V, LEN) \
-    (1 == LEN && '.' == V[0])
-#define _IS_DOT_DOT_DIR(V, LEN) \
-    (2 == LEN && '.' == V[0] && '.' == V[1])
+// This struct provides the components of a parsed file sequence string.
+struct _FSeqParse
+{
+    size_t   path;
+    size_t   base;
+    size_t   number;
+    size_t   extension;
+    FSeqBool pattern;
+    uint8_t  padding;
+};
 
-struct FSeqDirEntry* fseqDirList(
-    const char*                  path,
-    const struct FSeqDirOptions* options,
-    FSeqBool*                    error)
+// Parse a frame number, returns the number of characters consumed or zero.
+static size_t _fseqParseFrame(
+    const char*                       in,
+    size_t                            len,
+    const struct FSeqFileNameOptions* options,
+    int64_t*                          out,
+    uint8_t*                          padding)
 {
-    struct FSeqDirEntry*  out        = NULL;
-    struct FSeqDirEntry*  entry      = NULL;
-    struct _FSeqDirEntry* _entries   = NULL;
-    struct _FSeqDirEntry* _entry     = NULL;
-    struct _FSeqDirEntry* _lastEntry = NULL;
-    struct FSeqDirOptions _options;
-#if defined(WIN32) || defined(_WIN32)
-    char                  glob[FSEQ_STRING_LEN];
-    size_t                pathLen    = 0;
-    int                   wLen       = 0;
-    wchar_t*              wBuf       = NULL;
-    WIN32_FIND_DATAW      ffd;
-    HANDLE                hFind      = NULL;
-#else
-    DIR*                 dir = NULL;
-    const struct dirent* de  = NULL;
-#endif
+    size_t   i        = 0;
+    size_t   digits   = 0;
+    FSeqBool negative = FSEQ_FALSE;
+    int64_t  value    = 0;
 
-    if (!options)
+    if (options && options->negativeNumbers && i < len && '-' == in[i])
     {
-        fseqDirOptionsInit(&_options);
-        options = &_options;
+        negative = FSEQ_TRUE;
+        ++i;
     }
-
-#if defined(WIN32) || defined(_WIN32)
-
-    pathLen = strlen(path);
-    memcpy(glob, path, pathLen);
-    glob[pathLen] = '\\';
-    glob[pathLen + 1] = '*';
-    glob[pathLen + 2] = 0;
-
-    wLen = MultiByteToWideChar(CP_UTF8, 0, glob, -1, NULL, 0);
-    wBuf = malloc(wLen * sizeof(wchar_t));
-    MultiByteToWideChar(CP_UTF8, 0, glob, -1, wBuf, wLen);
-
-    hFind = FindFirstFileW(wBuf, &ffd);
-    if (INVALID_HANDLE_VALUE == hFind)
+    for (; i < len && _IS_NUMBER(in[i]); ++i, ++digits)
     {
-        free(wBuf);
-        _fseqSetError(error);
-        return NULL;
+        if (value > (INT64_MAX - 9) / 10)
+        {
+            return 0;
+        }
+        value = value * 10 + (in[i] - '0');
     }
-
-    do
+    if (0 == digits ||
+        (options && digits + negative >= options->maxNumberDigits))
     {
-        int                      fileNameByteCount = 0;
-        char*                    fileNameBuf       = NULL;
-        struct FSeqFileNameSizes sizes;
-        unsigned short           fileNameLen       = 0;
-        FSeqBool                 filter            = FSEQ_FALSE;
-
-        fileNameByteCount = WideCharToMultiByte(
-            CP_UTF8,
-            0,
-            ffd.cFileName,
-            -1,
-            NULL,
-            0,
-            NULL,
-            NULL);
-        fileNameBuf = malloc(fileNameByteCount);
-        WideCharToMultiByte(
-            CP_UTF8,
-            0,
-            ffd.cFileName,
-            -1,
-            fileNameBuf,
-            fileNameByteCount,
-            NULL,
-            NULL);
+        return 0;
+    }
+    if (!negative && digits > 1 && '0' == in[0])
+    {
+        *padding = (uint8_t)FSEQ_MAX((size_t)*padding, digits);
+    }
+    *out = negative ? -value : value;
+    return i;
+}
 
-        fseqFileNameSizesInit(&sizes);
-        fileNameLen = fseqFileNameParseSizes(
-            fileNameBuf,
-            &sizes,
-            FSEQ_STRING_LEN,
-            &options->fileNameOptions);
+// Parse comma separated frame ranges into pairs of minimum and maximum
+// frames. The "out" buffer is grown as needed. Returns the number of ranges
+// or zero if the string is not a list of frame ranges, or the buffer could
+// not be grown (which also sets the error).
+static size_t _fseqParseRanges(
+    const char*                       in,
+    size_t                            len,
+    const struct FSeqFileNameOptions* options,
+    int64_t**                         out,
+    size_t*                           outSize,
+    uint8_t*                          padding,
+    FSeqBool*                         error)
+{
+    size_t  count = 0;
+    size_t  i     = 0;
+    uint8_t pad   = 0;
 
-        // Filter the entry.
-        if (!options->dotAndDotDotDirs && _IS_DOT_DIR(fileNameBuf, fileNameLen))
-        {
-            filter = FSEQ_TRUE;
-        }
-        else if (!options->dotAndDotDotDirs && _IS_DOT_DOT_DIR(fileNameBuf, fileNameLen))
+    while (i < len)
+    {
+        int64_t a = 0;
+        int64_t b = 0;
+        size_t  n = _fseqParseFrame(in + i, len - i, options, &a, &pad);
+        if (!n)
         {
-            filter = FSEQ_TRUE;
+            return 0;
         }
-        else if (!options->dotFiles && sizes.base)
+        i += n;
+        b = a;
+        if (i < len && '-' == in[i])
         {
-            filter |= '.' == *(fileNameBuf + sizes.path);
+            ++i;
+            n = _fseqParseFrame(in + i, len - i, options, &b, &pad);
+            if (!n)
+            {
+                return 0;
+            }
+            i += n;
         }
-
-        if (!filter)
+        if (i < len)
         {
-            if (!_entries)
+            if (',' != in[i] || i + 1 == len)
             {
-                // Create the first entry in the list.
-                _entries = _fseqDirEntryCreate(fileNameBuf, fileNameLen, &sizes);
-                if (!_entries)
-                {
-                    _fseqSetError(error);
-                    break;
-                }
-                _lastEntry = _entries;
+                return 0;
             }
-            else
+            ++i;
+        }
+        if (count * 2 + 2 > *outSize)
+        {
+            const size_t size = FSEQ_MAX(*outSize * 2, 16);
+            int64_t* tmp = (int64_t*)realloc(*out, size * sizeof(int64_t));
+            if (!tmp)
             {
-                _entry = NULL;
-
-                if (options->sequence && sizes.number > 0)
-                {
-                    // Check if this entry matches any in the list.
-                    _entry = _entries;
-                    while (_entry)
-                    {
-                        if (fseqFileNameMatch(
-                            fileNameBuf,
-                            &sizes,
-                            _entry->fileName,
-                            &_entry->sizes))
-                        {
-                            char buf[FSEQ_STRING_LEN];
-                            int64_t number = 0;
-
-                            memcpy(buf, fileNameBuf + sizes.path + sizes.base, sizes.number);
-                            buf[sizes.number] = 0;
-                            number = _toInt64(buf);
-
-                            //printf("number: %" PRId64 "\n", number);
-
-                            _entry->frameMin = FSEQ_MIN(_entry->frameMin, number);
-                            _entry->frameMax = FSEQ_MAX(_entry->frameMax, number);
-                            if ('0' == buf[0] && _IS_NUMBER(buf[1]))
-                            {
-                                _entry->framePadding = (uint8_t)FSEQ_MIN(
-                                    FSEQ_MAX((size_t)_entry->framePadding, sizes.number),
-                                    255);
-                            }
-                            else
-                            {
-                                _entry->framePadding = 0;
-                            }
-
-                            break;
-                        }
-                        _entry = _entry->next;
-                    }
-                }
-
-                if (!_entry)
-                {
-                    // Create a new entry.
-                    _lastEntry->next = _fseqDirEntryCreate(fileNameBuf, fileNameLen, &sizes);
-                    if (!_lastEntry->next)
-                    {
-                        _fseqSetError(error);
-                        break;
-                    }
-                    _lastEntry = _lastEntry->next;
-                }
+                _fseqSetError(error);
+                return 0;
             }
+            *out = tmp;
+            *outSize = size;
         }
+        (*out)[count * 2]     = FSEQ_MIN(a, b);
+        (*out)[count * 2 + 1] = FSEQ_MAX(a, b);
+        ++count;
+    }
+    if (pad >= 10)
+    {
+        return 0;
+    }
+    *padding = pad;
+    return count;
+}
 
-        free(fileNameBuf);
-
-    } while (FindNextFileW(hFind, &ffd) != 0);
-
-    FindClose(hFind);
-
-    free(wBuf);
+// Split a file sequence string into the path, base, number, and extension.
+// The number may be a padding pattern or a list of frame ranges.
+static void _fseqParseName(
+    const char*                       in,
+    size_t                            len,
+    const struct FSeqFileNameOptions* options,
+    int64_t**                         ranges,
+    size_t*                           rangesSize,
+    size_t*                           rangesCount,
+    struct _FSeqParse*                out,
+    FSeqBool*                         error)
+{
+    int    lastPathSeparator = -1;
+    int    lastDot           = -1;
+    size_t start             = 0;
+    size_t end               = len;
+    size_t i                 = 0;
 
-#else
+    memset(out, 0, sizeof(struct _FSeqParse));
+    *rangesCount = 0;
 
-    dir = opendir(path);
-    if (!dir)
+    for (i = 0; i < len; ++i)
     {
-        _fseqSetError(error);
-        return NULL;
+        if (_IS_PATH_SEPARATOR(in[i]))
+        {
+            lastPathSeparator = (int)i;
+        }
+        else if (_IS_DOT(in[i]))
+        {
+            lastDot = (int)i;
+        }
     }
-
-    while ((de = readdir(dir)))
+    start = (size_t)(lastPathSeparator + 1);
+    if (lastDot > 0 && lastDot > lastPathSeparator + 1)
     {
-        struct FSeqFileNameSizes sizes;
-        unsigned short           fileNameLen = 0;
-        FSeqBool                 filter      = FSEQ_FALSE;
-
-        fseqFileNameSizesInit(&sizes);
-        fileNameLen = fseqFileNameParseSizes(
-            de->d_name,
-            &sizes,
-            FSEQ_STRING_LEN,
-            &options->fileNameOptions);
+        end = (size_t)lastDot;
+    }
+    out->path      = start;
+    out->extension = len - end;
 
-        // Filter the entry.
-        if (!options->dotAndDotDotDirs && _IS_DOT_DIR(de->d_name, fileNameLen))
+    if (end > start && 'd' == in[end - 1])
+    {
+        // Padding notation: "%04d" or "%d".
+        size_t  p       = end - 1;
+        uint8_t padding = 0;
+        while (p > start && _IS_NUMBER(in[p - 1]) && end - p < 4)
         {
-            filter = FSEQ_TRUE;
+            --p;
         }
-        else if (!options->dotAndDotDotDirs && _IS_DOT_DOT_DIR(de->d_name, fileNameLen))
+        for (i = p; i < end - 1; ++i)
         {
-            filter = FSEQ_TRUE;
+            padding = padding * 10 + (in[i] - '0');
         }
-        else if (!options->dotFiles && sizes.base)
+        if (p > start && '%' == in[p - 1] && padding < 10)
         {
-            filter |= '.' == *(de->d_name + sizes.path);
+            out->pattern = FSEQ_TRUE;
+            out->padding = padding;
+            out->number  = end - p + 1;
         }
-
-        if (!filter)
+    }
+    else if (end > start && '#' == in[end - 1])
+    {
+        // Padding notation: "####".
+        size_t p = end - 1;
+        while (p > start && '#' == in[p - 1])
         {
-            if (!_entries)
-            {
-                // Create the first entry in the list.
-                _entries = _fseqDirEntryCreate(de->d_name, fileNameLen, &sizes);
-                if (!_entries)
-                {
-                    _fseqSetError(error);
-                    break;
-                }
-                _lastEntry = _entries;
-            }
-            else
+            --p;
+        }
+        if (end - p < 10)
+        {
+            out->pattern = FSEQ_TRUE;
+            out->padding = end - p > 1 ? (uint8_t)(end - p) : 0;
+            out->number  = end - p;
+        }
+    }
+    else
+    {
+        // Frame ranges, the leftmost position that parses is used.
+        size_t p = end;
+        while (p > start && (_IS_NUMBER(in[p - 1]) || ',' == in[p - 1] || '-' == in[p - 1]))
+        {
+            --p;
+        }
+        for (; p < end; ++p)
+        {
+            *rangesCount = _fseqParseRanges(
+                in + p,
+                end - p,
+                options,
+                ranges,
+                rangesSize,
+                &out->padding,
+                error);
+            if (*rangesCount)
             {
-                _entry = NULL;
-
-                if (options->sequence && sizes.number > 0)
-                {
-                    // Check if this entry matches any already in the list.
-                    _entry = _entries;
-                    while (_entry)
-                    {
-                        if (fseqFileNameMatch(de->d_name, &sizes, _entry->fileName, &_entry->sizes))
-                        {
-                            char buf[FSEQ_STRING_LEN];
-                            int64_t number = 0;
-
-                            memcpy(buf, de->d_name + sizes.path + sizes.base, sizes.number);
-                            buf[sizes.number] = 0;
-                            number = _toInt64(buf);
-
-                            _entry->frameMin = FSEQ_MIN(_entry->frameMin, number);
-                            _entry->frameMax = FSEQ_MAX(_entry->frameMax, number);
-                            if ('0' == buf[0] && _IS_NUMBER(buf[1]))
-                            {
-                                _entry->framePadding = (uint8_t)FSEQ_MIN(
-                                    FSEQ_MAX((size_t)_entry->framePadding, sizes.number),
-                                    255);
-                            }
-                            else
-                            {
-                                _entry->framePadding = 0;
-                            }
-
-                            break;
-                        }
-                        _entry = _entry->next;
-                    }
-                }
-
-                if (!_entry)
-                {
-                    // Create a new entry.
-                    _lastEntry->next = _fseqDirEntryCreate(de->d_name, fileNameLen, &sizes);
-                    if (!_lastEntry->next)
-                    {
-                        _fseqSetError(error);
-                        break;
-                    }
-                    _lastEntry = _lastEntry->next;
-                }
+                out->number = end - p;
+                break;
             }
         }
     }
+    out->base = end - start - out->number;
+}
 
-    closedir(dir);
+static struct FSeqDirEntry* _fseqDirEntryParse(
+    const char*                       in,
+    size_t                            max,
+    const struct FSeqFileNameOptions* options,
+    int64_t**                         ranges,
+    size_t*                           rangesSize,
+    FSeqBool*                         error)
+{
+    struct FSeqDirEntry* out         = NULL;
+    struct FSeqDirEntry* last        = NULL;
+    struct _FSeqParse    parse;
+    size_t               len         = 0;
+    size_t               nameLen     = 0;
+    size_t               rangesCount = 0;
+    size_t               i           = 0;
+    char                 number[32];
 
-#endif
+    for (; len < max && in[len]; ++len)
+        ;
+    if (0 == len)
+    {
+        return NULL;
+    }
 
-    // Create the list of FSeqDirEntry structs to return.
-    _entry = _entries;
-    while (_entry)
+    // Look for frame ranges following the padding notation, for example
+    // "render.%04d.exr 1-100".
+    nameLen = len;
+    for (i = len; i > 0 && ' ' != in[i - 1]; --i)
+        ;
+    if (i > 0 && i < len)
+    {
+        for (nameLen = i - 1; nameLen > 0 && ' ' == in[nameLen - 1]; --nameLen)
+            ;
+        _fseqParseName(in, nameLen, options, ranges, rangesSize, &rangesCount, &parse, error);
+        if (parse.pattern)
+        {
+            uint8_t padding = 0;
+            rangesCount = _fseqParseRanges(in + i, len - i, options, ranges, rangesSize, &padding, error);
+        }
+        if (!parse.pattern || !rangesCount)
+        {
+            nameLen = len;
+        }
+    }
+    if (len == nameLen)
+    {
+        _fseqParseName(in, nameLen, options, ranges, rangesSize, &rangesCount, &parse, error);
+    }
+
+    // Create an entry for each frame range.
+    if (!parse.pattern && 0 == parse.number)
+    {
+        number[0] = 0;
+        rangesCount = 0;
+    }
+    else if (parse.pattern && 0 == rangesCount)
     {
+        // Only the padding is known, there are no frames and the frame
+        // count is zero.
+        const size_t count = FSEQ_MAX(parse.padding, 1);
+        memset(number, '#', count);
+        number[count] = 0;
+    }
+    for (i = 0; i < FSEQ_MAX(rangesCount, 1); ++i)
+    {
+        struct FSeqDirEntry* entry = (struct FSeqDirEntry*)malloc(sizeof(struct FSeqDirEntry));
+        if (!entry)
+        {
+            _fseqSetError(error);
+            break;
+        }
+        fseqDirEntryInit(entry);
         if (!out)
         {
-            out = (struct FSeqDirEntry*)malloc(sizeof(struct FSeqDirEntry));
-            if (!out)
-            {
-                _fseqSetError(error);
-                break;
-            }
-            fseqDirEntryInit(out);
-            if (!fseqFileNameSplit2(
-                _entry->fileName,
-                &_entry->sizes,
-                &out->fileName))
-            {
-                _fseqSetError(error);
-                break;
-            }
-            out->frameMin     = _entry->frameMin;
-            out->frameMax     = _entry->frameMax;
-            out->framePadding = _entry->framePadding;
-            entry = out;
+            out = entry;
         }
         else
         {
-            entry->next = (struct FSeqDirEntry*)malloc(sizeof(struct FSeqDirEntry));
-            if (!entry->next)
-            {
-                _fseqSetError(error);
-                break;
-            }
-            fseqDirEntryInit(entry->next);
-            if (!fseqFileNameSplit2(
-                _entry->fileName,
-                &_entry->sizes,
-                &entry->next->fileName))
-            {
-                _fseqSetError(error);
-                break;
-            }
-            entry->next->frameMin     = _entry->frameMin;
-            entry->next->frameMax     = _entry->frameMax;
-            entry->next->framePadding = _entry->framePadding;
-            entry = entry->next;
+            last->next = entry;
         }
+        last = entry;
 
-        _entry = _entry->next;
+        if (rangesCount)
+        {
+            entry->frameMin = (*ranges)[i * 2];
+            entry->frameMax = (*ranges)[i * 2 + 1];
+            entry->frameCount = entry->frameMax - entry->frameMin + 1;
+            _fseqFormatFrame(entry->frameMin, parse.padding, number);
+        }
+        else if (!parse.pattern)
+        {
+            entry->frameCount = 1;
+        }
+        entry->framePadding       = parse.padding;
+        entry->fileName.path      = _fseqStrDup(in, parse.path);
+        entry->fileName.base      = _fseqStrDup(in + parse.path, parse.base);
+        entry->fileName.number    = _fseqStrDup(number, strlen(number));
+        entry->fileName.extension = _fseqStrDup(in + nameLen - parse.extension, parse.extension);
+        if (!entry->fileName.path ||
+            !entry->fileName.base ||
+            !entry->fileName.number ||
+            !entry->fileName.extension)
+        {
+            _fseqSetError(error);
+            break;
+        }
     }
+    return out;
+}
 
-    // Delete the temoprary list.
-    _entry = _entries;
-    while (_entry)
-    {
-        struct _FSeqDirEntry* tmp = _entry;
-        _entry = _entry->next;
-        _fseqDirEntryDel(tmp);
-        free(tmp);
-    }
+struct FSeqDirEntry* fseqDirEntryParse(
+    const char*                       in,
+    size_t                            max,
+    const struct FSeqFileNameOptions* options,
+    FSeqBool*                         error)
+{
+    struct FSeqDirEntry* out        = NULL;
+    int64_t*             ranges     = NULL;
+    size_t               rangesSize = 0;
 
+    out = _fseqDirEntryParse(in, max, options, &ranges, &rangesSize, error);
+    free(ranges);
     return out;
 }
 
-void fseqDirListDel(struct FSeqDirEntry* value)
+size_t fseqDirEntryParseBatch(
+    const char* const*                in,
+    size_t                            count,
+    struct FSeqDirEntry**             out,
+    size_t                            max,
+    const struct FSeqFileNameOptions* options,
+    FSeqBool*                         error)
 {
-    while (value)
+    size_t   entries    = 0;
+    int64_t* ranges     = NULL;
+    size_t   rangesSize = 0;
+
+    for (size_t i = 0; i < count; ++i)
     {
-        struct FSeqDirEntry* tmp = value;
-        value = value->next;
-        fseqDirEntryDel(tmp);
-        free(tmp);
+        out[i] = _fseqDirEntryParse(in[i], max, options, &ranges, &rangesSize, error);
+        for (const struct FSeqDirEntry* entry = out[i]; entry; entry = entry->next)
+        {
+            ++entries;
+        }
     }
+    free(ranges);
+    return entries;
 }
+
+// The size of the first block of an arena, later blocks double in size up
+// to the maximum.
+#define _FSEQ_ARENA_BLOCK     (64 * 1024)
+#define _FSEQ_ARENA_BLOCK_MAX (4 * 1024 * 1024)
+
+// This struct provides a block of arena memory, the data follows the
+// header.
+struct _FSeqArenaBlock
+{
+    struct _FSeqArenaBlock* next;
+    size_t                  size;
+    size_t                  used;
+};
+
+// This struct provides an arena that hands out memory from large blocks.
+// The memory is not freed individually; the arena is rewound to reuse the
+// blocks, so repeated use does not allocate once the blocks are large
+// enough.
+struct _FSeqArena
+{
+    struct _FSeqArenaBlock* first;
+    struct _FSeqArenaBlock* current;
+};
+
+static void _fseqArenaInit(struct _FSeqArena* value)
+{
+    value->first   = NULL;
+    value->current = NULL;
+}
+
+static void _fseqArenaDel(struct _FSeqArena* value)
+{
+    struct _FSeqArenaBlock* block = value->first;
+    while (block)
+    {
+        struct _FSeqArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    _fseqArenaInit(value);
+}
+
+// Reuse the memory of an arena, everything allocated from it is
+// invalidated.
+static void _fseqArenaRewind(struct _FSeqArena* value)
+{
+    for (struct _FSeqArenaBlock* block = value->first; block; block = block->next)
+    {
+        block->used = 0;
+    }
+    value->current = value->first;
+}
+
+static void* _fseqArenaAlloc(struct _FSeqArena* arena, size_t size)
+{
+    struct _FSeqArenaBlock* block = arena->current;
+    size = (size + 15) & ~(size_t)15;
+
+    // Use the next block that has room, the blocks after the current one
+    // are empty.
+    while (block && block->size - block->used < size)
+    {
+        block = block->next;
+    }
+    if (!block)
+    {
+        const size_t prev  = arena->current ? arena->current->size : 0;
+        size_t       bytes = prev ? FSEQ_MIN(prev * 2, _FSEQ_ARENA_BLOCK_MAX) : _FSEQ_ARENA_BLOCK;
+        bytes = FSEQ_MAX(bytes, size);
+        block = (struct _FSeqArenaBlock*)malloc(sizeof(struct _FSeqArenaBlock) + 16 + bytes);
+        if (!block)
+        {
+            return NULL;
+        }
+        block->size = bytes;
+        block->used = 0;
+        if (arena->current)
+        {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        }
+        else
+        {
+            block->next  = arena->first;
+            arena->first = block;
+        }
+    }
+    arena->current = block;
+    block->used += size;
+    return (char*)block + ((sizeof(struct _FSeqArenaBlock) + 15) & ~(size_t)15) + block->used - size;
+}
+
+// The maximum length of file names stored inline in the _FSeqDirEntry
+// struct, longer file names are allocated separately. The size is chosen so
+// that the fields used for matching fit in a single 64 byte cache line.
+#define _FSEQ_INLINE_NAME_LEN 40
+
+// This struct provides a temporary directory entry used for grouping file
+// names into sequences. The hash is a fingerprint of every file name
+// component except the number, it is compared before the file names.
+struct _FSeqDirEntry
+{
+    uint32_t                 hash;
+    struct FSeqFileNameSizes sizes;
+    unsigned short           fileNameLen;
+    FSeqFileType             type;
+    char*                    fileName;
+    char                     fileNameInline[_FSEQ_INLINE_NAME_LEN];
+    int64_t                  frameMin;
+    int64_t                  frameMax;
+    uint8_t                  framePadding;
+    int64_t                  frameCount;
+    struct _FSeqDirEntry*    next;
+    struct _FSeqDirEntry*    bucketNext;
+    struct FSeqFrameSet      frames;
+};
+
+// Add bytes to a fingerprint, eight bytes at a time.
+static uint64_t _fseqHashBytes(uint64_t hash, const char* p, size_t len)
+{
+    uint64_t word = 0;
+    for (; len >= 8; p += 8, len -= 8)
+    {
+        memcpy(&word, p, 8);
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+    if (len > 0)
+    {
+        word = 0;
+        memcpy(&word, p, len);
+        hash = (hash ^ word ^ ((uint64_t)len << 56)) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// Compute the fingerprint of a file name. The bytes are combined a word at
+// a time in the style of FNV-1a, with an extra shift to mix the high bits.
+static uint32_t _fseqFileNameHash(
+    const char*                     fileName,
+    const struct FSeqFileNameSizes* sizes)
+{
+    uint64_t out = 0xcbf29ce484222325ull ^
+        ((uint64_t)sizes->path << 32 | (uint64_t)sizes->base << 16 | sizes->extension);
+    out = _fseqHashBytes(out, fileName, (size_t)sizes->path + sizes->base);
+    out = _fseqHashBytes(
+        out,
+        fileName + sizes->path + sizes->base + sizes->number,
+        sizes->extension);
+    out *= 0x9e3779b97f4a7c15ull;
+    return (uint32_t)(out >> 32);
+}
+
+// Convert a number in place, without copying it to a temporary buffer.
+static int64_t _fseqParseNumber(const char* value, size_t len)
+{
+    FSeqBool negative = FSEQ_FALSE;
+    int64_t  out      = 0;
+    size_t   i        = 0;
+    if (len > 0 && '-' == value[0])
+    {
+        negative = FSEQ_TRUE;
+        ++i;
+    }
+    for (; i < len; ++i)
+    {
+        if (out > (INT64_MAX - 9) / 10)
+        {
+            out = INT64_MAX;
+            break;
+        }
+        out = out * 10 + (value[i] - '0');
+    }
+    return negative ? -out : out;
+}
+
+// Update the frame padding of a sequence with another frame number. The
+// padding is the smallest number of digits of the zero padded frame
+// numbers, or zero if there are none, so it does not depend on the order
+// of the file names; for example "0999" and "1000" have a padding of four
+// whichever is listed first.
+static uint8_t _fseqFramePadding(
+    const char*    number,
+    unsigned short len,
+    uint8_t        padding)
+{
+    if ('0' == number[0] && len > 1 && _IS_NUMBER(number[1]))
+    {
+        const size_t digits = FSEQ_MIN((size_t)len, 255);
+        return (uint8_t)(padding ? FSEQ_MIN((size_t)padding, digits) : digits);
+    }
+    return padding;
+}
+
+static struct _FSeqDirEntry* _fseqDirEntryCreate(
+    const char*                     fileName,
+    unsigned short                  fileNameLen,
+    const struct FSeqFileNameSizes* sizes,
+    FSeqFileType                    type,
+    uint32_t                        hash,
+    FSeqBool                        frames,
+    struct _FSeqArena*              arena)
+{
+    struct _FSeqDirEntry* out = (struct _FSeqDirEntry*)(arena ?
+        _fseqArenaAlloc(arena, sizeof(struct _FSeqDirEntry)) :
+        malloc(sizeof(struct _FSeqDirEntry)));
+    if (!out)
+    {
+        return NULL;
+    }
+
+    if (fileNameLen < _FSEQ_INLINE_NAME_LEN)
+    {
+        out->fileName = out->fileNameInline;
+    }
+    else
+    {
+        out->fileName = (char*)(arena ?
+            _fseqArenaAlloc(arena, (size_t)fileNameLen + 1) :
+            malloc((size_t)fileNameLen + 1));
+        if (!out->fileName)
+        {
+            if (!arena)
+            {
+                free(out);
+            }
+            return NULL;
+        }
+    }
+    memcpy(out->fileName, fileName, fileNameLen);
+    out->fileName[fileNameLen] = 0;
+    out->fileNameLen = fileNameLen;
+
+    out->hash  = hash;
+    out->sizes = *sizes;
+    out->type  = type;
+    if (sizes->number)
+    {
+        const char* number = fileName + sizes->path + sizes->base;
+        out->frameMin = out->frameMax = _fseqParseNumber(number, sizes->number);
+        out->framePadding = _fseqFramePadding(number, sizes->number, 0);
+    }
+    else
+    {
+        out->frameMin     = 0;
+        out->frameMax     = 0;
+        out->framePadding = 0;
+    }
+    out->frameCount = 1;
+
+    fseqFrameSetInit(&out->frames);
+    if (frames && sizes->number && !fseqFrameSetAdd(&out->frames, out->frameMin))
+    {
+        if (!arena)
+        {
+            if (out->fileName != out->fileNameInline)
+            {
+                free(out->fileName);
+            }
+            free(out);
+        }
+        return NULL;
+    }
+
+    out->next       = NULL;
+    out->bucketNext = NULL;
+    return out;
+}
+
+static void _fseqDirEntryDel(struct _FSeqDirEntry* value)
+{
+    if (value->fileName != value->fileNameInline)
+    {
+        free(value->fileName);
+    }
+    value->fileName = NULL;
+    fseqFrameSetDel(&value->frames);
+    value->next     = NULL;
+}
+
+// The initial number of hash buckets used for grouping.
+#define _FSEQ_GROUP_BUCKETS 64
+
+// This struct provides the state for grouping file names into sequences.
+// The entries that can be extended with more frames are also indexed by
+// their fingerprint, so finding the sequence of a file name does not depend
+// on the number of entries.
+//
+// If the arena is set the entries, the index, and the list created from
+// the group are allocated from it instead of the heap.
+struct _FSeqGroup
+{
+    struct _FSeqDirEntry*  first;
+    struct _FSeqDirEntry*  last;
+    struct _FSeqDirEntry*  match;
+    struct _FSeqDirEntry** buckets;
+    size_t                 bucketCount;
+    size_t                 indexCount;
+    struct _FSeqArena*     arena;
+};
+
+static void _fseqGroupInit(struct _FSeqGroup* value)
+{
+    value->first       = NULL;
+    value->last        = NULL;
+    value->match       = NULL;
+    value->buckets     = NULL;
+    value->bucketCount = 0;
+    value->indexCount  = 0;
+    value->arena       = NULL;
+}
+
+static void _fseqGroupDel(struct _FSeqGroup* value)
+{
+    struct _FSeqDirEntry* entry = value->first;
+    struct _FSeqArena*    arena = value->arena;
+    while (entry)
+    {
+        struct _FSeqDirEntry* tmp = entry;
+        entry = entry->next;
+        if (arena)
+        {
+            fseqFrameSetDel(&tmp->frames);
+        }
+        else
+        {
+            _fseqDirEntryDel(tmp);
+            free(tmp);
+        }
+    }
+    if (!arena)
+    {
+        free(value->buckets);
+    }
+    _fseqGroupInit(value);
+    value->arena = arena;
+}
+
+// Add an entry to the index, doubling the number of buckets when the index
+// is full.
+static FSeqBool _fseqGroupIndex(struct _FSeqGroup* group, struct _FSeqDirEntry* entry)
+{
+    if (group->indexCount >= group->bucketCount)
+    {
+        const size_t           bucketCount = group->bucketCount ?
+            group->bucketCount * 2 :
+            _FSEQ_GROUP_BUCKETS;
+        struct _FSeqDirEntry** buckets     = (struct _FSeqDirEntry**)(group->arena ?
+            _fseqArenaAlloc(group->arena, bucketCount * sizeof(struct _FSeqDirEntry*)) :
+            calloc(bucketCount, sizeof(struct _FSeqDirEntry*)));
+        if (!buckets)
+        {
+            return FSEQ_FALSE;
+        }
+        if (group->arena)
+        {
+            memset(buckets, 0, bucketCount * sizeof(struct _FSeqDirEntry*));
+        }
+        for (size_t i = 0; i < group->bucketCount; ++i)
+        {
+            struct _FSeqDirEntry* tmp = group->buckets[i];
+            while (tmp)
+            {
+                struct _FSeqDirEntry* next = tmp->bucketNext;
+                struct _FSeqDirEntry** bucket = &buckets[tmp->hash & (bucketCount - 1)];
+                tmp->bucketNext = *bucket;
+                *bucket = tmp;
+                tmp = next;
+            }
+        }
+        if (!group->arena)
+        {
+            free(group->buckets);
+        }
+        group->buckets     = buckets;
+        group->bucketCount = bucketCount;
+    }
+    entry->bucketNext = group->buckets[entry->hash & (group->bucketCount - 1)];
+    group->buckets[entry->hash & (group->bucketCount - 1)] = entry;
+    ++group->indexCount;
+    return FSEQ_TRUE;
+}
+
+// Add a file name to the group, either by extending the frame range of a
+// matching sequence or by creating a new entry. Directories are never
+// grouped.
+static FSeqBool _fseqGroupAdd(
+    struct _FSeqGroup*              group,
+    const char*                     fileName,
+    unsigned short                  fileNameLen,
+    const struct FSeqFileNameSizes* sizes,
+    FSeqFileType                    type,
+    const struct FSeqDirOptions*    options)
+{
+    struct _FSeqDirEntry* entry = NULL;
+    uint32_t              hash  = 0;
+    const FSeqBool        index = options->sequence && sizes->number > 0 && type != FSEQ_FILE_TYPE_DIR;
+
+    if (index)
+    {
+        // Sorted file names usually belong to the same sequence as the
+        // previous one, so it is checked before computing the fingerprint.
+        entry = group->match;
+        if (!entry || !fseqFileNameMatch(fileName, sizes, entry->fileName, &entry->sizes))
+        {
+            // Check if this entry matches any already in the index.
+            hash = _fseqFileNameHash(fileName, sizes);
+            entry = group->bucketCount ? group->buckets[hash & (group->bucketCount - 1)] : NULL;
+            for (; entry; entry = entry->bucketNext)
+            {
+                if (hash == entry->hash &&
+                    fseqFileNameMatch(fileName, sizes, entry->fileName, &entry->sizes))
+                {
+                    break;
+                }
+            }
+        }
+        if (entry)
+        {
+            const char*   number = fileName + sizes->path + sizes->base;
+            const int64_t frame  = _fseqParseNumber(number, sizes->number);
+
+            group->match = entry;
+            entry->frameMin = FSEQ_MIN(entry->frameMin, frame);
+            entry->frameMax = FSEQ_MAX(entry->frameMax, frame);
+            ++entry->frameCount;
+            entry->framePadding = _fseqFramePadding(
+                number,
+                sizes->number,
+                entry->framePadding);
+            if (options->frames)
+            {
+                return fseqFrameSetAdd(&entry->frames, frame);
+            }
+            return FSEQ_TRUE;
+        }
+    }
+
+    // Create a new entry.
+    entry = _fseqDirEntryCreate(
+        fileName,
+        fileNameLen,
+        sizes,
+        type,
+        hash,
+        options->frames,
+        group->arena);
+    if (!entry)
+    {
+        return FSEQ_FALSE;
+    }
+    if (index)
+    {
+        if (!_fseqGroupIndex(group, entry))
+        {
+            if (group->arena)
+            {
+                fseqFrameSetDel(&entry->frames);
+            }
+            else
+            {
+                _fseqDirEntryDel(entry);
+                free(entry);
+            }
+            return FSEQ_FALSE;
+        }
+        group->match = entry;
+    }
+    if (!group->first)
+    {
+        group->first = entry;
+    }
+    else
+    {
+        group->last->next = entry;
+    }
+    group->last = entry;
+    return FSEQ_TRUE;
+}
+
+// Copy the name of an entry to the arena, either whole or split into the
+// file name components.
+static FSeqBool _fseqGroupListNames(
+    struct _FSeqArena*          arena,
+    const struct _FSeqDirEntry* in,
+    FSeqBool                    splitFileNames,
+    struct FSeqDirEntry*        out)
+{
+    const struct FSeqFileNameSizes* sizes = &in->sizes;
+    char*                           buf   = (char*)_fseqArenaAlloc(
+        arena,
+        (size_t)in->fileNameLen + (splitFileNames ? 4 : 1));
+    if (!buf)
+    {
+        return FSEQ_FALSE;
+    }
+    if (!splitFileNames)
+    {
+        memcpy(buf, in->fileName, (size_t)in->fileNameLen + 1);
+        out->name = buf;
+        return FSEQ_TRUE;
+    }
+    out->fileName.path = buf;
+    memcpy(buf, in->fileName, sizes->path);
+    buf += sizes->path;
+    *buf++ = 0;
+    out->fileName.base = buf;
+    memcpy(buf, in->fileName + sizes->path, sizes->base);
+    buf += sizes->base;
+    *buf++ = 0;
+    out->fileName.number = buf;
+    memcpy(buf, in->fileName + sizes->path + sizes->base, sizes->number);
+    buf += sizes->number;
+    *buf++ = 0;
+    out->fileName.extension = buf;
+    memcpy(buf, in->fileName + sizes->path + sizes->base + sizes->number, sizes->extension);
+    buf[sizes->extension] = 0;
+    return FSEQ_TRUE;
+}
+
+// Create the list of FSeqDirEntry structs from the group. The frame sets
+// are moved to the list, unless the group is kept for more file names.
+static struct FSeqDirEntry* _fseqGroupList(
+    struct _FSeqGroup* group,
+    FSeqBool           splitFileNames,
+    FSeqBool           keep,
+    FSeqBool*          error)
+{
+    struct FSeqDirEntry*  out    = NULL;
+    struct FSeqDirEntry*  entry  = NULL;
+    struct _FSeqDirEntry* _entry = group->first;
+
+    for (; _entry; _entry = _entry->next)
+    {
+        struct FSeqDirEntry* tmp = (struct FSeqDirEntry*)(group->arena ?
+            _fseqArenaAlloc(group->arena, sizeof(struct FSeqDirEntry)) :
+            malloc(sizeof(struct FSeqDirEntry)));
+        if (!tmp)
+        {
+            _fseqSetError(error);
+            break;
+        }
+        fseqDirEntryInit(tmp);
+        if (!out)
+        {
+            out = tmp;
+        }
+        else
+        {
+            entry->next = tmp;
+        }
+        entry = tmp;
+        if (group->arena)
+        {
+            if (!_fseqGroupListNames(group->arena, _entry, splitFileNames, entry))
+            {
+                _fseqSetError(error);
+                break;
+            }
+        }
+        else if (splitFileNames)
+        {
+            if (!fseqFileNameSplit2(
+                _entry->fileName,
+                &_entry->sizes,
+                &entry->fileName))
+            {
+                _fseqSetError(error);
+                break;
+            }
+        }
+        else
+        {
+            entry->name = _fseqStrDup(_entry->fileName, _entry->fileNameLen);
+            if (!entry->name)
+            {
+                _fseqSetError(error);
+                break;
+            }
+        }
+        entry->sizes        = _entry->sizes;
+        entry->type         = _entry->type;
+        if (!keep)
+        {
+            entry->frames = _entry->frames;
+            fseqFrameSetInit(&_entry->frames);
+        }
+        else if (!fseqFrameSetCopy(&_entry->frames, &entry->frames))
+        {
+            _fseqSetError(error);
+            break;
+        }
+        entry->frameMin     = _entry->frameMin;
+        entry->frameMax     = _entry->frameMax;
+        entry->framePadding = _entry->framePadding;
+        entry->frameCount   = _entry->frameCount;
+    }
+    return out;
+}
+
+// Add the time waited for a throttle to a counter that may be shared by
+// several threads.
+static void _fseqThrottledAdd(int64_t* throttled, int64_t wait)
+{
+    if (throttled && wait > 0)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        InterlockedExchangeAdd64((LONG64 volatile*)throttled, wait);
+#else // WIN32
+        __atomic_fetch_add(throttled, wait, __ATOMIC_RELAXED);
+#endif // WIN32
+    }
+}
+
+// Wait for the throttle of a listing, if there is one.
+static void _fseqDirThrottle(const struct FSeqDirOptions* options, int64_t count)
+{
+    if (options->throttle)
+    {
+        _fseqThrottledAdd(
+            options->throttled,
+            fseqThrottleAcquire(options->throttle, count));
+    }
+}
+
+#define _IS_DOT_DIR(V, LEN) \
+    (1 == LEN && '.' == V[0])
+#define _IS_DOT_DOT_DIR(V, LEN) \
+    (2 == LEN && '.' == V[0] && '.' == V[1])
+
+#if defined(WIN32) || defined(_WIN32)
+
+static wchar_t* _fseqWideString(const char* value)
+{
+    const int wLen = MultiByteToWideChar(CP_UTF8, 0, value, -1, NULL, 0);
+    wchar_t*  out  = (wchar_t*)malloc(wLen * sizeof(wchar_t));
+    if (out)
+    {
+        MultiByteToWideChar(CP_UTF8, 0, value, -1, out, wLen);
+    }
+    return out;
+}
+
+static FSeqFileType _fseqFileTypeFromAttributes(DWORD value)
+{
+    if (value & FILE_ATTRIBUTE_REPARSE_POINT)
+    {
+        return FSEQ_FILE_TYPE_LINK;
+    }
+    else if (value & FILE_ATTRIBUTE_DIRECTORY)
+    {
+        return FSEQ_FILE_TYPE_DIR;
+    }
+    return FSEQ_FILE_TYPE_FILE;
+}
+
+#else
+
+static FSeqFileType _fseqFileTypeFromMode(mode_t value)
+{
+    if (S_ISREG(value))
+    {
+        return FSEQ_FILE_TYPE_FILE;
+    }
+    else if (S_ISDIR(value))
+    {
+        return FSEQ_FILE_TYPE_DIR;
+    }
+    else if (S_ISLNK(value))
+    {
+        return FSEQ_FILE_TYPE_LINK;
+    }
+    return FSEQ_FILE_TYPE_OTHER;
+}
+
+// Get the file type from the directory entry, falling back to fstatat()
+// only when the file system does not provide it. The fstatat() calls are
+// throttled if the listing options are given.
+static FSeqFileType _fseqFileType(
+    DIR*                         dir,
+    const struct dirent*         de,
+    const struct FSeqDirOptions* options)
+{
+    struct stat st;
+#if defined(DT_UNKNOWN)
+    switch (de->d_type)
+    {
+    case DT_REG: return FSEQ_FILE_TYPE_FILE;
+    case DT_DIR: return FSEQ_FILE_TYPE_DIR;
+    case DT_LNK: return FSEQ_FILE_TYPE_LINK;
+    case DT_UNKNOWN: break;
+    default: return FSEQ_FILE_TYPE_OTHER;
+    }
+#endif // DT_UNKNOWN
+    if (options)
+    {
+        _fseqDirThrottle(options, 1);
+    }
+    if (0 == fstatat(dirfd(dir), de->d_name, &st, AT_SYMLINK_NOFOLLOW))
+    {
+        return _fseqFileTypeFromMode(st.st_mode);
+    }
+    return FSEQ_FILE_TYPE_UNKNOWN;
+}
+
+#endif
+
+// Filter a file name from a directory and add it to the group. The file
+// name does not need to be NUL terminated.
+static FSeqBool _fseqDirListAdd(
+    struct _FSeqGroup*           group,
+    const char*                  fileName,
+    size_t                       len,
+    FSeqFileType                 type,
+    const struct FSeqDirOptions* options)
+{
+    struct FSeqFileNameSizes sizes;
+    unsigned short           fileNameLen = (unsigned short)FSEQ_MIN(len, FSEQ_STRING_LEN - 1);
+
+    fseqFileNameSizesInit(&sizes);
+    _fseqFileNameParseSizes(fileName, fileNameLen, &sizes, &options->fileNameOptions);
+
+    // Filter the entry.
+    if (0 == fileNameLen)
+    {
+        return FSEQ_TRUE;
+    }
+    else if (!options->dotAndDotDotDirs && _IS_DOT_DIR(fileName, fileNameLen))
+    {
+        return FSEQ_TRUE;
+    }
+    else if (!options->dotAndDotDotDirs && _IS_DOT_DOT_DIR(fileName, fileNameLen))
+    {
+        return FSEQ_TRUE;
+    }
+    else if (!options->dotFiles && sizes.base && '.' == *(fileName + sizes.path))
+    {
+        return FSEQ_TRUE;
+    }
+
+    return _fseqGroupAdd(group, fileName, fileNameLen, &sizes, type, options);
+}
+
+// The number of entries read from a directory source at a time. The
+// deadline and the cancel callback are checked between batches.
+#define _FSEQ_READ_BATCH 64
+
+// The size of the buffer that holds the names of a batch read from the file
+// system. A batch ends early if the next name might not fit.
+#define _FSEQ_READ_BATCH_NAMES (_FSEQ_READ_BATCH * 256)
+
+#if defined(WIN32) || defined(_WIN32)
+#define _FSEQ_READ_NAME_MAX (MAX_PATH * 3 + 1)
+#else // WIN32
+#define _FSEQ_READ_NAME_MAX (NAME_MAX + 1)
+#endif // WIN32
+
+// This struct provides a directory opened by the file system source. The
+// listing options, if there are any, are passed as the source data.
+struct _FSeqSystemDir
+{
+#if defined(WIN32) || defined(_WIN32)
+    HANDLE                       hFind;
+    WIN32_FIND_DATAW             ffd;
+    FSeqBool                     pending;
+#else // WIN32
+    DIR*                         dir;
+    const struct FSeqDirOptions* options;
+#endif // WIN32
+    char                         names[_FSEQ_READ_BATCH_NAMES];
+};
+
+static void* _fseqSystemDirOpen(void* data, const char* path)
+{
+    struct _FSeqSystemDir* out = (struct _FSeqSystemDir*)malloc(sizeof(struct _FSeqSystemDir));
+#if defined(WIN32) || defined(_WIN32)
+    char     glob[FSEQ_STRING_LEN];
+    size_t   pathLen = strlen(path);
+    wchar_t* wBuf    = NULL;
+#endif // WIN32
+
+    (void)data;
+    if (!out)
+    {
+        return NULL;
+    }
+
+#if defined(WIN32) || defined(_WIN32)
+
+    if (pathLen + 3 > FSEQ_STRING_LEN)
+    {
+        free(out);
+        return NULL;
+    }
+    memcpy(glob, path, pathLen);
+    glob[pathLen] = '\\';
+    glob[pathLen + 1] = '*';
+    glob[pathLen + 2] = 0;
+    wBuf = _fseqWideString(glob);
+    out->hFind = wBuf ? FindFirstFileW(wBuf, &out->ffd) : INVALID_HANDLE_VALUE;
+    free(wBuf);
+    out->pending = INVALID_HANDLE_VALUE != out->hFind;
+    if (!out->pending)
+    {
+        free(out);
+        return NULL;
+    }
+
+#else // WIN32
+
+    out->dir = opendir(path);
+    if (!out->dir)
+    {
+        free(out);
+        return NULL;
+    }
+    out->options = (const struct FSeqDirOptions*)data;
+
+#endif // WIN32
+
+    return out;
+}
+
+static size_t _fseqSystemDirNext(
+    void*                      handle,
+    struct FSeqDirSourceEntry* out,
+    size_t                     max,
+    FSeqBool*                  error)
+{
+    struct _FSeqSystemDir* dir   = (struct _FSeqSystemDir*)handle;
+    size_t                 count = 0;
+    size_t                 size  = 0;
+
+    (void)error;
+    while (count < max && size + _FSEQ_READ_NAME_MAX <= _FSEQ_READ_BATCH_NAMES)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        int len = 0;
+        if (!dir->pending)
+        {
+            break;
+        }
+        len = WideCharToMultiByte(
+            CP_UTF8,
+            0,
+            dir->ffd.cFileName,
+            -1,
+            dir->names + size,
+            _FSEQ_READ_NAME_MAX,
+            NULL,
+            NULL);
+        if (len > 0)
+        {
+            out[count].name = dir->names + size;
+            out[count].len  = (size_t)len - 1;
+            out[count].type = _fseqFileTypeFromAttributes(dir->ffd.dwFileAttributes);
+            size += (size_t)len;
+            ++count;
+        }
+        dir->pending = FindNextFileW(dir->hFind, &dir->ffd) != 0;
+#else // WIN32
+        const struct dirent* de  = readdir(dir->dir);
+        size_t               len = 0;
+        if (!de)
+        {
+            break;
+        }
+        len = strlen(de->d_name);
+        memcpy(dir->names + size, de->d_name, len + 1);
+        out[count].name = dir->names + size;
+        out[count].len  = len;
+        out[count].type = _fseqFileType(dir->dir, de, dir->options);
+        size += len + 1;
+        ++count;
+#endif // WIN32
+    }
+    return count;
+}
+
+static void _fseqSystemDirClose(void* handle)
+{
+    struct _FSeqSystemDir* dir = (struct _FSeqSystemDir*)handle;
+#if defined(WIN32) || defined(_WIN32)
+    FindClose(dir->hFind);
+#else // WIN32
+    closedir(dir->dir);
+#endif // WIN32
+    free(dir);
+}
+
+static const struct FSeqDirSource _fseqSystemSource =
+{
+    _fseqSystemDirOpen,
+    _fseqSystemDirNext,
+    _fseqSystemDirClose,
+    NULL
+};
+
+const struct FSeqDirSource* fseqDirSourceSystem()
+{
+    return &_fseqSystemSource;
+}
+
+// This struct provides a source that serves names from a buffer.
+struct _FSeqMemorySource
+{
+    struct FSeqDirSource source;
+    char*                names;
+    size_t               size;
+    char                 delimiter;
+};
+
+// This struct provides a directory opened from a memory source.
+struct _FSeqMemoryDir
+{
+    const struct _FSeqMemorySource* source;
+    const char*                     path;
+    size_t                          pathLen;
+    size_t                          pos;
+    char                            buf[1];
+};
+
+// Whether the source has a directory entry ("dir/") for the path.
+static FSeqBool _fseqMemorySourceHasDir(
+    const struct _FSeqMemorySource* source,
+    const char*                     path,
+    size_t                          pathLen)
+{
+    const char* const end = source->names + source->size;
+    const char*       p   = source->names;
+    while (p < end)
+    {
+        const char* next = (const char*)memchr(p, source->delimiter, end - p);
+        if (!next)
+        {
+            next = end;
+        }
+        if ((size_t)(next - p) == pathLen + 1 &&
+            0 == memcmp(p, path, pathLen) &&
+            '/' == p[pathLen])
+        {
+            return FSEQ_TRUE;
+        }
+        p = next + 1;
+    }
+    return FSEQ_FALSE;
+}
+
+static void* _fseqMemoryDirOpen(void* data, const char* path)
+{
+    const struct _FSeqMemorySource* source  = (const struct _FSeqMemorySource*)data;
+    struct _FSeqMemoryDir*          out     = NULL;
+    size_t                          pathLen = 0;
+
+    // The paths "", ".", and "./" are the root of the source.
+    while ('.' == path[0] && ('/' == path[1] || 0 == path[1]))
+    {
+        path += '/' == path[1] ? 2 : 1;
+    }
+    pathLen = strlen(path);
+    while (pathLen > 0 && '/' == path[pathLen - 1])
+    {
+        --pathLen;
+    }
+    if (pathLen > 0 && !_fseqMemorySourceHasDir(source, path, pathLen))
+    {
+        return NULL;
+    }
+    out = (struct _FSeqMemoryDir*)malloc(sizeof(struct _FSeqMemoryDir) + pathLen);
+    if (out)
+    {
+        out->source  = source;
+        memcpy(out->buf, path, pathLen);
+        out->buf[pathLen] = 0;
+        out->path    = out->buf;
+        out->pathLen = pathLen;
+        out->pos     = 0;
+    }
+    return out;
+}
+
+static size_t _fseqMemoryDirNext(
+    void*                      handle,
+    struct FSeqDirSourceEntry* out,
+    size_t                     max,
+    FSeqBool*                  error)
+{
+    struct _FSeqMemoryDir*          dir    = (struct _FSeqMemoryDir*)handle;
+    const struct _FSeqMemorySource* source = dir->source;
+    const char* const               end    = source->names + source->size;
+    size_t                          count  = 0;
+
+    (void)error;
+    while (count < max && dir->pos < source->size)
+    {
+        const char*  p     = source->names + dir->pos;
+        const char*  next  = (const char*)memchr(p, source->delimiter, end - p);
+        size_t       len   = 0;
+        FSeqFileType type  = FSEQ_FILE_TYPE_FILE;
+        if (!next)
+        {
+            next = end;
+        }
+        len = next - p;
+        dir->pos += len + 1;
+
+        // Only names directly inside the directory are served.
+        if (dir->pathLen > 0)
+        {
+            if (len <= dir->pathLen + 1 ||
+                memcmp(p, dir->path, dir->pathLen) != 0 ||
+                p[dir->pathLen] != '/')
+            {
+                continue;
+            }
+            p   += dir->pathLen + 1;
+            len -= dir->pathLen + 1;
+        }
+        if (len > 1 && '/' == p[len - 1])
+        {
+            type = FSEQ_FILE_TYPE_DIR;
+            --len;
+        }
+        if (0 == len || memchr(p, '/', len))
+        {
+            continue;
+        }
+        out[count].name = p;
+        out[count].len  = len;
+        out[count].type = type;
+        ++count;
+    }
+    return count;
+}
+
+static void _fseqMemoryDirClose(void* handle)
+{
+    free(handle);
+}
+
+struct FSeqDirSource* fseqDirSourceMemoryCreate(
+    const char* names,
+    size_t      size,
+    char        delimiter,
+    FSeqBool*   error)
+{
+    struct _FSeqMemorySource* out = (struct _FSeqMemorySource*)malloc(sizeof(struct _FSeqMemorySource));
+    if (out)
+    {
+        out->names = (char*)malloc(size + 1);
+    }
+    if (!out || !out->names)
+    {
+        free(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    memcpy(out->names, names, size);
+    out->size          = size;
+    out->delimiter     = delimiter;
+    out->source.open   = _fseqMemoryDirOpen;
+    out->source.next   = _fseqMemoryDirNext;
+    out->source.close  = _fseqMemoryDirClose;
+    out->source.data   = out;
+    return &out->source;
+}
+
+void fseqDirSourceMemoryDel(struct FSeqDirSource* value)
+{
+    if (value)
+    {
+        struct _FSeqMemorySource* source = (struct _FSeqMemorySource*)value;
+        free(source->names);
+        free(source);
+    }
+}
+
+// Callback used to cancel a directory listing.
+typedef FSeqBool (*_FSeqCancel)(void*);
+
+// Get a monotonic time in milliseconds.
+static int64_t _fseqTime()
+{
+#if defined(WIN32) || defined(_WIN32)
+    return (int64_t)GetTickCount64();
+#else // WIN32
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+#endif // WIN32
+}
+
+void fseqThrottleStatsInit(struct FSeqThrottleStats* value)
+{
+    value->operations = 0;
+    value->waits      = 0;
+    value->waitTime   = 0;
+}
+
+// The longest time in microseconds that a throttled operation sleeps before
+// checking the rate again, so rate changes apply to waiting operations.
+#define _FSEQ_THROTTLE_SLEEP 100000
+
+// This struct provides a token bucket. The tokens are added continuously
+// at the rate, up to the burst, and each operation takes one.
+struct FSeqThrottle
+{
+#if defined(WIN32) || defined(_WIN32)
+    CRITICAL_SECTION         mutex;
+#else // WIN32
+    pthread_mutex_t          mutex;
+#endif // WIN32
+    double                   rate;
+    double                   burst;
+    double                   tokens;
+    int64_t                  time;
+    struct FSeqThrottleStats stats;
+};
+
+// Get a monotonic time in microseconds.
+static int64_t _fseqTimeMicro()
+{
+#if defined(WIN32) || defined(_WIN32)
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (int64_t)(counter.QuadPart / frequency.QuadPart * 1000000 +
+        counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#else // WIN32
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+#endif // WIN32
+}
+
+static void _fseqSleepMicro(int64_t value)
+{
+#if defined(WIN32) || defined(_WIN32)
+    Sleep((DWORD)((value + 999) / 1000));
+#else // WIN32
+    struct timespec t;
+    t.tv_sec  = (time_t)(value / 1000000);
+    t.tv_nsec = (long)(value % 1000000) * 1000;
+    nanosleep(&t, NULL);
+#endif // WIN32
+}
+
+static void _fseqThrottleLock(struct FSeqThrottle* throttle)
+{
+#if defined(WIN32) || defined(_WIN32)
+    EnterCriticalSection(&throttle->mutex);
+#else // WIN32
+    pthread_mutex_lock(&throttle->mutex);
+#endif // WIN32
+}
+
+static void _fseqThrottleUnlock(struct FSeqThrottle* throttle)
+{
+#if defined(WIN32) || defined(_WIN32)
+    LeaveCriticalSection(&throttle->mutex);
+#else // WIN32
+    pthread_mutex_unlock(&throttle->mutex);
+#endif // WIN32
+}
+
+// Add the tokens accumulated since the last update.
+static void _fseqThrottleRefill(struct FSeqThrottle* throttle, int64_t now)
+{
+    if (throttle->rate > 0.0)
+    {
+        throttle->tokens = FSEQ_MIN(
+            throttle->tokens + (double)(now - throttle->time) * throttle->rate / 1000000.0,
+            throttle->burst);
+    }
+    throttle->time = now;
+}
+
+static void _fseqThrottleSet(struct FSeqThrottle* throttle, double rate, double burst)
+{
+    throttle->rate  = FSEQ_MAX(rate, 0.0);
+    throttle->burst = FSEQ_MAX(burst > 0.0 ? burst : throttle->rate, 1.0);
+}
+
+struct FSeqThrottle* fseqThrottleCreate(double rate, double burst, FSeqBool* error)
+{
+    struct FSeqThrottle* out = (struct FSeqThrottle*)calloc(1, sizeof(struct FSeqThrottle));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+#if defined(WIN32) || defined(_WIN32)
+    InitializeCriticalSection(&out->mutex);
+#else // WIN32
+    pthread_mutex_init(&out->mutex, NULL);
+#endif // WIN32
+    _fseqThrottleSet(out, rate, burst);
+    out->tokens = out->burst;
+    out->time   = _fseqTimeMicro();
+    fseqThrottleStatsInit(&out->stats);
+    return out;
+}
+
+void fseqThrottleDel(struct FSeqThrottle* value)
+{
+    if (value)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        DeleteCriticalSection(&value->mutex);
+#else // WIN32
+        pthread_mutex_destroy(&value->mutex);
+#endif // WIN32
+        free(value);
+    }
+}
+
+void fseqThrottleSetRate(struct FSeqThrottle* throttle, double rate, double burst)
+{
+    FSeqBool unlimited = FSEQ_FALSE;
+    _fseqThrottleLock(throttle);
+    _fseqThrottleRefill(throttle, _fseqTimeMicro());
+    unlimited = throttle->rate <= 0.0;
+    _fseqThrottleSet(throttle, rate, burst);
+    throttle->tokens = unlimited ? throttle->burst : FSEQ_MIN(throttle->tokens, throttle->burst);
+    _fseqThrottleUnlock(throttle);
+}
+
+int64_t fseqThrottleAcquire(struct FSeqThrottle* throttle, int64_t count)
+{
+    const int64_t start = _fseqTimeMicro();
+    int64_t       now   = start;
+    int64_t       wait  = 0;
+
+    _fseqThrottleLock(throttle);
+    for (;;)
+    {
+        // More operations than the burst wait for a full bucket and leave
+        // it in debt, so they are still limited to the rate over time.
+        const double need = FSEQ_MIN((double)count, throttle->burst);
+        _fseqThrottleRefill(throttle, now);
+        if (throttle->rate <= 0.0 || throttle->tokens >= need)
+        {
+            break;
+        }
+        wait = (int64_t)((need - throttle->tokens) * 1000000.0 / throttle->rate) + 1;
+        _fseqThrottleUnlock(throttle);
+        _fseqSleepMicro(FSEQ_MIN(wait, (int64_t)_FSEQ_THROTTLE_SLEEP));
+        now = _fseqTimeMicro();
+        _fseqThrottleLock(throttle);
+    }
+    if (throttle->rate > 0.0)
+    {
+        throttle->tokens -= (double)count;
+    }
+    wait = now - start;
+    throttle->stats.operations += count;
+    if (wait > 0)
+    {
+        ++throttle->stats.waits;
+        throttle->stats.waitTime += wait;
+    }
+    _fseqThrottleUnlock(throttle);
+    return wait;
+}
+
+void fseqThrottleStats(struct FSeqThrottle* throttle, struct FSeqThrottleStats* out)
+{
+    _fseqThrottleLock(throttle);
+    *out = throttle->stats;
+    _fseqThrottleUnlock(throttle);
+}
+
+// This struct provides an open directory and the file names grouped so
+// far.
+struct FSeqDirCursor
+{
+    struct FSeqDirOptions       options;
+    struct _FSeqGroup           group;
+    FSeqBool                    done;
+    const struct FSeqDirSource* source;
+    void*                       handle;
+};
+
+static FSeqBool _fseqDirCursorOpen(
+    struct FSeqDirCursor*        cursor,
+    const char*                  path,
+    const struct FSeqDirOptions* options)
+{
+    if (options)
+    {
+        cursor->options = *options;
+    }
+    else
+    {
+        fseqDirOptionsInit(&cursor->options);
+    }
+    _fseqGroupInit(&cursor->group);
+    cursor->done   = FSEQ_FALSE;
+    cursor->source = cursor->options.source ? cursor->options.source : &_fseqSystemSource;
+    _fseqDirThrottle(&cursor->options, 1);
+
+    // The file system source is given the options, so getting the status
+    // of entries without a type is also throttled.
+    cursor->handle = cursor->source->open(
+        &_fseqSystemSource == cursor->source ? (void*)&cursor->options : cursor->source->data,
+        path);
+    return cursor->handle != NULL;
+}
+
+static void _fseqDirCursorClose(struct FSeqDirCursor* cursor)
+{
+    if (cursor->handle)
+    {
+        cursor->source->close(cursor->handle);
+        cursor->handle = NULL;
+    }
+    _fseqGroupDel(&cursor->group);
+}
+
+// The results of reading a directory.
+#define _FSEQ_READ_DONE      0
+#define _FSEQ_READ_PARTIAL   1
+#define _FSEQ_READ_CANCELLED 2
+#define _FSEQ_READ_ERROR     3
+
+// Read the directory and group the file names until the end of the
+// directory, the deadline (if it is not zero), or the listing is cancelled.
+// At least one batch is read before the deadline is checked.
+static int _fseqDirCursorRead(
+    struct FSeqDirCursor* cursor,
+    int64_t               deadline,
+    _FSeqCancel           cancel,
+    void*                 cancelData)
+{
+    struct FSeqDirSourceEntry entries[_FSEQ_READ_BATCH];
+    size_t                    count = 0;
+    FSeqBool                  error = FSEQ_FALSE;
+
+    if (cursor->done)
+    {
+        return _FSEQ_READ_DONE;
+    }
+
+    for (;;)
+    {
+        if (cancel && cancel(cancelData))
+        {
+            return _FSEQ_READ_CANCELLED;
+        }
+        _fseqDirThrottle(&cursor->options, 1);
+        count = cursor->source->next(cursor->handle, entries, _FSEQ_READ_BATCH, &error);
+        if (error)
+        {
+            return _FSEQ_READ_ERROR;
+        }
+        if (0 == count)
+        {
+            break;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!_fseqDirListAdd(
+                &cursor->group,
+                entries[i].name,
+                entries[i].len,
+                entries[i].type,
+                &cursor->options))
+            {
+                return _FSEQ_READ_ERROR;
+            }
+        }
+        if (deadline && _fseqTime() >= deadline)
+        {
+            return _FSEQ_READ_PARTIAL;
+        }
+    }
+
+    cursor->done = FSEQ_TRUE;
+    return _FSEQ_READ_DONE;
+}
+
+// List a directory. If the arena is set the list is allocated from it,
+// except for the frame sets.
+static struct FSeqDirEntry* _fseqDirList(
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    _FSeqCancel                  cancel,
+    void*                        cancelData,
+    struct _FSeqArena*           arena,
+    FSeqBool*                    error)
+{
+    struct FSeqDirEntry* out    = NULL;
+    struct FSeqDirCursor cursor;
+    int                  result = _FSEQ_READ_DONE;
+
+    if (!_fseqDirCursorOpen(&cursor, path, options))
+    {
+        _fseqDirCursorClose(&cursor);
+        _fseqSetError(error);
+        return NULL;
+    }
+    cursor.group.arena = arena;
+    result = _fseqDirCursorRead(
+        &cursor,
+        cursor.options.timeout > 0 ? _fseqTime() + cursor.options.timeout : 0,
+        cancel,
+        cancelData);
+    switch (result)
+    {
+    case _FSEQ_READ_DONE:
+    case _FSEQ_READ_PARTIAL:
+        // A partial listing returns the entries grouped before the timeout.
+        out = _fseqGroupList(&cursor.group, cursor.options.splitFileNames, FSEQ_FALSE, error);
+        break;
+    default:
+        _fseqSetError(error);
+        break;
+    }
+    if (cursor.options.partial)
+    {
+        *cursor.options.partial = _FSEQ_READ_PARTIAL == result;
+    }
+    _fseqDirCursorClose(&cursor);
+    return out;
+}
+
+struct FSeqDirCursor* fseqDirCursorCreate(
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    struct FSeqDirCursor* out = (struct FSeqDirCursor*)malloc(sizeof(struct FSeqDirCursor));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    if (!_fseqDirCursorOpen(out, path, options))
+    {
+        fseqDirCursorDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    return out;
+}
+
+void fseqDirCursorDel(struct FSeqDirCursor* value)
+{
+    if (value)
+    {
+        _fseqDirCursorClose(value);
+        free(value);
+    }
+}
+
+struct FSeqDirEntry* fseqDirCursorList(
+    struct FSeqDirCursor* cursor,
+    FSeqBool*             partial,
+    FSeqBool*             error)
+{
+    const int64_t timeout = cursor->options.timeout;
+    const int     result  = _fseqDirCursorRead(
+        cursor,
+        timeout > 0 ? _fseqTime() + timeout : 0,
+        NULL,
+        NULL);
+    if (partial)
+    {
+        *partial = _FSEQ_READ_PARTIAL == result;
+    }
+    if (cursor->options.partial)
+    {
+        *cursor->options.partial = _FSEQ_READ_PARTIAL == result;
+    }
+    if (_FSEQ_READ_ERROR == result)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+
+    // The cursor keeps the grouped entries, so later calls can extend the
+    // sequences, and return the complete listing again.
+    return _fseqGroupList(
+        &cursor->group,
+        cursor->options.splitFileNames,
+        FSEQ_TRUE,
+        error);
+}
+
+struct FSeqDirEntry* fseqDirList(
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    return _fseqDirList(path, options, NULL, NULL, NULL, error);
+}
+
+// This struct provides a directory lister that keeps its memory between
+// listings. The list is allocated from the arena.
+struct FSeqLister
+{
+    struct _FSeqArena    arena;
+    struct FSeqDirEntry* list;
+};
+
+struct FSeqLister* fseqListerCreate(FSeqBool* error)
+{
+    struct FSeqLister* out = (struct FSeqLister*)malloc(sizeof(struct FSeqLister));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    _fseqArenaInit(&out->arena);
+    out->list = NULL;
+    return out;
+}
+
+void fseqListerDel(struct FSeqLister* value)
+{
+    if (value)
+    {
+        fseqListerReset(value);
+        _fseqArenaDel(&value->arena);
+        free(value);
+    }
+}
+
+void fseqListerReset(struct FSeqLister* value)
+{
+    // Only the frame sets are allocated outside of the arena.
+    for (struct FSeqDirEntry* entry = value->list; entry; entry = entry->next)
+    {
+        fseqFrameSetDel(&entry->frames);
+    }
+    value->list = NULL;
+    _fseqArenaRewind(&value->arena);
+}
+
+const struct FSeqDirEntry* fseqListerList(
+    struct FSeqLister*           lister,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    fseqListerReset(lister);
+    lister->list = _fseqDirList(path, options, NULL, NULL, &lister->arena, error);
+    return lister->list;
+}
+
+struct FSeqGroup
+{
+    struct _FSeqGroup     group;
+    struct FSeqDirOptions options;
+};
+
+struct FSeqGroup* fseqGroupCreate(const struct FSeqDirOptions* options, FSeqBool* error)
+{
+    struct FSeqGroup* out = (struct FSeqGroup*)malloc(sizeof(struct FSeqGroup));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    _fseqGroupInit(&out->group);
+    if (options)
+    {
+        out->options = *options;
+    }
+    else
+    {
+        fseqDirOptionsInit(&out->options);
+    }
+    return out;
+}
+
+void fseqGroupDel(struct FSeqGroup* value)
+{
+    if (value)
+    {
+        _fseqGroupDel(&value->group);
+        free(value);
+    }
+}
+
+FSeqBool fseqGroupAdd(
+    struct FSeqGroup* value,
+    const char*       fileName,
+    size_t            len,
+    FSeqFileType      type)
+{
+    struct FSeqFileNameSizes sizes;
+
+    if (0 == len || len >= FSEQ_STRING_LEN)
+    {
+        return FSEQ_FALSE;
+    }
+    fseqFileNameSizesInit(&sizes);
+    _fseqFileNameParseSizes(fileName, (unsigned short)len, &sizes, &value->options.fileNameOptions);
+    return _fseqGroupAdd(&value->group, fileName, (unsigned short)len, &sizes, type, &value->options);
+}
+
+struct FSeqDirEntry* fseqGroupList(struct FSeqGroup* value, FSeqBool* error)
+{
+    struct FSeqDirEntry* out = _fseqGroupList(&value->group, value->options.splitFileNames, FSEQ_FALSE, error);
+    _fseqGroupDel(&value->group);
+    return out;
+}
+
+// This struct provides the state for finding a sequence.
+struct _FSeqFind
+{
+    const char*              fileName;
+    struct FSeqFileNameSizes sizes;
+    FSeqBool                 frames;
+    FSeqBool                 found;
+    FSeqBool                 error;
+    struct FSeqDirEntry*     out;
+};
+
+// Check whether a file name from the directory belongs to the sequence. The
+// base and extension are compared before the file name is parsed. The file
+// name does not need to be NUL terminated.
+static FSeqBool _fseqFindCandidate(
+    const struct _FSeqFind*           find,
+    const char*                       fileName,
+    size_t                            len,
+    const struct FSeqFileNameOptions* options,
+    struct FSeqFileNameSizes*         sizes)
+{
+    const size_t base      = find->sizes.base;
+    const size_t extension = find->sizes.extension;
+    if (find->sizes.number)
+    {
+        if (len <= base + extension ||
+            len >= FSEQ_STRING_LEN ||
+            memcmp(fileName, find->fileName, base) != 0 ||
+            memcmp(fileName + len - extension, find->fileName + base + find->sizes.number, extension) != 0)
+        {
+            return FSEQ_FALSE;
+        }
+        fseqFileNameSizesInit(sizes);
+        _fseqFileNameParseSizes(fileName, (unsigned short)len, sizes, options);
+        return fseqFileNameMatch(find->fileName, &find->sizes, fileName, sizes);
+    }
+    return len == base + extension && 0 == memcmp(fileName, find->fileName, len);
+}
+
+static void _fseqFindAdd(
+    struct _FSeqFind*               find,
+    const char*                     fileName,
+    const struct FSeqFileNameSizes* sizes,
+    FSeqFileType                    type)
+{
+    struct FSeqDirEntry* out    = find->out;
+    const char*          number = fileName + sizes->base;
+    int64_t              frame  = 0;
+
+    if (find->sizes.number && FSEQ_FILE_TYPE_DIR == type)
+    {
+        return;
+    }
+    frame = _fseqParseNumber(number, sizes->number);
+    if (!find->found)
+    {
+        out->frameMin     = frame;
+        out->frameMax     = frame;
+        out->framePadding = sizes->number ? _fseqFramePadding(number, sizes->number, 0) : 0;
+        out->frameCount   = 1;
+        out->type         = type;
+        find->found       = FSEQ_TRUE;
+    }
+    else
+    {
+        out->frameMin     = FSEQ_MIN(out->frameMin, frame);
+        out->frameMax     = FSEQ_MAX(out->frameMax, frame);
+        out->framePadding = _fseqFramePadding(number, sizes->number, out->framePadding);
+        ++out->frameCount;
+    }
+    if (find->frames && find->sizes.number && !fseqFrameSetAdd(&out->frames, frame))
+    {
+        find->error = FSEQ_TRUE;
+    }
+}
+
+FSeqBool fseqDirFindSequence(
+    const char*                  fileName,
+    struct FSeqDirEntry*         out,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    struct FSeqDirOptions     _options;
+    struct FSeqDirCursor      cursor;
+    struct FSeqFileNameSizes  sizes;
+    struct _FSeqFind          find;
+    struct FSeqDirSourceEntry entries[_FSEQ_READ_BATCH];
+    char                      path[FSEQ_STRING_LEN];
+    int64_t                   deadline = 0;
+    size_t                    count    = 0;
+    FSeqBool                  partial  = FSEQ_FALSE;
+
+    if (!options)
+    {
+        fseqDirOptionsInit(&_options);
+        options = &_options;
+    }
+
+    // Parse the file name once, the directory entries are compared against
+    // the base and extension without the path.
+    fseqFileNameSizesInit(&sizes);
+    fseqFileNameParseSizes(fileName, &sizes, FSEQ_STRING_LEN, &options->fileNameOptions);
+    if (sizes.path)
+    {
+        memcpy(path, fileName, sizes.path);
+        path[sizes.path] = 0;
+    }
+    else
+    {
+        path[0] = '.';
+        path[1] = 0;
+    }
+    find.fileName   = fileName + sizes.path;
+    find.sizes      = sizes;
+    find.sizes.path = 0;
+    find.found      = FSEQ_FALSE;
+    find.error      = FSEQ_FALSE;
+    find.out        = out;
+
+    // Read the directory through the source like a listing, but only the
+    // names of the sequence are kept.
+    if (!_fseqDirCursorOpen(&cursor, path, options))
+    {
+        _fseqDirCursorClose(&cursor);
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+    find.frames = cursor.options.frames;
+    if (find.frames)
+    {
+        fseqFrameSetDel(&out->frames);
+    }
+    if (cursor.options.timeout > 0)
+    {
+        deadline = _fseqTime() + cursor.options.timeout;
+    }
+    do
+    {
+        _fseqDirThrottle(&cursor.options, 1);
+        count = cursor.source->next(cursor.handle, entries, _FSEQ_READ_BATCH, &find.error);
+        for (size_t i = 0; i < count; ++i)
+        {
+            struct FSeqFileNameSizes fileNameSizes;
+            if (_fseqFindCandidate(
+                &find,
+                entries[i].name,
+                entries[i].len,
+                &cursor.options.fileNameOptions,
+                &fileNameSizes))
+            {
+                _fseqFindAdd(&find, entries[i].name, &fileNameSizes, entries[i].type);
+            }
+        }
+        partial = count > 0 && deadline && _fseqTime() >= deadline;
+    } while (count > 0 && !find.error && !partial);
+    if (cursor.options.partial)
+    {
+        *cursor.options.partial = partial;
+    }
+    _fseqDirCursorClose(&cursor);
+
+    if (find.error)
+    {
+        _fseqSetError(error);
+    }
+    if (find.found)
+    {
+        fseqFileNameDel(&out->fileName);
+        if (!fseqFileNameSplit2(fileName, &sizes, &out->fileName))
+        {
+            _fseqSetError(error);
+        }
+        free(out->name);
+        out->name  = NULL;
+        out->sizes = sizes;
+    }
+    return find.found;
+}
+
+void fseqDirListDel(struct FSeqDirEntry* value)
+{
+    while (value)
+    {
+        struct FSeqDirEntry* tmp = value;
+        value = value->next;
+        fseqDirEntryDel(tmp);
+        free(tmp);
+    }
+}
+
+// Get the number of worker threads, zero means one per CPU.
+static size_t _fseqThreadCount(size_t threads)
+{
+    if (0 == threads)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        threads = info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else // WIN32
+        const long count = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = count > 0 ? (size_t)count : 1;
+#endif // WIN32
+    }
+    return threads;
+}
+
+// Function called for each item of a parallel loop. The thread index can
+// be used to access per-thread data.
+typedef void (*_FSeqParallelFunc)(void* data, size_t thread, size_t index);
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+// This struct provides the state shared by the threads of a parallel loop.
+struct _FSeqParallel
+{
+    _FSeqParallelFunc func;
+    void*             data;
+    size_t            count;
+    atomic_size_t     next;
+};
+
+struct _FSeqParallelThread
+{
+    struct _FSeqParallel* parallel;
+    size_t                thread;
+};
+
+static void* _fseqParallelThread(void* data)
+{
+    struct _FSeqParallelThread* thread   = (struct _FSeqParallelThread*)data;
+    struct _FSeqParallel*       parallel = thread->parallel;
+    size_t                      i        = 0;
+    while ((i = atomic_fetch_add(&parallel->next, 1)) < parallel->count)
+    {
+        parallel->func(parallel->data, thread->thread, i);
+    }
+    return NULL;
+}
+
+#endif // WIN32
+
+// Call a function for each index from zero to count. The items are handed
+// out to the threads one at a time, so slow items do not hold up the
+// others. The calling thread is used as the first thread, and the items are
+// processed serially on Windows.
+static void _fseqParallelFor(
+    size_t            count,
+    size_t            threads,
+    _FSeqParallelFunc func,
+    void*             data)
+{
+#if defined(WIN32) || defined(_WIN32)
+    for (size_t i = 0; i < count; ++i)
+    {
+        func(data, 0, i);
+    }
+#else // WIN32
+    struct _FSeqParallel        parallel;
+    struct _FSeqParallelThread* thread  = NULL;
+    pthread_t*                  handles = NULL;
+    size_t                      started = 1;
+
+    parallel.func  = func;
+    parallel.data  = data;
+    parallel.count = count;
+    atomic_init(&parallel.next, 0);
+
+    threads = FSEQ_MIN(threads, count);
+    if (threads > 1)
+    {
+        thread  = (struct _FSeqParallelThread*)malloc(threads * sizeof(struct _FSeqParallelThread));
+        handles = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    }
+    if (thread && handles)
+    {
+        for (; started < threads; ++started)
+        {
+            thread[started].parallel = &parallel;
+            thread[started].thread   = started;
+            if (pthread_create(&handles[started], NULL, _fseqParallelThread, &thread[started]) != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    {
+        struct _FSeqParallelThread main;
+        main.parallel = &parallel;
+        main.thread   = 0;
+        _fseqParallelThread(&main);
+    }
+    for (size_t i = 1; i < started; ++i)
+    {
+        pthread_join(handles[i], NULL);
+    }
+    free(thread);
+    free(handles);
+#endif // WIN32
+}
+
+// Allocate a buffer for each thread.
+static char** _fseqBuffersCreate(size_t threads, size_t size)
+{
+    char** out = (char**)calloc(threads, sizeof(char*));
+    for (size_t i = 0; out && i < threads; ++i)
+    {
+        out[i] = (char*)malloc(size);
+        if (!out[i])
+        {
+            for (size_t j = 0; j < i; ++j)
+            {
+                free(out[j]);
+            }
+            free(out);
+            out = NULL;
+        }
+    }
+    return out;
+}
+
+static void _fseqBuffersDel(char** value, size_t threads)
+{
+    for (size_t i = 0; value && i < threads; ++i)
+    {
+        free(value[i]);
+    }
+    free(value);
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+struct FSeqAsync* fseqAsyncCreate(size_t threads, FSeqBool* error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+void fseqAsyncDel(struct FSeqAsync* value)
+{}
+
+int fseqAsyncFd(const struct FSeqAsync* value)
+{
+    return -1;
+}
+
+uint64_t fseqAsyncSubmit(
+    struct FSeqAsync*            value,
+    const char*                  path,
+    const struct FSeqDirOptions* options)
+{
+    return 0;
+}
+
+FSeqBool fseqAsyncCancel(struct FSeqAsync* value, uint64_t id)
+{
+    return FSEQ_FALSE;
+}
+
+FSeqBool fseqAsyncPoll(
+    struct FSeqAsync*     value,
+    uint64_t*             id,
+    struct FSeqDirEntry** out,
+    FSeqBool*             error)
+{
+    return FSEQ_FALSE;
+}
+
+#else // WIN32
+
+// This struct provides an asynchronous listing request.
+struct _FSeqAsyncRequest
+{
+    uint64_t                  id;
+    char*                     path;
+    struct FSeqDirOptions     options;
+    atomic_int                cancel;
+    struct FSeqDirEntry*      result;
+    FSeqBool                  error;
+    FSeqBool                  partial;
+    FSeqBool*                 partialOut;
+    struct _FSeqAsyncRequest* next;
+};
+
+static void _fseqAsyncRequestDel(struct _FSeqAsyncRequest* value)
+{
+    free(value->path);
+    fseqDirListDel(value->result);
+    free(value);
+}
+
+// This struct provides a FIFO queue of requests.
+struct _FSeqAsyncQueue
+{
+    struct _FSeqAsyncRequest* first;
+    struct _FSeqAsyncRequest* last;
+};
+
+static void _fseqAsyncQueuePush(struct _FSeqAsyncQueue* queue, struct _FSeqAsyncRequest* request)
+{
+    request->next = NULL;
+    if (queue->last)
+    {
+        queue->last->next = request;
+    }
+    else
+    {
+        queue->first = request;
+    }
+    queue->last = request;
+}
+
+static struct _FSeqAsyncRequest* _fseqAsyncQueuePop(struct _FSeqAsyncQueue* queue)
+{
+    struct _FSeqAsyncRequest* out = queue->first;
+    if (out)
+    {
+        queue->first = out->next;
+        if (!queue->first)
+        {
+            queue->last = NULL;
+        }
+        out->next = NULL;
+    }
+    return out;
+}
+
+// Remove a request from a queue by ID.
+static struct _FSeqAsyncRequest* _fseqAsyncQueueRemove(struct _FSeqAsyncQueue* queue, uint64_t id)
+{
+    struct _FSeqAsyncRequest* prev = NULL;
+    struct _FSeqAsyncRequest* out  = queue->first;
+    for (; out; prev = out, out = out->next)
+    {
+        if (id == out->id)
+        {
+            if (prev)
+            {
+                prev->next = out->next;
+            }
+            else
+            {
+                queue->first = out->next;
+            }
+            if (queue->last == out)
+            {
+                queue->last = prev;
+            }
+            out->next = NULL;
+            break;
+        }
+    }
+    return out;
+}
+
+static void _fseqAsyncQueueDel(struct _FSeqAsyncQueue* queue)
+{
+    struct _FSeqAsyncRequest* request = NULL;
+    while ((request = _fseqAsyncQueuePop(queue)))
+    {
+        _fseqAsyncRequestDel(request);
+    }
+}
+
+struct FSeqAsync
+{
+    pthread_mutex_t            mutex;
+    pthread_cond_t             cond;
+    pthread_t*                 threads;
+    size_t                     threadCount;
+    FSeqBool                   stop;
+    uint64_t                   id;
+    struct _FSeqAsyncQueue     pending;
+    struct _FSeqAsyncQueue     completed;
+    struct _FSeqAsyncRequest** running;
+    int                        fd[2];
+};
+
+// Signal that a request has completed, one count per request.
+static void _fseqAsyncSignal(struct FSeqAsync* value)
+{
+#if defined(__linux__)
+    const uint64_t one = 1;
+    ssize_t r = write(value->fd[1], &one, sizeof(uint64_t));
+#else
+    const char one = 1;
+    ssize_t r = write(value->fd[1], &one, 1);
+#endif
+    (void)r;
+}
+
+// Consume the signal for a collected request.
+static void _fseqAsyncUnsignal(struct FSeqAsync* value)
+{
+#if defined(__linux__)
+    uint64_t count = 0;
+    ssize_t r = read(value->fd[0], &count, sizeof(uint64_t));
+#else
+    char count = 0;
+    ssize_t r = read(value->fd[0], &count, 1);
+#endif
+    (void)r;
+}
+
+static FSeqBool _fseqAsyncCancelled(void* data)
+{
+    struct _FSeqAsyncRequest* request = (struct _FSeqAsyncRequest*)data;
+    return atomic_load_explicit(&request->cancel, memory_order_relaxed) ? FSEQ_TRUE : FSEQ_FALSE;
+}
+
+struct _FSeqAsyncThread
+{
+    struct FSeqAsync* async;
+    size_t            index;
+};
+
+static void* _fseqAsyncThread(void* data)
+{
+    struct FSeqAsync* value = ((struct _FSeqAsyncThread*)data)->async;
+    const size_t      index = ((struct _FSeqAsyncThread*)data)->index;
+    free(data);
+
+    pthread_mutex_lock(&value->mutex);
+    while (!value->stop)
+    {
+        struct _FSeqAsyncRequest* request = _fseqAsyncQueuePop(&value->pending);
+        if (!request)
+        {
+            pthread_cond_wait(&value->cond, &value->mutex);
+            continue;
+        }
+        value->running[index] = request;
+        pthread_mutex_unlock(&value->mutex);
+
+        request->result = _fseqDirList(
+            request->path,
+            &request->options,
+            _fseqAsyncCancelled,
+            request,
+            NULL,
+            &request->error);
+
+        pthread_mutex_lock(&value->mutex);
+        value->running[index] = NULL;
+        if (atomic_load(&request->cancel))
+        {
+            _fseqAsyncRequestDel(request);
+        }
+        else
+        {
+            _fseqAsyncQueuePush(&value->completed, request);
+            _fseqAsyncSignal(value);
+        }
+    }
+    pthread_mutex_unlock(&value->mutex);
+    return NULL;
+}
+
+struct FSeqAsync* fseqAsyncCreate(size_t threads, FSeqBool* error)
+{
+    struct FSeqAsync* out = NULL;
+
+    threads = _fseqThreadCount(threads);
+    out = (struct FSeqAsync*)calloc(1, sizeof(struct FSeqAsync));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    pthread_mutex_init(&out->mutex, NULL);
+    pthread_cond_init(&out->cond, NULL);
+    out->threads = (pthread_t*)calloc(threads, sizeof(pthread_t));
+    out->running = (struct _FSeqAsyncRequest**)calloc(threads, sizeof(struct _FSeqAsyncRequest*));
+#if defined(__linux__)
+    out->fd[0] = out->fd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC | EFD_SEMAPHORE);
+    if (!out->threads || !out->running || -1 == out->fd[0])
+#else
+    out->fd[0] = out->fd[1] = -1;
+    if (!out->threads || !out->running || pipe(out->fd) != 0 ||
+        fcntl(out->fd[0], F_SETFL, O_NONBLOCK) != 0 ||
+        fcntl(out->fd[1], F_SETFL, O_NONBLOCK) != 0)
+#endif
+    {
+        fseqAsyncDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+
+    for (; out->threadCount < threads; ++out->threadCount)
+    {
+        struct _FSeqAsyncThread* data = (struct _FSeqAsyncThread*)malloc(sizeof(struct _FSeqAsyncThread));
+        if (!data)
+        {
+            break;
+        }
+        data->async = out;
+        data->index = out->threadCount;
+        if (pthread_create(&out->threads[out->threadCount], NULL, _fseqAsyncThread, data) != 0)
+        {
+            free(data);
+            break;
+        }
+    }
+    if (out->threadCount < threads)
+    {
+        fseqAsyncDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    return out;
+}
+
+void fseqAsyncDel(struct FSeqAsync* value)
+{
+    if (!value)
+    {
+        return;
+    }
+    if (value->threadCount)
+    {
+        pthread_mutex_lock(&value->mutex);
+        value->stop = FSEQ_TRUE;
+        for (size_t i = 0; i < value->threadCount; ++i)
+        {
+            if (value->running[i])
+            {
+                atomic_store(&value->running[i]->cancel, 1);
+            }
+        }
+        pthread_cond_broadcast(&value->cond);
+        pthread_mutex_unlock(&value->mutex);
+        for (size_t i = 0; i < value->threadCount; ++i)
+        {
+            pthread_join(value->threads[i], NULL);
+        }
+    }
+    pthread_mutex_destroy(&value->mutex);
+    pthread_cond_destroy(&value->cond);
+    _fseqAsyncQueueDel(&value->pending);
+    _fseqAsyncQueueDel(&value->completed);
+    if (value->fd[0] != -1)
+    {
+        close(value->fd[0]);
+    }
+    if (value->fd[1] != -1 && value->fd[1] != value->fd[0])
+    {
+        close(value->fd[1]);
+    }
+    free(value->threads);
+    free(value->running);
+    free(value);
+}
+
+int fseqAsyncFd(const struct FSeqAsync* value)
+{
+    return value->fd[0];
+}
+
+uint64_t fseqAsyncSubmit(
+    struct FSeqAsync*            value,
+    const char*                  path,
+    const struct FSeqDirOptions* options)
+{
+    uint64_t                  out     = 0;
+    struct _FSeqAsyncRequest* request = NULL;
+
+    request = (struct _FSeqAsyncRequest*)calloc(1, sizeof(struct _FSeqAsyncRequest));
+    if (!request)
+    {
+        return 0;
+    }
+    request->path = _fseqStrDup(path, strlen(path));
+    if (!request->path)
+    {
+        free(request);
+        return 0;
+    }
+    if (options)
+    {
+        request->options = *options;
+    }
+    else
+    {
+        fseqDirOptionsInit(&request->options);
+    }
+
+    // The caller's partial flag is set when the result is collected, not
+    // from the worker thread.
+    request->partialOut = request->options.partial;
+    request->options.partial = &request->partial;
+    atomic_init(&request->cancel, 0);
+
+    pthread_mutex_lock(&value->mutex);
+    out = request->id = ++value->id;
+    _fseqAsyncQueuePush(&value->pending, request);
+    pthread_cond_signal(&value->cond);
+    pthread_mutex_unlock(&value->mutex);
+    return out;
+}
+
+FSeqBool fseqAsyncCancel(struct FSeqAsync* value, uint64_t id)
+{
+    FSeqBool                  out     = FSEQ_FALSE;
+    struct _FSeqAsyncRequest* request = NULL;
+
+    pthread_mutex_lock(&value->mutex);
+    if ((request = _fseqAsyncQueueRemove(&value->pending, id)))
+    {
+        _fseqAsyncRequestDel(request);
+        out = FSEQ_TRUE;
+    }
+    else if ((request = _fseqAsyncQueueRemove(&value->completed, id)))
+    {
+        _fseqAsyncUnsignal(value);
+        _fseqAsyncRequestDel(request);
+        out = FSEQ_TRUE;
+    }
+    else
+    {
+        // The worker thread deletes the request when the listing stops.
+        for (size_t i = 0; i < value->threadCount; ++i)
+        {
+            if (value->running[i] && id == value->running[i]->id)
+            {
+                atomic_store(&value->running[i]->cancel, 1);
+                out = FSEQ_TRUE;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&value->mutex);
+    return out;
+}
+
+FSeqBool fseqAsyncPoll(
+    struct FSeqAsync*     value,
+    uint64_t*             id,
+    struct FSeqDirEntry** out,
+    FSeqBool*             error)
+{
+    struct _FSeqAsyncRequest* request = NULL;
+
+    pthread_mutex_lock(&value->mutex);
+    request = _fseqAsyncQueuePop(&value->completed);
+    if (request)
+    {
+        _fseqAsyncUnsignal(value);
+    }
+    pthread_mutex_unlock(&value->mutex);
+    if (!request)
+    {
+        return FSEQ_FALSE;
+    }
+
+    if (id)
+    {
+        *id = request->id;
+    }
+    *out = request->result;
+    request->result = NULL;
+    if (request->partialOut)
+    {
+        *request->partialOut = request->partial;
+    }
+    if (request->error)
+    {
+        _fseqSetError(error);
+    }
+    _fseqAsyncRequestDel(request);
+    return FSEQ_TRUE;
+}
+
+#endif // WIN32
+
+#define _FSEQ_XXH_PRIME1 0x9E3779B185EBCA87ull
+#define _FSEQ_XXH_PRIME2 0xC2B2AE3D27D4EB4Full
+#define _FSEQ_XXH_PRIME3 0x165667B19E3779F9ull
+#define _FSEQ_XXH_PRIME4 0x85EBCA77C2B2AE63ull
+#define _FSEQ_XXH_PRIME5 0x27D4EB2F165667C5ull
+
+#define _FSEQ_ROTL64(V, R) (((V) << (R)) | ((V) >> (64 - (R))))
+
+static uint64_t _fseqRead64(const unsigned char* p)
+{
+    uint64_t out = 0;
+    memcpy(&out, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    out = __builtin_bswap64(out);
+#endif // __BYTE_ORDER__
+    return out;
+}
+
+static uint32_t _fseqRead32(const unsigned char* p)
+{
+    uint32_t out = 0;
+    memcpy(&out, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    out = __builtin_bswap32(out);
+#endif // __BYTE_ORDER__
+    return out;
+}
+
+static uint64_t _fseqXXHRound(uint64_t acc, uint64_t input)
+{
+    acc += input * _FSEQ_XXH_PRIME2;
+    acc  = _FSEQ_ROTL64(acc, 31);
+    return acc * _FSEQ_XXH_PRIME1;
+}
+
+static uint64_t _fseqXXHMerge(uint64_t acc, uint64_t value)
+{
+    acc ^= _fseqXXHRound(0, value);
+    return acc * _FSEQ_XXH_PRIME1 + _FSEQ_XXH_PRIME4;
+}
+
+// This struct provides the state for computing a hash incrementally.
+struct _FSeqHash64
+{
+    uint64_t      v[4];
+    uint64_t      total;
+    unsigned char buf[32];
+    size_t        bufSize;
+    uint64_t      seed;
+};
+
+static void _fseqHash64Init(struct _FSeqHash64* value, uint64_t seed)
+{
+    value->v[0]    = seed + _FSEQ_XXH_PRIME1 + _FSEQ_XXH_PRIME2;
+    value->v[1]    = seed + _FSEQ_XXH_PRIME2;
+    value->v[2]    = seed;
+    value->v[3]    = seed - _FSEQ_XXH_PRIME1;
+    value->total   = 0;
+    value->bufSize = 0;
+    value->seed    = seed;
+}
+
+// Process 32 byte stripes, the four lanes are independent so they can be
+// computed in parallel by the CPU.
+static const unsigned char* _fseqHash64Stripes(
+    uint64_t*            v,
+    const unsigned char* p,
+    const unsigned char* end)
+{
+    uint64_t v0 = v[0];
+    uint64_t v1 = v[1];
+    uint64_t v2 = v[2];
+    uint64_t v3 = v[3];
+    for (; p + 32 <= end; p += 32)
+    {
+        v0 = _fseqXXHRound(v0, _fseqRead64(p));
+        v1 = _fseqXXHRound(v1, _fseqRead64(p + 8));
+        v2 = _fseqXXHRound(v2, _fseqRead64(p + 16));
+        v3 = _fseqXXHRound(v3, _fseqRead64(p + 24));
+    }
+    v[0] = v0;
+    v[1] = v1;
+    v[2] = v2;
+    v[3] = v3;
+    return p;
+}
+
+static void _fseqHash64Update(struct _FSeqHash64* value, const void* data, size_t size)
+{
+    const unsigned char*       p   = (const unsigned char*)data;
+    const unsigned char* const end = p + size;
+
+    value->total += size;
+    if (value->bufSize + size < 32)
+    {
+        memcpy(value->buf + value->bufSize, p, size);
+        value->bufSize += size;
+        return;
+    }
+    if (value->bufSize > 0)
+    {
+        const size_t fill = 32 - value->bufSize;
+        memcpy(value->buf + value->bufSize, p, fill);
+        _fseqHash64Stripes(value->v, value->buf, value->buf + 32);
+        p += fill;
+        value->bufSize = 0;
+    }
+    p = _fseqHash64Stripes(value->v, p, end);
+    value->bufSize = end - p;
+    memcpy(value->buf, p, value->bufSize);
+}
+
+static uint64_t _fseqHash64Digest(const struct _FSeqHash64* value)
+{
+    uint64_t                   out = 0;
+    const unsigned char*       p   = value->buf;
+    const unsigned char* const end = p + value->bufSize;
+
+    if (value->total >= 32)
+    {
+        out = _FSEQ_ROTL64(value->v[0], 1) +
+            _FSEQ_ROTL64(value->v[1], 7) +
+            _FSEQ_ROTL64(value->v[2], 12) +
+            _FSEQ_ROTL64(value->v[3], 18);
+        out = _fseqXXHMerge(out, value->v[0]);
+        out = _fseqXXHMerge(out, value->v[1]);
+        out = _fseqXXHMerge(out, value->v[2]);
+        out = _fseqXXHMerge(out, value->v[3]);
+    }
+    else
+    {
+        out = value->seed + _FSEQ_XXH_PRIME5;
+    }
+    out += value->total;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        out ^= _fseqXXHRound(0, _fseqRead64(p));
+        out  = _FSEQ_ROTL64(out, 27) * _FSEQ_XXH_PRIME1 + _FSEQ_XXH_PRIME4;
+    }
+    if (p + 4 <= end)
+    {
+        out ^= (uint64_t)_fseqRead32(p) * _FSEQ_XXH_PRIME1;
+        out  = _FSEQ_ROTL64(out, 23) * _FSEQ_XXH_PRIME2 + _FSEQ_XXH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+    {
+        out ^= *p * _FSEQ_XXH_PRIME5;
+        out  = _FSEQ_ROTL64(out, 11) * _FSEQ_XXH_PRIME1;
+    }
+
+    out ^= out >> 33;
+    out *= _FSEQ_XXH_PRIME2;
+    out ^= out >> 29;
+    out *= _FSEQ_XXH_PRIME3;
+    out ^= out >> 32;
+    return out;
+}
+
+uint64_t fseqHash64(const void* data, size_t size, uint64_t seed)
+{
+    struct _FSeqHash64 hash;
+    _fseqHash64Init(&hash, seed);
+    _fseqHash64Update(&hash, data, size);
+    return _fseqHash64Digest(&hash);
+}
+
+// Hash the contents of a file.
+static FSeqBool _fseqHashFile(
+    const char* fileName,
+    char*       buf,
+    size_t      bufSize,
+    uint64_t*   out)
+{
+    struct _FSeqHash64 hash;
+    FSeqBool           result = FSEQ_TRUE;
+#if defined(WIN32) || defined(_WIN32)
+    FILE*              f      = NULL;
+    size_t             count  = 0;
+    int                wLen   = MultiByteToWideChar(CP_UTF8, 0, fileName, -1, NULL, 0);
+    wchar_t*           wBuf   = malloc(wLen * sizeof(wchar_t));
+    MultiByteToWideChar(CP_UTF8, 0, fileName, -1, wBuf, wLen);
+    f = _wfopen(wBuf, L"rb");
+    free(wBuf);
+    if (!f)
+    {
+        return FSEQ_FALSE;
+    }
+    _fseqHash64Init(&hash, 0);
+    while ((count = fread(buf, 1, bufSize, f)) > 0)
+    {
+        _fseqHash64Update(&hash, buf, count);
+    }
+    result = ferror(f) ? FSEQ_FALSE : FSEQ_TRUE;
+    fclose(f);
+#else // WIN32
+    ssize_t            count  = 0;
+    const int          fd     = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (-1 == fd)
+    {
+        return FSEQ_FALSE;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // POSIX_FADV_SEQUENTIAL
+    _fseqHash64Init(&hash, 0);
+    while ((count = read(fd, buf, bufSize)) != 0)
+    {
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            result = FSEQ_FALSE;
+            break;
+        }
+        _fseqHash64Update(&hash, buf, (size_t)count);
+    }
+    close(fd);
+#endif // WIN32
+    *out = _fseqHash64Digest(&hash);
+    return result;
+}
+
+void fseqChecksumOptionsInit(struct FSeqChecksumOptions* value)
+{
+    value->threads    = 0;
+    value->bufferSize = 1024 * 1024;
+}
+
+void fseqChecksumsInit(struct FSeqChecksums* value)
+{
+    value->frames     = NULL;
+    value->frameCount = 0;
+    value->digest     = 0;
+}
+
+void fseqChecksumsDel(struct FSeqChecksums* value)
+{
+    free(value->frames);
+    fseqChecksumsInit(value);
+}
+
+// This struct provides the state for checksumming a sequence.
+struct _FSeqChecksum
+{
+    const char*                path;
+    const struct FSeqDirEntry* entry;
+    struct FSeqFrameChecksum*  frames;
+    char**                     buffers;
+    size_t                     bufferSize;
+};
+
+static void _fseqChecksumFrame(void* data, size_t thread, size_t index)
+{
+    struct _FSeqChecksum*     checksum = (struct _FSeqChecksum*)data;
+    struct FSeqFrameChecksum* frame    = &checksum->frames[index];
+    char                      fileName[FSEQ_STRING_LEN];
+
+    frame->digest = 0;
+    frame->error  = FSEQ_TRUE;
+    if (_fseqFrameFileName(checksum->path, checksum->entry, frame->frame, fileName, FSEQ_STRING_LEN) &&
+        _fseqHashFile(fileName, checksum->buffers[thread], checksum->bufferSize, &frame->digest))
+    {
+        frame->error = FSEQ_FALSE;
+    }
+}
+
+FSeqBool fseqChecksum(
+    const char*                       path,
+    const struct FSeqDirEntry*        entry,
+    struct FSeqChecksums*             out,
+    const struct FSeqChecksumOptions* options,
+    FSeqBool*                         error)
+{
+    struct FSeqChecksumOptions _options;
+    struct _FSeqChecksum       checksum;
+    struct FSeqFrameSet        frames;
+    struct _FSeqHash64         hash;
+    size_t                     threads = 0;
+    size_t                     i       = 0;
+    FSeqBool                   result  = FSEQ_TRUE;
+
+    if (!options)
+    {
+        fseqChecksumOptionsInit(&_options);
+        options = &_options;
+    }
+    fseqChecksumsDel(out);
+
+    // Get the frame numbers, entries that are not sequences are treated
+    // as a single frame.
+    fseqFrameSetInit(&frames);
+    if (!fseqDirEntryFrames(entry, &frames))
+    {
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+    out->frameCount = (size_t)FSEQ_MAX(fseqFrameSetCount(&frames), 1);
+    out->frames = (struct FSeqFrameChecksum*)malloc(out->frameCount * sizeof(struct FSeqFrameChecksum));
+    if (!out->frames)
+    {
+        fseqFrameSetDel(&frames);
+        fseqChecksumsInit(out);
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+    out->frames[0].frame = entry->frameMin;
+    if (frames.wordCount > 0)
+    {
+        int64_t frame = 0;
+        for (FSeqBool j = fseqFrameSetNext(&frames, INT64_MIN, &frame); j;
+            j = frame < INT64_MAX && fseqFrameSetNext(&frames, frame + 1, &frame))
+        {
+            out->frames[i++].frame = frame;
+        }
+    }
+    fseqFrameSetDel(&frames);
+
+    // Allocate a read buffer for each thread.
+    threads = FSEQ_MIN(_fseqThreadCount(options->threads), out->frameCount);
+    checksum.path       = path;
+    checksum.entry      = entry;
+    checksum.frames     = out->frames;
+    checksum.bufferSize = FSEQ_MAX(options->bufferSize, (size_t)4096);
+    checksum.buffers    = _fseqBuffersCreate(threads, checksum.bufferSize);
+    if (!checksum.buffers)
+    {
+        fseqChecksumsDel(out);
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+
+    _fseqParallelFor(out->frameCount, threads, _fseqChecksumFrame, &checksum);
+
+    // Combine the frame digests in frame order, so the sequence digest does
+    // not depend on the number of threads.
+    _fseqHash64Init(&hash, 0);
+    for (i = 0; i < out->frameCount; ++i)
+    {
+        unsigned char buf[8];
+        uint64_t      digest = out->frames[i].digest;
+        for (size_t j = 0; j < 8; ++j, digest >>= 8)
+        {
+            buf[j] = (unsigned char)digest;
+        }
+        _fseqHash64Update(&hash, buf, 8);
+        if (out->frames[i].error)
+        {
+            result = FSEQ_FALSE;
+        }
+    }
+    out->digest = _fseqHash64Digest(&hash);
+
+    _fseqBuffersDel(checksum.buffers, threads);
+    if (!result)
+    {
+        _fseqSetError(error);
+    }
+    return result;
+}
+
+void fseqCopyOptionsInit(struct FSeqCopyOptions* value)
+{
+    value->frameOffset  = 0;
+    value->framePadding = -1;
+    value->overwrite    = FSEQ_FALSE;
+    value->threads      = 0;
+}
+
+// The number of files handed out to a thread at a time.
+#define _FSEQ_FILE_BATCH 64
+
+// The prefix of temporary file names.
+#define _FSEQ_COPY_TEMP ".fseqtmp."
+
+// Copy operation phases. Overlapping frame ranges in the same directory
+// are first moved to temporary names, then to the final names. If any frame
+// fails the frames are moved back from the final names to the temporary
+// names, and then to the original names (or the temporary copies are
+// removed). If a direct move fails the moved frames are moved back to the
+// original names.
+#define _FSEQ_COPY_DIRECT 0
+#define _FSEQ_COPY_TO_TEMP 1
+#define _FSEQ_COPY_FROM_TEMP 2
+#define _FSEQ_COPY_UNDO 3
+#define _FSEQ_COPY_RESTORE 4
+#define _FSEQ_COPY_BACK 5
+
+// Where a frame is when moving it.
+#define _FSEQ_COPY_AT_SRC 0
+#define _FSEQ_COPY_AT_TEMP 1
+#define _FSEQ_COPY_AT_DST 2
+
+// This struct provides the state for copying or moving a sequence.
+struct _FSeqCopy
+{
+    const struct FSeqDirEntry* src;
+    struct FSeqDirEntry        dst;
+    int64_t*                   frames;
+    size_t                     frameCount;
+    FSeqBool*                  errors;
+    uint8_t*                   states;
+    int64_t                    offset;
+    FSeqBool                   move;
+    FSeqBool                   overwrite;
+    FSeqBool                   sameDir;
+    int                        phase;
+    char**                     buffers;
+#if defined(WIN32) || defined(_WIN32)
+    const char*                srcPath;
+    const char*                dstPath;
+#else // WIN32
+    int                        srcDir;
+    int                        dstDir;
+#endif // WIN32
+};
+
+// Get the frames of a directory entry as an array, entries that are not
+// sequences are treated as a single frame.
+static int64_t* _fseqDirEntryFrameArray(const struct FSeqDirEntry* entry, size_t* count)
+{
+    struct FSeqFrameSet frames;
+    int64_t*            out   = NULL;
+    int64_t             frame = 0;
+    size_t              i     = 0;
+
+    fseqFrameSetInit(&frames);
+    if (!fseqDirEntryFrames(entry, &frames))
+    {
+        return NULL;
+    }
+    *count = (size_t)FSEQ_MAX(fseqFrameSetCount(&frames), 1);
+    out = (int64_t*)malloc(*count * sizeof(int64_t));
+    if (out)
+    {
+        out[0] = entry->frameMin;
+        for (FSeqBool j = fseqFrameSetNext(&frames, INT64_MIN, &frame); j;
+            j = frame < INT64_MAX && fseqFrameSetNext(&frames, frame + 1, &frame))
+        {
+            out[i++] = frame;
+        }
+    }
+    fseqFrameSetDel(&frames);
+    return out;
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+static FSeqBool _fseqCopyFile(
+    struct _FSeqCopy* copy,
+    size_t            thread,
+    const char*       src,
+    FSeqBool          srcTemp,
+    const char*       dst,
+    FSeqBool          dstTemp,
+    FSeqBool          move)
+{
+    char     srcBuf[FSEQ_STRING_LEN];
+    char     dstBuf[FSEQ_STRING_LEN];
+    wchar_t* wSrc   = NULL;
+    wchar_t* wDst   = NULL;
+    FSeqBool out    = FSEQ_FALSE;
+
+    if (snprintf(srcBuf, FSEQ_STRING_LEN, "%s\\%s%s", srcTemp ? copy->dstPath : copy->srcPath, srcTemp ? _FSEQ_COPY_TEMP : "", src) >= FSEQ_STRING_LEN ||
+        snprintf(dstBuf, FSEQ_STRING_LEN, "%s\\%s%s", copy->dstPath, dstTemp ? _FSEQ_COPY_TEMP : "", dst) >= FSEQ_STRING_LEN)
+    {
+        return FSEQ_FALSE;
+    }
+    wSrc = _fseqWideString(srcBuf);
+    wDst = _fseqWideString(dstBuf);
+    if (wSrc && wDst)
+    {
+        const FSeqBool overwrite = copy->overwrite;
+        out = move ?
+            MoveFileExW(wSrc, wDst, MOVEFILE_COPY_ALLOWED | (overwrite ? MOVEFILE_REPLACE_EXISTING : 0)) != 0 :
+            CopyFileW(wSrc, wDst, !overwrite) != 0;
+    }
+    free(wSrc);
+    free(wDst);
+    return out;
+}
+
+// Remove a temporary copy.
+static FSeqBool _fseqCopyRemoveTemp(struct _FSeqCopy* copy, const char* name)
+{
+    char     buf[FSEQ_STRING_LEN];
+    wchar_t* wBuf = NULL;
+    FSeqBool out  = FSEQ_FALSE;
+
+    if (snprintf(buf, FSEQ_STRING_LEN, "%s\\%s%s", copy->dstPath, _FSEQ_COPY_TEMP, name) >= FSEQ_STRING_LEN)
+    {
+        return FSEQ_FALSE;
+    }
+    wBuf = _fseqWideString(buf);
+    if (wBuf)
+    {
+        out = DeleteFileW(wBuf) != 0;
+    }
+    free(wBuf);
+    return out;
+}
+
+#else // WIN32
+
+// Copy the contents of a file, with copy_file_range() where available so
+// the data does not pass through user space.
+static FSeqBool _fseqCopyData(int in, int out, char* buf, size_t bufSize)
+{
+    ssize_t count = 0;
+#if defined(__linux__) && defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (2 == __GLIBC__ && __GLIBC_MINOR__ >= 27))
+    FSeqBool copied = FSEQ_FALSE;
+    while ((count = copy_file_range(in, NULL, out, NULL, 1024 * 1024 * 1024, 0)) != 0)
+    {
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (!copied && (ENOSYS == errno || EXDEV == errno || EINVAL == errno || EOPNOTSUPP == errno))
+            {
+                // Not supported between these files, use read() and write().
+                break;
+            }
+            return FSEQ_FALSE;
+        }
+        copied = FSEQ_TRUE;
+    }
+    if (0 == count)
+    {
+        return FSEQ_TRUE;
+    }
+#endif // __linux__
+    while ((count = read(in, buf, bufSize)) != 0)
+    {
+        const char* p = buf;
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return FSEQ_FALSE;
+        }
+        while (count > 0)
+        {
+            const ssize_t written = write(out, p, (size_t)count);
+            if (written < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                return FSEQ_FALSE;
+            }
+            p     += written;
+            count -= written;
+        }
+    }
+    return FSEQ_TRUE;
+}
+
+// Rename a file, without replacing an existing file unless requested.
+static FSeqBool _fseqRename(int srcDir, const char* src, int dstDir, const char* dst, FSeqBool overwrite)
+{
+    struct stat st;
+    if (overwrite)
+    {
+        return 0 == renameat(srcDir, src, dstDir, dst);
+    }
+#if defined(RENAME_NOREPLACE)
+    if (0 == renameat2(srcDir, src, dstDir, dst, RENAME_NOREPLACE))
+    {
+        return FSEQ_TRUE;
+    }
+    if (errno != EINVAL && errno != ENOSYS)
+    {
+        return FSEQ_FALSE;
+    }
+#endif // RENAME_NOREPLACE
+    if (0 == fstatat(dstDir, dst, &st, AT_SYMLINK_NOFOLLOW) || errno != ENOENT)
+    {
+        errno = EEXIST;
+        return FSEQ_FALSE;
+    }
+    return 0 == renameat(srcDir, src, dstDir, dst);
+}
+
+static FSeqBool _fseqCopyFile(
+    struct _FSeqCopy* copy,
+    size_t            thread,
+    const char*       src,
+    FSeqBool          srcTemp,
+    const char*       dst,
+    FSeqBool          dstTemp,
+    FSeqBool          move)
+{
+    char           srcBuf[FSEQ_STRING_LEN];
+    char           dstBuf[FSEQ_STRING_LEN];
+    const int      srcDir    = srcTemp ? copy->dstDir : copy->srcDir;
+    const FSeqBool overwrite = copy->overwrite;
+    struct stat    st;
+    int            in        = -1;
+    int            out       = -1;
+    FSeqBool       result    = FSEQ_FALSE;
+
+    if (srcTemp || dstTemp)
+    {
+        if (snprintf(srcBuf, FSEQ_STRING_LEN, "%s%s", srcTemp ? _FSEQ_COPY_TEMP : "", src) >= FSEQ_STRING_LEN ||
+            snprintf(dstBuf, FSEQ_STRING_LEN, "%s%s", dstTemp ? _FSEQ_COPY_TEMP : "", dst) >= FSEQ_STRING_LEN)
+        {
+            return FSEQ_FALSE;
+        }
+        src = srcBuf;
+        dst = dstBuf;
+    }
+
+    if (move)
+    {
+        if (_fseqRename(srcDir, src, copy->dstDir, dst, overwrite))
+        {
+            return FSEQ_TRUE;
+        }
+        if (errno != EXDEV)
+        {
+            return FSEQ_FALSE;
+        }
+        // Moving between file systems, copy the file and remove the original.
+    }
+
+    in = openat(srcDir, src, O_RDONLY | O_CLOEXEC);
+    if (-1 == in)
+    {
+        return FSEQ_FALSE;
+    }
+    if (0 == fstat(in, &st))
+    {
+        out = openat(
+            copy->dstDir,
+            dst,
+            O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : O_EXCL),
+            st.st_mode & 07777);
+    }
+    if (out != -1)
+    {
+#if defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // POSIX_FADV_SEQUENTIAL
+        result = _fseqCopyData(in, out, copy->buffers[thread], 1024 * 1024);
+        if (close(out) != 0)
+        {
+            result = FSEQ_FALSE;
+        }
+        if (!result)
+        {
+            unlinkat(copy->dstDir, dst, 0);
+        }
+    }
+    close(in);
+    if (result && move)
+    {
+        result = 0 == unlinkat(srcDir, src, 0);
+    }
+    return result;
+}
+
+// Remove a temporary copy.
+static FSeqBool _fseqCopyRemoveTemp(struct _FSeqCopy* copy, const char* name)
+{
+    char buf[FSEQ_STRING_LEN];
+    if (snprintf(buf, FSEQ_STRING_LEN, "%s%s", _FSEQ_COPY_TEMP, name) >= FSEQ_STRING_LEN)
+    {
+        return FSEQ_FALSE;
+    }
+    return 0 == unlinkat(copy->dstDir, buf, 0);
+}
+
+#endif // WIN32
+
+static void _fseqCopyBatch(void* data, size_t thread, size_t index)
+{
+    struct _FSeqCopy* copy  = (struct _FSeqCopy*)data;
+    const size_t      first = index * _FSEQ_FILE_BATCH;
+    const size_t      last  = FSEQ_MIN(first + _FSEQ_FILE_BATCH, copy->frameCount);
+    char              src[FSEQ_STRING_LEN];
+    char              dst[FSEQ_STRING_LEN];
+
+    for (size_t i = first; i < last; ++i)
+    {
+        const int64_t frame = copy->frames[i];
+        uint8_t*      state = copy->states ? &copy->states[i] : NULL;
+        switch (copy->phase)
+        {
+        case _FSEQ_COPY_FROM_TEMP:
+        case _FSEQ_COPY_RESTORE:
+            if (_FSEQ_COPY_AT_TEMP != *state)
+            {
+                continue;
+            }
+            break;
+        case _FSEQ_COPY_UNDO:
+        case _FSEQ_COPY_BACK:
+            if (_FSEQ_COPY_AT_DST != *state)
+            {
+                continue;
+            }
+            break;
+        default:
+            if (copy->errors[i])
+            {
+                continue;
+            }
+            break;
+        }
+        if (!fseqDirEntryFrameName(copy->src, frame, FSEQ_FALSE, src, FSEQ_STRING_LEN) ||
+            !fseqDirEntryFrameName(&copy->dst, frame + copy->offset, FSEQ_FALSE, dst, FSEQ_STRING_LEN))
+        {
+            copy->errors[i] = FSEQ_TRUE;
+            continue;
+        }
+        switch (copy->phase)
+        {
+        case _FSEQ_COPY_TO_TEMP:
+            copy->errors[i] = !_fseqCopyFile(copy, thread, src, FSEQ_FALSE, dst, FSEQ_TRUE, copy->move);
+            if (!copy->errors[i])
+            {
+                *state = _FSEQ_COPY_AT_TEMP;
+            }
+            break;
+        case _FSEQ_COPY_FROM_TEMP:
+            copy->errors[i] = !_fseqCopyFile(copy, thread, dst, FSEQ_TRUE, dst, FSEQ_FALSE, FSEQ_TRUE);
+            if (!copy->errors[i])
+            {
+                *state = _FSEQ_COPY_AT_DST;
+            }
+            break;
+        case _FSEQ_COPY_UNDO:
+            if (_fseqCopyFile(copy, thread, dst, FSEQ_FALSE, dst, FSEQ_TRUE, FSEQ_TRUE))
+            {
+                *state = _FSEQ_COPY_AT_TEMP;
+            }
+            break;
+        case _FSEQ_COPY_RESTORE:
+            if (copy->move ?
+                _fseqCopyFile(copy, thread, dst, FSEQ_TRUE, src, FSEQ_FALSE, FSEQ_TRUE) :
+                _fseqCopyRemoveTemp(copy, dst))
+            {
+                *state = _FSEQ_COPY_AT_SRC;
+            }
+            break;
+        case _FSEQ_COPY_BACK:
+            // The source and destination directories are swapped for this
+            // phase.
+            if (_fseqCopyFile(copy, thread, dst, FSEQ_FALSE, src, FSEQ_FALSE, FSEQ_TRUE))
+            {
+                *state = _FSEQ_COPY_AT_SRC;
+            }
+            break;
+        default:
+            // Moving a frame to the same name does nothing, copying it is
+            // an error.
+            if (copy->sameDir && 0 == strcmp(src, dst))
+            {
+                copy->errors[i] = !copy->move;
+                break;
+            }
+            copy->errors[i] = !_fseqCopyFile(copy, thread, src, FSEQ_FALSE, dst, FSEQ_FALSE, copy->move);
+            if (!copy->errors[i] && state)
+            {
+                *state = _FSEQ_COPY_AT_DST;
+            }
+            break;
+        }
+    }
+}
+
+// Swap the source and destination directories.
+static void _fseqCopySwapDirs(struct _FSeqCopy* copy)
+{
+#if defined(WIN32) || defined(_WIN32)
+    const char* tmp = copy->srcPath;
+    copy->srcPath = copy->dstPath;
+    copy->dstPath = tmp;
+#else // WIN32
+    const int tmp = copy->srcDir;
+    copy->srcDir = copy->dstDir;
+    copy->dstDir = tmp;
+#endif // WIN32
+}
+
+// Whether any frames failed to be copied.
+static FSeqBool _fseqCopyErrors(const struct _FSeqCopy* copy)
+{
+    for (size_t i = 0; i < copy->frameCount; ++i)
+    {
+        if (copy->errors[i])
+        {
+            return FSEQ_TRUE;
+        }
+    }
+    return FSEQ_FALSE;
+}
+
+// Get the directory of a directory entry, combining the path with the
+// path component of the entry.
+static FSeqBool _fseqDirEntryDir(
+    const char*                path,
+    const struct FSeqDirEntry* entry,
+    char*                      out,
+    size_t                     max)
+{
+    const char* entryPath = entry->fileName.base ?
+        (entry->fileName.path ? entry->fileName.path : "") :
+        entry->name;
+    const int   len       = entry->fileName.base ?
+        (int)strlen(entryPath) :
+        (int)entry->sizes.path;
+    int         r         = 0;
+
+    if (len > 0 && ('/' == entryPath[0] || '\\' == entryPath[0] || (len > 1 && ':' == entryPath[1])))
+    {
+        r = snprintf(out, max, "%.*s", len, entryPath);
+    }
+    else
+    {
+        r = snprintf(out, max, "%s%s%.*s", path ? path : ".", len > 0 ? "/" : "", len, entryPath);
+    }
+    return r >= 0 && (size_t)r < max;
+}
+
+static FSeqBool _fseqCopy(
+    const char*                    path,
+    const struct FSeqDirEntry*     entry,
+    const char*                    outPath,
+    const struct FSeqCopyOptions*  options,
+    FSeqBool                       move,
+    FSeqBool*                      error)
+{
+    struct FSeqCopyOptions _options;
+    struct _FSeqCopy       copy;
+    struct FSeqFrameSet    frames;
+    char                   srcPath[FSEQ_STRING_LEN];
+    size_t                 threads   = 0;
+    size_t                 batches   = 0;
+    FSeqBool               overlap   = FSEQ_FALSE;
+    FSeqBool               result    = FSEQ_TRUE;
+#if !defined(WIN32) && !defined(_WIN32)
+    struct stat            srcStat;
+    struct stat            dstStat;
+#endif // WIN32
+
+    if (!options)
+    {
+        fseqCopyOptionsInit(&_options);
+        options = &_options;
+    }
+
+    // Padding notation without frames is not copied.
+    if (_fseqDirEntryPattern(entry))
+    {
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+    memset(&copy, 0, sizeof(struct _FSeqCopy));
+#if !defined(WIN32) && !defined(_WIN32)
+    copy.srcDir       = -1;
+    copy.dstDir       = -1;
+#endif // WIN32
+    copy.src          = entry;
+    copy.dst          = *entry;
+    copy.dst.next     = NULL;
+    copy.offset       = options->frameOffset;
+    copy.move         = move;
+    copy.overwrite    = options->overwrite;
+    if (options->framePadding >= 0)
+    {
+        copy.dst.framePadding = (uint8_t)FSEQ_MIN(options->framePadding, 255);
+    }
+
+    // The frame names are relative to the directory of the entry.
+    if (!_fseqDirEntryDir(path, entry, srcPath, FSEQ_STRING_LEN))
+    {
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+    copy.frames = _fseqDirEntryFrameArray(entry, &copy.frameCount);
+    if (!copy.frames)
+    {
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+    copy.errors = (FSeqBool*)calloc(copy.frameCount, sizeof(FSeqBool));
+    threads = FSEQ_MIN(
+        _fseqThreadCount(options->threads),
+        (copy.frameCount + _FSEQ_FILE_BATCH - 1) / _FSEQ_FILE_BATCH);
+    copy.buffers = _fseqBuffersCreate(threads, 1024 * 1024);
+
+#if defined(WIN32) || defined(_WIN32)
+    copy.srcPath = srcPath;
+    copy.dstPath = outPath ? outPath : srcPath;
+    copy.sameDir = !outPath || 0 == strcmp(outPath, srcPath);
+#else // WIN32
+    copy.srcDir = open(srcPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    copy.dstDir = outPath ? open(outPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : copy.srcDir;
+    copy.sameDir = copy.srcDir != -1 && copy.dstDir != -1 &&
+        0 == fstat(copy.srcDir, &srcStat) &&
+        0 == fstat(copy.dstDir, &dstStat) &&
+        srcStat.st_dev == dstStat.st_dev &&
+        srcStat.st_ino == dstStat.st_ino;
+    if (-1 == copy.srcDir || -1 == copy.dstDir)
+    {
+        result = FSEQ_FALSE;
+    }
+#endif // WIN32
+    if (!copy.errors || !copy.buffers)
+    {
+        result = FSEQ_FALSE;
+    }
+
+    // Check whether any of the new frame names are also old frame names.
+    // Only renumbering can cause this, since names with the same frame
+    // number but different padding are never equal.
+    if (result && copy.sameDir && copy.offset != 0 &&
+        (entry->sizes.number || (entry->fileName.number && entry->fileName.number[0])))
+    {
+        fseqFrameSetInit(&frames);
+        if (fseqDirEntryFrames(entry, &frames))
+        {
+            for (size_t i = 0; i < copy.frameCount && !overlap; ++i)
+            {
+                overlap = fseqFrameSetContains(&frames, copy.frames[i] + copy.offset);
+            }
+        }
+        else
+        {
+            result = FSEQ_FALSE;
+        }
+        fseqFrameSetDel(&frames);
+        if (overlap && !move && !copy.overwrite)
+        {
+            // The copies would replace frames that have not been copied yet.
+            result = FSEQ_FALSE;
+        }
+    }
+
+    if (result)
+    {
+        batches = (copy.frameCount + _FSEQ_FILE_BATCH - 1) / _FSEQ_FILE_BATCH;
+        if (overlap || move)
+        {
+            copy.states = (uint8_t*)calloc(copy.frameCount, sizeof(uint8_t));
+            if (!copy.states)
+            {
+                result = FSEQ_FALSE;
+            }
+        }
+        if (overlap && result)
+        {
+            copy.phase = _FSEQ_COPY_TO_TEMP;
+            _fseqParallelFor(batches, threads, _fseqCopyBatch, &copy);
+            if (!_fseqCopyErrors(&copy))
+            {
+                copy.phase = _FSEQ_COPY_FROM_TEMP;
+                _fseqParallelFor(batches, threads, _fseqCopyBatch, &copy);
+            }
+            if (_fseqCopyErrors(&copy))
+            {
+                // Put the frames back without replacing any files. A copy
+                // cannot be undone, only the temporary copies are removed.
+                copy.overwrite = FSEQ_FALSE;
+                if (move)
+                {
+                    copy.phase = _FSEQ_COPY_UNDO;
+                    _fseqParallelFor(batches, threads, _fseqCopyBatch, &copy);
+                }
+                copy.phase = _FSEQ_COPY_RESTORE;
+                _fseqParallelFor(batches, threads, _fseqCopyBatch, &copy);
+            }
+        }
+        else if (result)
+        {
+            copy.phase = _FSEQ_COPY_DIRECT;
+            _fseqParallelFor(batches, threads, _fseqCopyBatch, &copy);
+            if (move && _fseqCopyErrors(&copy))
+            {
+                // Move the frames back without replacing any files, so the
+                // sequence is not left split between the directories.
+                copy.overwrite = FSEQ_FALSE;
+                _fseqCopySwapDirs(&copy);
+                copy.phase = _FSEQ_COPY_BACK;
+                _fseqParallelFor(batches, threads, _fseqCopyBatch, &copy);
+                _fseqCopySwapDirs(&copy);
+            }
+        }
+        if (_fseqCopyErrors(&copy))
+        {
+            result = FSEQ_FALSE;
+        }
+    }
+
+#if !defined(WIN32) && !defined(_WIN32)
+    if (copy.dstDir != -1 && copy.dstDir != copy.srcDir)
+    {
+        close(copy.dstDir);
+    }
+    if (copy.srcDir != -1)
+    {
+        close(copy.srcDir);
+    }
+#endif // WIN32
+    _fseqBuffersDel(copy.buffers, threads);
+    free(copy.states);
+    free(copy.errors);
+    free(copy.frames);
+    if (!result)
+    {
+        _fseqSetError(error);
+    }
+    return result;
+}
+
+FSeqBool fseqCopy(
+    const char*                   path,
+    const struct FSeqDirEntry*    entry,
+    const char*                   outPath,
+    const struct FSeqCopyOptions* options,
+    FSeqBool*                     error)
+{
+    return _fseqCopy(path, entry, outPath, options, FSEQ_FALSE, error);
+}
+
+FSeqBool fseqMove(
+    const char*                   path,
+    const struct FSeqDirEntry*    entry,
+    const char*                   outPath,
+    const struct FSeqCopyOptions* options,
+    FSeqBool*                     error)
+{
+    return _fseqCopy(path, entry, outPath, options, FSEQ_TRUE, error);
+}
+
+void fseqRemoveOptionsInit(struct FSeqRemoveOptions* value)
+{
+    value->dryRun  = FSEQ_FALSE;
+    value->threads = 16;
+}
+
+void fseqRemoveResultInit(struct FSeqRemoveResult* value)
+{
+    value->removed = 0;
+    value->missing = 0;
+    value->failed  = 0;
+}
+
+// Frame removal results.
+#define _FSEQ_REMOVE_OK      0
+#define _FSEQ_REMOVE_MISSING 1
+#define _FSEQ_REMOVE_FAILED  2
+
+// This struct provides the state for removing a sequence.
+struct _FSeqRemove
+{
+    const struct FSeqDirEntry* entry;
+    const int64_t*             frames;
+    size_t                     frameCount;
+    uint8_t*                   results;
+    FSeqBool                   dryRun;
+#if defined(WIN32) || defined(_WIN32)
+    const char*                path;
+#else // WIN32
+    int                        dir;
+#endif // WIN32
+};
+
+static uint8_t _fseqRemoveFile(struct _FSeqRemove* state, const char* fileName)
+{
+#if defined(WIN32) || defined(_WIN32)
+    char     buf[FSEQ_STRING_LEN];
+    wchar_t* wBuf   = NULL;
+    uint8_t  out    = _FSEQ_REMOVE_FAILED;
+    if (snprintf(buf, FSEQ_STRING_LEN, "%s\\%s", state->path, fileName) >= FSEQ_STRING_LEN)
+    {
+        return _FSEQ_REMOVE_FAILED;
+    }
+    wBuf = _fseqWideString(buf);
+    if (wBuf)
+    {
+        if (state->dryRun ?
+            GetFileAttributesW(wBuf) != INVALID_FILE_ATTRIBUTES :
+            DeleteFileW(wBuf) != 0)
+        {
+            out = _FSEQ_REMOVE_OK;
+        }
+        else
+        {
+            const DWORD e = GetLastError();
+            out = ERROR_FILE_NOT_FOUND == e || ERROR_PATH_NOT_FOUND == e ?
+                _FSEQ_REMOVE_MISSING :
+                _FSEQ_REMOVE_FAILED;
+        }
+    }
+    free(wBuf);
+    return out;
+#else // WIN32
+    struct stat st;
+    if (state->dryRun ?
+        0 == fstatat(state->dir, fileName, &st, AT_SYMLINK_NOFOLLOW) :
+        0 == unlinkat(state->dir, fileName, 0))
+    {
+        return _FSEQ_REMOVE_OK;
+    }
+    return ENOENT == errno ? _FSEQ_REMOVE_MISSING : _FSEQ_REMOVE_FAILED;
+#endif // WIN32
+}
+
+static void _fseqRemoveBatch(void* data, size_t thread, size_t index)
+{
+    struct _FSeqRemove* state  = (struct _FSeqRemove*)data;
+    const size_t        first  = index * _FSEQ_FILE_BATCH;
+    const size_t        last   = FSEQ_MIN(first + _FSEQ_FILE_BATCH, state->frameCount);
+    char                fileName[FSEQ_STRING_LEN];
+
+    (void)thread;
+    for (size_t i = first; i < last; ++i)
+    {
+        state->results[i] = fseqDirEntryFrameName(
+            state->entry,
+            state->frames[i],
+            FSEQ_FALSE,
+            fileName,
+            FSEQ_STRING_LEN) ?
+            _fseqRemoveFile(state, fileName) :
+            _FSEQ_REMOVE_FAILED;
+    }
+}
+
+FSeqBool fseqRemove(
+    const char*                     path,
+    const struct FSeqDirEntry*      entry,
+    struct FSeqRemoveResult*        out,
+    const struct FSeqRemoveOptions* options,
+    FSeqBool*                       error)
+{
+    struct FSeqRemoveOptions _options;
+    struct _FSeqRemove       state;
+    char                     dir[FSEQ_STRING_LEN];
+    int64_t*                 frames  = NULL;
+    size_t                   batches = 0;
+    FSeqBool                 result  = FSEQ_FALSE;
+
+    if (!options)
+    {
+        fseqRemoveOptionsInit(&_options);
+        options = &_options;
+    }
+    fseqRemoveResultInit(out);
+
+    // Directories, and padding notation without frames, are not removed.
+    if (FSEQ_FILE_TYPE_DIR == entry->type ||
+        _fseqDirEntryPattern(entry) ||
+        !_fseqDirEntryDir(path, entry, dir, FSEQ_STRING_LEN))
+    {
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+
+    memset(&state, 0, sizeof(struct _FSeqRemove));
+    state.entry  = entry;
+    state.dryRun = options->dryRun;
+    frames = _fseqDirEntryFrameArray(entry, &state.frameCount);
+    state.frames  = frames;
+    state.results = frames ? (uint8_t*)malloc(state.frameCount) : NULL;
+#if defined(WIN32) || defined(_WIN32)
+    state.path = dir;
+    if (state.results)
+#else // WIN32
+    state.dir = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (state.results && state.dir != -1)
+#endif // WIN32
+    {
+        batches = (state.frameCount + _FSEQ_FILE_BATCH - 1) / _FSEQ_FILE_BATCH;
+        _fseqParallelFor(
+            batches,
+            FSEQ_MIN(_fseqThreadCount(options->threads), batches),
+            _fseqRemoveBatch,
+            &state);
+        for (size_t i = 0; i < state.frameCount; ++i)
+        {
+            switch (state.results[i])
+            {
+            case _FSEQ_REMOVE_OK: ++out->removed; break;
+            case _FSEQ_REMOVE_MISSING: ++out->missing; break;
+            default: ++out->failed; break;
+            }
+        }
+        result = 0 == out->failed;
+    }
+#if !defined(WIN32) && !defined(_WIN32)
+    if (state.dir != -1)
+    {
+        close(state.dir);
+    }
+#endif // WIN32
+    free(state.results);
+    free(frames);
+    if (!result)
+    {
+        _fseqSetError(error);
+    }
+    return result;
+}
+
+void fseqDiskUsageOptionsInit(struct FSeqDiskUsageOptions* value)
+{
+    value->threads   = 16;
+    value->apparent  = FSEQ_FALSE;
+    value->throttle  = NULL;
+    value->throttled = NULL;
+}
+
+void fseqDiskUsageInit(struct FSeqDiskUsage* value)
+{
+    value->bytes   = 0;
+    value->files   = 0;
+    value->missing = 0;
+    value->failed  = 0;
+}
+
+// This struct provides the frames of an entry for measuring disk usage.
+struct _FSeqDiskUsageItem
+{
+    const struct FSeqDirEntry* entry;
+    int64_t*                   frames;
+    size_t                     frameCount;
+    size_t                     firstBatch;
+    size_t                     dir;
+};
+
+// This struct provides the state for measuring disk usage. The batches of
+// every item are numbered consecutively, and each batch has its own
+// result so the threads never share counters.
+struct _FSeqDiskUsage
+{
+    struct _FSeqDiskUsageItem* items;
+    size_t                     itemCount;
+    struct FSeqDiskUsage*      results;
+    FSeqBool                   apparent;
+    struct FSeqThrottle*       throttle;
+    int64_t*                   throttled;
+#if defined(WIN32) || defined(_WIN32)
+    char**                     dirs;
+#else // WIN32
+    int*                       dirs;
+#endif // WIN32
+};
+
+static void _fseqDiskUsageFile(
+    struct _FSeqDiskUsage* state,
+    size_t                 dir,
+    const char*            fileName,
+    struct FSeqDiskUsage*  out)
+{
+#if defined(WIN32) || defined(_WIN32)
+    char                      buf[FSEQ_STRING_LEN];
+    wchar_t*                  wBuf = NULL;
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (snprintf(buf, FSEQ_STRING_LEN, "%s\\%s", state->dirs[dir], fileName) >= FSEQ_STRING_LEN)
+    {
+        ++out->failed;
+        return;
+    }
+    wBuf = _fseqWideString(buf);
+    if (wBuf && GetFileAttributesExW(wBuf, GetFileExInfoStandard, &data))
+    {
+        out->bytes += ((int64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        ++out->files;
+    }
+    else
+    {
+        const DWORD e = GetLastError();
+        if (wBuf && (ERROR_FILE_NOT_FOUND == e || ERROR_PATH_NOT_FOUND == e))
+        {
+            ++out->missing;
+        }
+        else
+        {
+            ++out->failed;
+        }
+    }
+    free(wBuf);
+#else // WIN32
+    struct stat st;
+    if (0 == fstatat(state->dirs[dir], fileName, &st, AT_SYMLINK_NOFOLLOW))
+    {
+        out->bytes += state->apparent ? (int64_t)st.st_size : (int64_t)st.st_blocks * 512;
+        ++out->files;
+    }
+    else if (ENOENT == errno)
+    {
+        ++out->missing;
+    }
+    else
+    {
+        ++out->failed;
+    }
+#endif // WIN32
+}
+
+static void _fseqDiskUsageBatch(void* data, size_t thread, size_t index)
+{
+    struct _FSeqDiskUsage*           state = (struct _FSeqDiskUsage*)data;
+    const struct _FSeqDiskUsageItem* item  = NULL;
+    size_t                           lo    = 0;
+    size_t                           hi    = state->itemCount;
+    size_t                           first = 0;
+    size_t                           last  = 0;
+    char                             fileName[FSEQ_STRING_LEN];
+
+    // Find the item that contains the batch.
+    while (hi - lo > 1)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (state->items[mid].firstBatch <= index)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    item  = &state->items[lo];
+    first = (index - item->firstBatch) * _FSEQ_FILE_BATCH;
+    last  = FSEQ_MIN(first + _FSEQ_FILE_BATCH, item->frameCount);
+    if (state->throttle)
+    {
+        state->throttled[thread] += fseqThrottleAcquire(state->throttle, (int64_t)(last - first));
+    }
+    for (size_t i = first; i < last; ++i)
+    {
+        if (fseqDirEntryFrameName(
+            item->entry,
+            item->frames[i],
+            FSEQ_FALSE,
+            fileName,
+            FSEQ_STRING_LEN))
+        {
+            _fseqDiskUsageFile(state, item->dir, fileName, &state->results[index]);
+        }
+        else
+        {
+            ++state->results[index].failed;
+        }
+    }
+}
+
+FSeqBool fseqDiskUsage(
+    const char*                        path,
+    const struct FSeqDirEntry*         list,
+    struct FSeqDiskUsage*              out,
+    const struct FSeqDiskUsageOptions* options,
+    FSeqBool*                          error)
+{
+    struct FSeqDiskUsageOptions _options;
+    struct _FSeqDiskUsage       state;
+    const struct FSeqDirEntry*  entry    = NULL;
+    char                        dir[FSEQ_STRING_LEN];
+    char                        prev[FSEQ_STRING_LEN];
+    size_t                      count    = 0;
+    size_t                      dirCount = 0;
+    size_t                      batches  = 0;
+    size_t                      threads  = 0;
+    size_t                      i        = 0;
+    FSeqBool                    result   = FSEQ_TRUE;
+
+    if (!options)
+    {
+        fseqDiskUsageOptionsInit(&_options);
+        options = &_options;
+    }
+    for (entry = list; entry; entry = entry->next)
+    {
+        fseqDiskUsageInit(&out[count++]);
+    }
+
+    memset(&state, 0, sizeof(struct _FSeqDiskUsage));
+    state.apparent = options->apparent;
+    state.items    = (struct _FSeqDiskUsageItem*)calloc(count + 1, sizeof(struct _FSeqDiskUsageItem));
+#if defined(WIN32) || defined(_WIN32)
+    state.dirs     = (char**)calloc(count + 1, sizeof(char*));
+#else // WIN32
+    state.dirs     = (int*)calloc(count + 1, sizeof(int));
+#endif // WIN32
+    if (!state.items || !state.dirs)
+    {
+        free(state.items);
+        free(state.dirs);
+        _fseqSetError(error);
+        return FSEQ_FALSE;
+    }
+
+    // Collect the frames of each entry. The entries of a list usually share
+    // the same directory, so it is only opened again when it changes.
+    prev[0] = 0;
+    for (entry = list, i = 0; entry; entry = entry->next, ++i)
+    {
+        struct _FSeqDiskUsageItem* item = &state.items[state.itemCount];
+        if (FSEQ_FILE_TYPE_DIR == entry->type)
+        {
+            continue;
+        }
+        if (!_fseqDirEntryDir(path, entry, dir, FSEQ_STRING_LEN))
+        {
+            ++out[i].failed;
+            continue;
+        }
+        if (0 == dirCount || strcmp(dir, prev) != 0)
+        {
+#if defined(WIN32) || defined(_WIN32)
+            state.dirs[dirCount] = _fseqStrDup(dir, strlen(dir));
+            if (!state.dirs[dirCount])
+#else // WIN32
+            state.dirs[dirCount] = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (-1 == state.dirs[dirCount])
+#endif // WIN32
+            {
+                out[i].failed += FSEQ_MAX(entry->frameCount, 1);
+                prev[0] = 0;
+                continue;
+            }
+            memcpy(prev, dir, strlen(dir) + 1);
+            ++dirCount;
+        }
+        item->entry  = entry;
+        item->frames = _fseqDirEntryFrameArray(entry, &item->frameCount);
+        if (!item->frames)
+        {
+            ++out[i].failed;
+            continue;
+        }
+        item->firstBatch = batches;
+        item->dir        = dirCount - 1;
+        batches += (item->frameCount + _FSEQ_FILE_BATCH - 1) / _FSEQ_FILE_BATCH;
+        ++state.itemCount;
+    }
+
+    // Read the file status. Each thread adds up its own time waiting for
+    // the throttle, and since the threads wait at the same time the longest
+    // is the time the scan was delayed.
+    threads         = FSEQ_MIN(_fseqThreadCount(options->threads), batches);
+    state.results   = (struct FSeqDiskUsage*)calloc(batches + 1, sizeof(struct FSeqDiskUsage));
+    state.throttle  = options->throttle;
+    state.throttled = (int64_t*)calloc(threads + 1, sizeof(int64_t));
+    if (state.results && state.throttled)
+    {
+        _fseqParallelFor(batches, threads, _fseqDiskUsageBatch, &state);
+        for (i = 1; i < threads; ++i)
+        {
+            state.throttled[0] = FSEQ_MAX(state.throttled[0], state.throttled[i]);
+        }
+        _fseqThrottledAdd(options->throttled, state.throttled[0]);
+    }
+    else
+    {
+        result = FSEQ_FALSE;
+    }
+
+    // Add up the batches of each entry, the items are in the order of the
+    // list.
+    for (entry = list, i = 0, count = 0; entry; entry = entry->next, ++i)
+    {
+        if (count < state.itemCount && state.items[count].entry == entry)
+        {
+            const size_t first = state.items[count].firstBatch;
+            const size_t last  = count + 1 < state.itemCount ? state.items[count + 1].firstBatch : batches;
+            ++count;
+            for (size_t j = first; state.results && j < last; ++j)
+            {
+                out[i].bytes   += state.results[j].bytes;
+                out[i].files   += state.results[j].files;
+                out[i].missing += state.results[j].missing;
+                out[i].failed  += state.results[j].failed;
+            }
+        }
+        if (out[i].failed > 0)
+        {
+            result = FSEQ_FALSE;
+        }
+    }
+
+    for (i = 0; i < state.itemCount; ++i)
+    {
+        free(state.items[i].frames);
+    }
+    for (i = 0; i < dirCount; ++i)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        free(state.dirs[i]);
+#else // WIN32
+        close(state.dirs[i]);
+#endif // WIN32
+    }
+    free(state.items);
+    free(state.dirs);
+    free(state.results);
+    free(state.throttled);
+    if (!result)
+    {
+        _fseqSetError(error);
+    }
+    return result;
+}
+
+// Tar archives are a sequence of 512 byte headers, each followed by the
+// member data padded to a multiple of 512 bytes. The headers are read one
+// at a time and the data is skipped, except for the GNU long name and pax
+// extended headers which hold the name of the following member.
+#define _FSEQ_TAR_BLOCK 512
+
+// The largest pax extended header that is read.
+#define _FSEQ_TAR_PAX_MAX (1024 * 1024)
+
+// This struct provides an open archive.
+struct _FSeqArchive
+{
+#if defined(WIN32) || defined(_WIN32)
+    FILE*    f;
+#else // WIN32
+    int      fd;
+#endif // WIN32
+    uint64_t size;
+};
+
+// Read from an archive at the given offset, returns the number of bytes
+// read.
+static size_t _fseqArchiveRead(struct _FSeqArchive* archive, uint64_t offset, void* out, size_t size)
+{
+    size_t count = 0;
+#if defined(WIN32) || defined(_WIN32)
+    if (0 == _fseeki64(archive->f, (__int64)offset, SEEK_SET))
+    {
+        count = fread(out, 1, size, archive->f);
+    }
+#else // WIN32
+    while (count < size)
+    {
+        const ssize_t r = pread(archive->fd, (char*)out + count, size - count, (off_t)(offset + count));
+        if (r > 0)
+        {
+            count += (size_t)r;
+        }
+        else if (0 == r || errno != EINTR)
+        {
+            break;
+        }
+    }
+#endif // WIN32
+    return count;
+}
+
+// Parse a numeric header field. The fields are octal, or base-256 with the
+// high bit of the first byte set for values that do not fit.
+static FSeqBool _fseqTarNumber(const unsigned char* in, size_t size, uint64_t* out)
+{
+    size_t i = 0;
+    *out = 0;
+    if (in[0] & 0x80)
+    {
+        if (in[0] != 0x80)
+        {
+            return FSEQ_FALSE;
+        }
+        for (i = 1; i < size; ++i)
+        {
+            if (*out >> 56)
+            {
+                return FSEQ_FALSE;
+            }
+            *out = (*out << 8) | in[i];
+        }
+        return FSEQ_TRUE;
+    }
+    for (; i < size && (' ' == in[i] || 0 == in[i]); ++i)
+        ;
+    for (; i < size && in[i] >= '0' && in[i] <= '7'; ++i)
+    {
+        *out = (*out << 3) | (uint64_t)(in[i] - '0');
+    }
+    return i == size || ' ' == in[i] || 0 == in[i];
+}
+
+// Check the header checksum, the sum of the header bytes with the checksum
+// field counted as spaces. Some old archivers used signed bytes.
+static FSeqBool _fseqTarChecksum(const unsigned char* header)
+{
+    uint64_t value     = 0;
+    int64_t  sum       = 0;
+    int64_t  sumSigned = 0;
+    if (!_fseqTarNumber(header + 148, 8, &value))
+    {
+        return FSEQ_FALSE;
+    }
+    for (size_t i = 0; i < _FSEQ_TAR_BLOCK; ++i)
+    {
+        const unsigned char c = i >= 148 && i < 156 ? ' ' : header[i];
+        sum       += c;
+        sumSigned += (signed char)c;
+    }
+    return (uint64_t)sum == value || (uint64_t)sumSigned == value;
+}
+
+// Find the path and size in a pax extended header. The records have the
+// form "length key=value\n". Returns false if the size is not a number or
+// does not fit in 64 bits.
+static FSeqBool _fseqTarPax(
+    const char* in,
+    size_t      size,
+    char*       path,
+    size_t*     pathLen,
+    uint64_t*   memberSize,
+    FSeqBool*   hasSize)
+{
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t      len   = 0;
+        size_t      j     = i;
+        const char* key   = NULL;
+        const char* value = NULL;
+        const char* end   = NULL;
+        for (; j < size && in[j] >= '0' && in[j] <= '9'; ++j)
+        {
+            len = len * 10 + (size_t)(in[j] - '0');
+        }
+        if (0 == len || j >= size || in[j] != ' ' || len > size - i)
+        {
+            break;
+        }
+        key   = in + j + 1;
+        end   = in + i + len - 1;
+        value = key;
+        for (; value < end && *value != '='; ++value)
+            ;
+        if (value < end)
+        {
+            const size_t keyLen   = (size_t)(value - key);
+            const size_t valueLen = (size_t)(end - value - 1);
+            ++value;
+            if (4 == keyLen && 0 == memcmp(key, "path", 4))
+            {
+                if (valueLen < FSEQ_STRING_LEN)
+                {
+                    memcpy(path, value, valueLen);
+                    *pathLen = valueLen;
+                }
+                else
+                {
+                    *pathLen = FSEQ_STRING_LEN;
+                }
+            }
+            else if (4 == keyLen && 0 == memcmp(key, "size", 4))
+            {
+                uint64_t n = 0;
+                size_t   k = 0;
+                for (; k < valueLen && value[k] >= '0' && value[k] <= '9'; ++k)
+                {
+                    const uint64_t digit = (uint64_t)(value[k] - '0');
+                    if (n > (UINT64_MAX - digit) / 10)
+                    {
+                        return FSEQ_FALSE;
+                    }
+                    n = n * 10 + digit;
+                }
+                if (0 == valueLen || k != valueLen)
+                {
+                    return FSEQ_FALSE;
+                }
+                *memberSize = n;
+                *hasSize = FSEQ_TRUE;
+            }
+        }
+        i += len;
+    }
+    return FSEQ_TRUE;
+}
+
+struct FSeqDirEntry* fseqArchiveList(
+    const char*                  fileName,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    struct _FSeqArchive  archive;
+    struct FSeqGroup*    group      = NULL;
+    struct FSeqDirEntry* out        = NULL;
+    unsigned char        header[_FSEQ_TAR_BLOCK];
+    char                 name[FSEQ_STRING_LEN];
+    char                 longName[FSEQ_STRING_LEN];
+    size_t               longLen    = 0;
+    FSeqBool             hasLong    = FSEQ_FALSE;
+    uint64_t             paxSize    = 0;
+    FSeqBool             hasPaxSize = FSEQ_FALSE;
+    char*                data       = NULL;
+    uint64_t             offset     = 0;
+    FSeqBool             skipped    = FSEQ_FALSE;
+    FSeqBool             result     = FSEQ_TRUE;
+
+#if defined(WIN32) || defined(_WIN32)
+    {
+        wchar_t* wBuf = _fseqWideString(fileName);
+        __int64  end  = -1;
+        archive.f = wBuf ? _wfopen(wBuf, L"rb") : NULL;
+        free(wBuf);
+        if (archive.f && 0 == _fseeki64(archive.f, 0, SEEK_END))
+        {
+            end = _ftelli64(archive.f);
+        }
+        if (end < 0)
+        {
+            if (archive.f)
+            {
+                fclose(archive.f);
+            }
+            _fseqSetError(error);
+            return NULL;
+        }
+        archive.size = (uint64_t)end;
+    }
+#else // WIN32
+    {
+        struct stat st;
+        archive.fd = open(fileName, O_RDONLY | O_CLOEXEC);
+        if (-1 == archive.fd || fstat(archive.fd, &st) != 0)
+        {
+            if (archive.fd != -1)
+            {
+                close(archive.fd);
+            }
+            _fseqSetError(error);
+            return NULL;
+        }
+        archive.size = (uint64_t)st.st_size;
+    }
+#if defined(POSIX_FADV_RANDOM)
+    // Only the headers are read, read ahead would also read the data.
+    posix_fadvise(archive.fd, 0, 0, POSIX_FADV_RANDOM);
+#endif // POSIX_FADV_RANDOM
+#endif // WIN32
+
+    group = fseqGroupCreate(options, error);
+    while (group)
+    {
+        const size_t  count   = _fseqArchiveRead(&archive, offset, header, _FSEQ_TAR_BLOCK);
+        uint64_t      size    = 0;
+        uint64_t      next    = 0;
+        size_t        nameLen = 0;
+        char          flag    = 0;
+        FSeqFileType  type    = FSEQ_FILE_TYPE_FILE;
+
+        // The archive ends with two zero blocks, although some archivers
+        // omit them.
+        if (0 == count || (_FSEQ_TAR_BLOCK == count && 0 == header[0] && 0 == memcmp(header, header + 1, _FSEQ_TAR_BLOCK - 1)))
+        {
+            break;
+        }
+        if (count != _FSEQ_TAR_BLOCK ||
+            !_fseqTarChecksum(header) ||
+            !_fseqTarNumber(header + 124, 12, &size))
+        {
+            result = FSEQ_FALSE;
+            break;
+        }
+        if (hasPaxSize)
+        {
+            size = paxSize;
+            hasPaxSize = FSEQ_FALSE;
+        }
+
+        // The member data must fit in the archive, which also keeps the
+        // offset of the next header from wrapping around.
+        if (size > archive.size - offset - _FSEQ_TAR_BLOCK)
+        {
+            result = FSEQ_FALSE;
+            break;
+        }
+        flag = (char)header[156];
+
+        switch (flag)
+        {
+        case 'L':
+        case 'x':
+            // The name of the next member.
+            if (size > _FSEQ_TAR_PAX_MAX)
+            {
+                result = FSEQ_FALSE;
+                break;
+            }
+            data = (char*)malloc((size_t)size + 1);
+            if (!data || _fseqArchiveRead(&archive, offset + _FSEQ_TAR_BLOCK, data, (size_t)size) != size)
+            {
+                result = FSEQ_FALSE;
+                break;
+            }
+            if ('L' == flag)
+            {
+                data[size] = 0;
+                longLen = strlen(data);
+                if (longLen < FSEQ_STRING_LEN)
+                {
+                    memcpy(longName, data, longLen);
+                }
+                hasLong = FSEQ_TRUE;
+            }
+            else
+            {
+                size_t pathLen = SIZE_MAX;
+                if (!_fseqTarPax(data, (size_t)size, longName, &pathLen, &paxSize, &hasPaxSize))
+                {
+                    result = FSEQ_FALSE;
+                    break;
+                }
+                if (pathLen != SIZE_MAX)
+                {
+                    longLen = pathLen;
+                    hasLong = FSEQ_TRUE;
+                }
+            }
+            free(data);
+            data = NULL;
+            break;
+
+        case 'K':
+        case 'g':
+        case 'V':
+            // Link names, global extended headers, and volume labels.
+            break;
+
+        default:
+            if (hasLong)
+            {
+                nameLen = longLen;
+                if (nameLen < FSEQ_STRING_LEN)
+                {
+                    memcpy(name, longName, nameLen);
+                }
+                hasLong = FSEQ_FALSE;
+            }
+            else
+            {
+                // The ustar format splits long names into a prefix and a
+                // name.
+                const size_t prefixLen = 0 == memcmp(header + 257, "ustar", 5) ?
+                    strnlen((const char*)header + 345, 155) :
+                    0;
+                const size_t baseLen = strnlen((const char*)header, 100);
+                if (prefixLen > 0)
+                {
+                    memcpy(name, header + 345, prefixLen);
+                    name[prefixLen] = '/';
+                    memcpy(name + prefixLen + 1, header, baseLen);
+                    nameLen = prefixLen + 1 + baseLen;
+                }
+                else
+                {
+                    memcpy(name, header, baseLen);
+                    nameLen = baseLen;
+                }
+            }
+            // Links, directories, and other special files have no data.
+            switch (flag)
+            {
+            case '1': size = 0; break;
+            case '2': type = FSEQ_FILE_TYPE_LINK; size = 0; break;
+            case '5': type = FSEQ_FILE_TYPE_DIR; size = 0; break;
+            case 'D': type = FSEQ_FILE_TYPE_DIR; break;
+            case '3':
+            case '4':
+            case '6': type = FSEQ_FILE_TYPE_OTHER; size = 0; break;
+            default: break;
+            }
+            if (nameLen >= FSEQ_STRING_LEN)
+            {
+                // Names that are too long are skipped.
+                skipped = FSEQ_TRUE;
+                break;
+            }
+            if (nameLen > 1 && '/' == name[nameLen - 1])
+            {
+                type = FSEQ_FILE_TYPE_DIR;
+                --nameLen;
+            }
+            name[nameLen] = 0;
+            if (nameLen > 0 && !_fseqDirListAdd(&group->group, name, nameLen, type, &group->options))
+            {
+                result = FSEQ_FALSE;
+            }
+            break;
+        }
+        if (data)
+        {
+            free(data);
+            data = NULL;
+        }
+        if (!result)
+        {
+            break;
+        }
+        next = offset + _FSEQ_TAR_BLOCK + (size + _FSEQ_TAR_BLOCK - 1) / _FSEQ_TAR_BLOCK * _FSEQ_TAR_BLOCK;
+        if (next <= offset)
+        {
+            result = FSEQ_FALSE;
+            break;
+        }
+        offset = next;
+    }
+
+    if (group)
+    {
+        out = fseqGroupList(group, error);
+        fseqGroupDel(group);
+    }
+#if defined(WIN32) || defined(_WIN32)
+    fclose(archive.f);
+#else // WIN32
+    close(archive.fd);
+#endif // WIN32
+    if (!result || skipped)
+    {
+        _fseqSetError(error);
+    }
+    return out;
+}
+
+// The directory list encoding is a header followed by the entries:
+// * uint32_t - _FSEQ_LIST_MAGIC
+// * uint32_t - The number of entries
+// For each entry:
+// * uint16_t[5] - The name length and the file name component sizes
+// * uint8_t[2] - The file type and frame padding
+// * int64_t[4] - The frame minimum, maximum, count, and first frame of the
+//   frame set
+// * uint64_t - The number of frame set words
+// * The name and the frame set words
+// Values are stored in the native byte order.
+#define _FSEQ_LIST_MAGIC 0x4c514546u
+#define _FSEQ_LIST_HEADER_SIZE 8
+#define _FSEQ_LIST_ENTRY_SIZE (5 * 2 + 2 + 4 * 8 + 8)
+
+// Get the original file name and component sizes of a directory entry.
+static FSeqBool _fseqDirEntryName(
+    const struct FSeqDirEntry* entry,
+    char*                      buf,
+    const char**               name,
+    struct FSeqFileNameSizes*  sizes)
+{
+    if (entry->name)
+    {
+        *name  = entry->name;
+        *sizes = entry->sizes;
+        return FSEQ_TRUE;
+    }
+    if (entry->fileName.base)
+    {
+        const struct FSeqFileName* f = &entry->fileName;
+        const int r = snprintf(
+            buf,
+            FSEQ_STRING_LEN,
+            "%s%s%s%s",
+            f->path ? f->path : "",
+            f->base,
+            f->number ? f->number : "",
+            f->extension ? f->extension : "");
+        if (r < 0 || r >= FSEQ_STRING_LEN)
+        {
+            return FSEQ_FALSE;
+        }
+        *name = buf;
+        sizes->path      = (unsigned short)(f->path ? strlen(f->path) : 0);
+        sizes->base      = (unsigned short)strlen(f->base);
+        sizes->number    = (unsigned short)(f->number ? strlen(f->number) : 0);
+        sizes->extension = (unsigned short)(f->extension ? strlen(f->extension) : 0);
+        return FSEQ_TRUE;
+    }
+    return FSEQ_FALSE;
+}
+
+size_t fseqDirListEncode(const struct FSeqDirEntry* value, void* out, size_t max)
+{
+    unsigned char* p     = (unsigned char*)out;
+    size_t         size  = _FSEQ_LIST_HEADER_SIZE;
+    uint32_t       count = 0;
+    char           buf[FSEQ_STRING_LEN];
+
+    for (const struct FSeqDirEntry* entry = value; entry; entry = entry->next)
+    {
+        const char*              name = NULL;
+        struct FSeqFileNameSizes sizes;
+        uint16_t                 header[5];
+        uint8_t                  bytes[2];
+        int64_t                  frames[4];
+        uint64_t                 wordCount = entry->frames.wordCount;
+        size_t                   entrySize = 0;
+
+        if (!_fseqDirEntryName(entry, buf, &name, &sizes))
+        {
+            return 0;
+        }
+        header[0] = (uint16_t)strlen(name);
+        header[1] = sizes.path;
+        header[2] = sizes.base;
+        header[3] = sizes.number;
+        header[4] = sizes.extension;
+        bytes[0]  = entry->type;
+        bytes[1]  = entry->framePadding;
+        frames[0] = entry->frameMin;
+        frames[1] = entry->frameMax;
+        frames[2] = entry->frameCount;
+        frames[3] = entry->frames.first;
+        entrySize = _FSEQ_LIST_ENTRY_SIZE + header[0] + wordCount * sizeof(uint64_t);
+        if (out && size + entrySize <= max)
+        {
+            unsigned char* e = p + size;
+            memcpy(e, header, sizeof(header));
+            e += sizeof(header);
+            memcpy(e, bytes, sizeof(bytes));
+            e += sizeof(bytes);
+            memcpy(e, frames, sizeof(frames));
+            e += sizeof(frames);
+            memcpy(e, &wordCount, sizeof(uint64_t));
+            e += sizeof(uint64_t);
+            memcpy(e, name, header[0]);
+            e += header[0];
+            if (wordCount)
+            {
+                memcpy(e, entry->frames.words, wordCount * sizeof(uint64_t));
+            }
+        }
+        size += entrySize;
+        ++count;
+    }
+    if (out && size <= max)
+    {
+        const uint32_t magic = _FSEQ_LIST_MAGIC;
+        memcpy(p, &magic, sizeof(uint32_t));
+        memcpy(p + 4, &count, sizeof(uint32_t));
+    }
+    return size;
+}
+
+struct FSeqDirEntry* fseqDirListDecode(
+    const void* in,
+    size_t      size,
+    FSeqBool    splitFileNames,
+    FSeqBool*   error)
+{
+    struct FSeqDirEntry*       out   = NULL;
+    struct FSeqDirEntry*       last  = NULL;
+    const unsigned char*       p     = (const unsigned char*)in;
+    const unsigned char* const end   = p + size;
+    uint32_t                   magic = 0;
+    uint32_t                   count = 0;
+    uint32_t                   i     = 0;
+
+    if (size < _FSEQ_LIST_HEADER_SIZE)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    memcpy(&magic, p, sizeof(uint32_t));
+    memcpy(&count, p + 4, sizeof(uint32_t));
+    if (magic != _FSEQ_LIST_MAGIC)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    p += _FSEQ_LIST_HEADER_SIZE;
+
+    for (; i < count; ++i)
+    {
+        struct FSeqDirEntry* entry = NULL;
+        uint16_t             header[5];
+        uint8_t              bytes[2];
+        int64_t              frames[4];
+        uint64_t             wordCount = 0;
+
+        if ((size_t)(end - p) < _FSEQ_LIST_ENTRY_SIZE)
+        {
+            break;
+        }
+        memcpy(header, p, sizeof(header));
+        p += sizeof(header);
+        memcpy(bytes, p, sizeof(bytes));
+        p += sizeof(bytes);
+        memcpy(frames, p, sizeof(frames));
+        p += sizeof(frames);
+        memcpy(&wordCount, p, sizeof(uint64_t));
+        p += sizeof(uint64_t);
+        if ((size_t)(end - p) < header[0] ||
+            wordCount > (size_t)(end - p - header[0]) / sizeof(uint64_t) ||
+            (size_t)header[1] + header[2] + header[3] + header[4] != header[0])
+        {
+            break;
+        }
+
+        entry = (struct FSeqDirEntry*)malloc(sizeof(struct FSeqDirEntry));
+        if (!entry)
+        {
+            break;
+        }
+        fseqDirEntryInit(entry);
+        if (!out)
+        {
+            out = entry;
+        }
+        else
+        {
+            last->next = entry;
+        }
+        last = entry;
+
+        entry->sizes.path      = header[1];
+        entry->sizes.base      = header[2];
+        entry->sizes.number    = header[3];
+        entry->sizes.extension = header[4];
+        entry->type            = bytes[0];
+        entry->framePadding    = bytes[1];
+        entry->frameMin        = frames[0];
+        entry->frameMax        = frames[1];
+        entry->frameCount      = frames[2];
+        entry->name            = _fseqStrDup((const char*)p, header[0]);
+        p += header[0];
+        if (!entry->name)
+        {
+            break;
+        }
+        if (splitFileNames)
+        {
+            if (!fseqDirEntrySplit(entry))
+            {
+                break;
+            }
+            free(entry->name);
+            entry->name = NULL;
+        }
+        if (wordCount)
+        {
+            entry->frames.first = frames[3];
+            entry->frames.words = (uint64_t*)malloc((size_t)wordCount * sizeof(uint64_t));
+            if (!entry->frames.words)
+            {
+                break;
+            }
+            memcpy(entry->frames.words, p, (size_t)wordCount * sizeof(uint64_t));
+            entry->frames.wordCount = (size_t)wordCount;
+            p += wordCount * sizeof(uint64_t);
+        }
+    }
+    if (i < count)
+    {
+        _fseqSetError(error);
+    }
+    return out;
+}
+
+FSeqBool fseqDaemonSocketPath(char* out, size_t max)
+{
+#if defined(WIN32) || defined(_WIN32)
+    return FSEQ_FALSE;
+#else // WIN32
+    const char* env = getenv("FSEQD_SOCKET");
+    int         r   = 0;
+    if (env && env[0])
+    {
+        r = snprintf(out, max, "%s", env);
+    }
+    else if ((env = getenv("XDG_RUNTIME_DIR")) && env[0])
+    {
+        r = snprintf(out, max, "%s/fseqd.sock", env);
+    }
+    else
+    {
+        r = snprintf(out, max, "/tmp/fseqd-%lu.sock", (unsigned long)getuid());
+    }
+    return r > 0 && (size_t)r < max;
+#endif // WIN32
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+void fseqDaemonOptionsInit(struct FSeqDaemonOptions* value)
+{
+    value->maxDirs = 1024;
+}
+
+struct FSeqDaemon* fseqDaemonCreate(
+    const char*                     socketPath,
+    const struct FSeqDaemonOptions* options,
+    FSeqBool*                       error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+void fseqDaemonDel(struct FSeqDaemon* value)
+{}
+
+struct FSeqDaemonClient* fseqDaemonConnect(const char* socketPath, FSeqBool* error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+void fseqDaemonDisconnect(struct FSeqDaemonClient* value)
+{}
+
+struct FSeqDirEntry* fseqDaemonList(
+    struct FSeqDaemonClient*     client,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+#else // WIN32
+
+// The daemon protocol. A request is:
+// * uint32_t - _FSEQ_DAEMON_MAGIC
+// * uint8_t[_FSEQ_DAEMON_OPTIONS] - The directory listing options
+// * uint16_t - The length of the path
+// * The absolute directory path
+// A reply is:
+// * uint32_t - _FSEQ_DAEMON_MAGIC
+// * uint32_t - Zero if the directory was listed
+// * uint64_t - The size of the encoded directory list that follows
+#define _FSEQ_DAEMON_MAGIC 0x44514546u
+#define _FSEQ_DAEMON_OPTIONS 6
+#define _FSEQ_DAEMON_REQUEST_SIZE (4 + _FSEQ_DAEMON_OPTIONS + 2)
+#define _FSEQ_DAEMON_REPLY_SIZE 16
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif // MSG_NOSIGNAL
+
+static FSeqBool _fseqReadAll(int fd, void* data, size_t size)
+{
+    unsigned char* p = (unsigned char*)data;
+    while (size > 0)
+    {
+        const ssize_t count = read(fd, p, size);
+        if (count < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return FSEQ_FALSE;
+        }
+        p    += count;
+        size -= (size_t)count;
+    }
+    return FSEQ_TRUE;
+}
+
+static FSeqBool _fseqSendAll(int fd, const void* data, size_t size)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    while (size > 0)
+    {
+        const ssize_t count = send(fd, p, size, MSG_NOSIGNAL);
+        if (count < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return FSEQ_FALSE;
+        }
+        p    += count;
+        size -= (size_t)count;
+    }
+    return FSEQ_TRUE;
+}
+
+static void _fseqDaemonOptionsEncode(const struct FSeqDirOptions* options, uint8_t* out)
+{
+    out[0] = options->dotAndDotDotDirs;
+    out[1] = options->dotFiles;
+    out[2] = options->sequence;
+    out[3] = options->frames;
+    out[4] = options->fileNameOptions.negativeNumbers;
+    out[5] = options->fileNameOptions.maxNumberDigits;
+}
+
+static void _fseqDaemonOptionsDecode(const uint8_t* in, struct FSeqDirOptions* out)
+{
+    fseqDirOptionsInit(out);
+    out->dotAndDotDotDirs                = in[0];
+    out->dotFiles                        = in[1];
+    out->sequence                        = in[2];
+    out->frames                          = in[3];
+    out->fileNameOptions.negativeNumbers = in[4];
+    out->fileNameOptions.maxNumberDigits = in[5];
+    out->splitFileNames                  = FSEQ_FALSE;
+}
+
+static int _fseqDaemonSocket(const char* socketPath, struct sockaddr_un* address)
+{
+    char buf[FSEQ_STRING_LEN];
+    if (!socketPath)
+    {
+        if (!fseqDaemonSocketPath(buf, FSEQ_STRING_LEN))
+        {
+            return -1;
+        }
+        socketPath = buf;
+    }
+    if (strlen(socketPath) >= sizeof(address->sun_path))
+    {
+        return -1;
+    }
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, socketPath);
+    return socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+}
+
+// Whether the other end of a connected socket runs as the same user. The
+// default socket path is in /tmp, where another user could bind it first.
+static FSeqBool _fseqDaemonPeerIsUser(int fd)
+{
+#if defined(__linux__)
+    struct ucred cred;
+    socklen_t    len = sizeof(struct ucred);
+    return
+        0 == getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) &&
+        cred.uid == geteuid();
+#else // __linux__
+    uid_t uid = 0;
+    gid_t gid = 0;
+    return 0 == getpeereid(fd, &uid, &gid) && uid == geteuid();
+#endif // __linux__
+}
+
+// This struct provides a cached reply, shared by the clients that are
+// sending it.
+struct _FSeqDaemonReply
+{
+    size_t        refs;
+    size_t        size;
+    unsigned char data[1];
+};
+
+// This struct provides a cached directory listing.
+struct _FSeqDaemonEntry
+{
+    uint32_t                 hash;
+    char*                    path;
+    uint8_t                  options[_FSEQ_DAEMON_OPTIONS];
+    struct _FSeqDaemonReply* reply;
+    FSeqBool                 valid;
+    FSeqBool                 scanning;
+    size_t                   users;
+    uint64_t                 generation;
+    uint64_t                 used;
+    struct timespec          mtime;
+    int                      wd;
+    struct _FSeqDaemonEntry* next;
+};
+
+// This struct provides a client connection.
+struct _FSeqDaemonConnection
+{
+    struct FSeqDaemon*            daemon;
+    int                           fd;
+    pthread_t                     thread;
+    FSeqBool                      done;
+    struct _FSeqDaemonConnection* next;
+};
+
+struct FSeqDaemon
+{
+    pthread_mutex_t               mutex;
+    pthread_cond_t                cond;
+    FSeqBool                      stop;
+    int                           listenFd;
+    int                           stopFd[2];
+    int                           inotifyFd;
+    pthread_t                     acceptThread;
+    pthread_t                     inotifyThread;
+    FSeqBool                      acceptStarted;
+    FSeqBool                      inotifyStarted;
+    struct _FSeqDaemonEntry*      entries;
+    size_t                        entryCount;
+    uint64_t                      clock;
+    struct _FSeqDaemonConnection* connections;
+    size_t                        maxDirs;
+    char                          socketPath[FSEQ_STRING_LEN];
+};
+
+void fseqDaemonOptionsInit(struct FSeqDaemonOptions* value)
+{
+    value->maxDirs = 1024;
+}
+
+static void _fseqDaemonReplyUnref(struct FSeqDaemon* daemon, struct _FSeqDaemonReply* reply)
+{
+    if (reply)
+    {
+        pthread_mutex_lock(&daemon->mutex);
+        const size_t refs = --reply->refs;
+        pthread_mutex_unlock(&daemon->mutex);
+        if (0 == refs)
+        {
+            free(reply);
+        }
+    }
+}
+
+static void _fseqDaemonEntryDel(struct FSeqDaemon* daemon, struct _FSeqDaemonEntry* entry)
+{
+    if (entry->reply && 0 == --entry->reply->refs)
+    {
+        free(entry->reply);
+    }
+#if defined(__linux__)
+    if (entry->wd >= 0)
+    {
+        // The watch is shared by the entries with the same path.
+        FSeqBool shared = FSEQ_FALSE;
+        for (const struct _FSeqDaemonEntry* i = daemon->entries; i && !shared; i = i->next)
+        {
+            shared = i != entry && i->wd == entry->wd;
+        }
+        if (!shared)
+        {
+            inotify_rm_watch(daemon->inotifyFd, entry->wd);
+        }
+    }
+#endif // __linux__
+    free(entry->path);
+    free(entry);
+}
+
+// Remove the least recently used entry that is not in use. The mutex must
+// be locked.
+static void _fseqDaemonEvict(struct FSeqDaemon* daemon)
+{
+    struct _FSeqDaemonEntry** lru = NULL;
+    for (struct _FSeqDaemonEntry** i = &daemon->entries; *i; i = &(*i)->next)
+    {
+        if (!(*i)->scanning && 0 == (*i)->users && (!lru || (*i)->used < (*lru)->used))
+        {
+            lru = i;
+        }
+    }
+    if (lru)
+    {
+        struct _FSeqDaemonEntry* entry = *lru;
+        *lru = entry->next;
+        _fseqDaemonEntryDel(daemon, entry);
+        --daemon->entryCount;
+    }
+}
+
+// Find or create a cache entry. The mutex must be locked.
+static struct _FSeqDaemonEntry* _fseqDaemonEntry(
+    struct FSeqDaemon* daemon,
+    const char*        path,
+    size_t             pathLen,
+    const uint8_t*     options)
+{
+    struct _FSeqDaemonEntry* out  = NULL;
+    uint32_t                 hash = 2166136261u;
+
+    for (size_t i = 0; i < _FSEQ_DAEMON_OPTIONS; ++i)
+    {
+        hash = (hash ^ options[i]) * 16777619u;
+    }
+    for (size_t i = 0; i < pathLen; ++i)
+    {
+        hash = (hash ^ (uint8_t)path[i]) * 16777619u;
+    }
+    for (out = daemon->entries; out; out = out->next)
+    {
+        if (hash == out->hash &&
+            0 == memcmp(options, out->options, _FSEQ_DAEMON_OPTIONS) &&
+            0 == strcmp(path, out->path))
+        {
+            return out;
+        }
+    }
+
+    while (daemon->entryCount >= daemon->maxDirs && daemon->entries)
+    {
+        const size_t count = daemon->entryCount;
+        _fseqDaemonEvict(daemon);
+        if (count == daemon->entryCount)
+        {
+            break;
+        }
+    }
+    out = (struct _FSeqDaemonEntry*)calloc(1, sizeof(struct _FSeqDaemonEntry));
+    if (!out)
+    {
+        return NULL;
+    }
+    out->path = _fseqStrDup(path, pathLen);
+    if (!out->path)
+    {
+        free(out);
+        return NULL;
+    }
+    out->hash = hash;
+    memcpy(out->options, options, _FSEQ_DAEMON_OPTIONS);
+    out->wd   = -1;
+    out->next = daemon->entries;
+    daemon->entries = out;
+    ++daemon->entryCount;
+    return out;
+}
+
+// Create a reply by listing a directory.
+static struct _FSeqDaemonReply* _fseqDaemonScan(const char* path, const uint8_t* options)
+{
+    struct FSeqDirOptions    dirOptions;
+    struct FSeqDirEntry*     list   = NULL;
+    struct _FSeqDaemonReply* out    = NULL;
+    FSeqBool                 error  = FSEQ_FALSE;
+    uint32_t                 header[2];
+    uint64_t                 size   = 0;
+
+    _fseqDaemonOptionsDecode(options, &dirOptions);
+    list = fseqDirList(path, &dirOptions, &error);
+    if (!error)
+    {
+        size = fseqDirListEncode(list, NULL, 0);
+    }
+    out = (struct _FSeqDaemonReply*)malloc(sizeof(struct _FSeqDaemonReply) + _FSEQ_DAEMON_REPLY_SIZE + size);
+    if (out)
+    {
+        out->refs = 1;
+        out->size = _FSEQ_DAEMON_REPLY_SIZE + size;
+        if (size && fseqDirListEncode(list, out->data + _FSEQ_DAEMON_REPLY_SIZE, size) != size)
+        {
+            error = FSEQ_TRUE;
+            size  = 0;
+            out->size = _FSEQ_DAEMON_REPLY_SIZE;
+        }
+        header[0] = _FSEQ_DAEMON_MAGIC;
+        header[1] = error ? 1 : 0;
+        memcpy(out->data, header, sizeof(header));
+        memcpy(out->data + 8, &size, sizeof(uint64_t));
+    }
+    fseqDirListDel(list);
+    return out;
+}
+
+// Get the modification time of a directory.
+static FSeqBool _fseqDaemonModified(const char* path, struct timespec* out)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        return FSEQ_FALSE;
+    }
+#if defined(__APPLE__)
+    *out = st.st_mtimespec;
+#else // __APPLE__
+    *out = st.st_mtim;
+#endif // __APPLE__
+    return FSEQ_TRUE;
+}
+
+// Get the reply for a request. Concurrent requests for the same listing
+// wait for a single scan of the directory.
+static struct _FSeqDaemonReply* _fseqDaemonRequest(
+    struct FSeqDaemon* daemon,
+    const char*        path,
+    size_t             pathLen,
+    const uint8_t*     options)
+{
+    struct _FSeqDaemonEntry* entry      = NULL;
+    struct _FSeqDaemonReply* out        = NULL;
+    struct timespec          mtime;
+    uint64_t                 generation = 0;
+    FSeqBool                 modified   = FSEQ_FALSE;
+
+    pthread_mutex_lock(&daemon->mutex);
+    entry = _fseqDaemonEntry(daemon, path, pathLen, options);
+    if (!entry)
+    {
+        pthread_mutex_unlock(&daemon->mutex);
+        return NULL;
+    }
+    entry->used = ++daemon->clock;
+    ++entry->users;
+    for (;;)
+    {
+        if (entry->scanning)
+        {
+            pthread_cond_wait(&daemon->cond, &daemon->mutex);
+            continue;
+        }
+        if (!entry->valid || !entry->reply)
+        {
+            break;
+        }
+        if (entry->wd < 0)
+        {
+            // Without a watch, check the modification time.
+            const uint64_t used = entry->generation;
+            pthread_mutex_unlock(&daemon->mutex);
+            modified = _fseqDaemonModified(entry->path, &mtime);
+            pthread_mutex_lock(&daemon->mutex);
+            if (entry->scanning || used != entry->generation)
+            {
+                continue;
+            }
+            if (!modified ||
+                mtime.tv_sec != entry->mtime.tv_sec ||
+                mtime.tv_nsec != entry->mtime.tv_nsec)
+            {
+                entry->valid = FSEQ_FALSE;
+                break;
+            }
+        }
+        out = entry->reply;
+        ++out->refs;
+        --entry->users;
+        pthread_mutex_unlock(&daemon->mutex);
+        return out;
+    }
+
+    // Scan the directory.
+    entry->scanning = FSEQ_TRUE;
+    generation = ++entry->generation;
+#if defined(__linux__)
+    if (entry->wd < 0 && daemon->inotifyFd != -1)
+    {
+        entry->wd = inotify_add_watch(
+            daemon->inotifyFd,
+            entry->path,
+            IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB |
+            IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    }
+#endif // __linux__
+    pthread_mutex_unlock(&daemon->mutex);
+
+    modified = _fseqDaemonModified(entry->path, &mtime);
+    out = _fseqDaemonScan(entry->path, options);
+
+    pthread_mutex_lock(&daemon->mutex);
+    if (entry->reply && 0 == --entry->reply->refs)
+    {
+        free(entry->reply);
+    }
+    entry->reply = out;
+    entry->mtime = mtime;
+    // The listing is only reused if the directory did not change while it
+    // was scanned.
+    entry->valid = out && modified && generation == entry->generation && 0 == out->data[4];
+    entry->scanning = FSEQ_FALSE;
+    if (out)
+    {
+        ++out->refs;
+    }
+    --entry->users;
+    pthread_cond_broadcast(&daemon->cond);
+    pthread_mutex_unlock(&daemon->mutex);
+    return out;
+}
+
+static void* _fseqDaemonConnectionThread(void* data)
+{
+    struct _FSeqDaemonConnection* connection = (struct _FSeqDaemonConnection*)data;
+    struct FSeqDaemon*            daemon     = connection->daemon;
+    unsigned char                 request[_FSEQ_DAEMON_REQUEST_SIZE];
+    char                          path[FSEQ_STRING_LEN];
+
+    for (;;)
+    {
+        uint32_t                 magic   = 0;
+        uint16_t                 pathLen = 0;
+        struct _FSeqDaemonReply* reply   = NULL;
+        FSeqBool                 sent    = FSEQ_FALSE;
+
+        if (!_fseqReadAll(connection->fd, request, _FSEQ_DAEMON_REQUEST_SIZE))
+        {
+            break;
+        }
+        memcpy(&magic, request, sizeof(uint32_t));
+        memcpy(&pathLen, request + 4 + _FSEQ_DAEMON_OPTIONS, sizeof(uint16_t));
+        if (magic != _FSEQ_DAEMON_MAGIC ||
+            0 == pathLen ||
+            pathLen >= FSEQ_STRING_LEN ||
+            !_fseqReadAll(connection->fd, path, pathLen))
+        {
+            break;
+        }
+        path[pathLen] = 0;
+
+        reply = _fseqDaemonRequest(daemon, path, pathLen, request + 4);
+        if (!reply)
+        {
+            break;
+        }
+        sent = _fseqSendAll(connection->fd, reply->data, reply->size);
+        _fseqDaemonReplyUnref(daemon, reply);
+        if (!sent)
+        {
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&daemon->mutex);
+    connection->done = FSEQ_TRUE;
+    pthread_mutex_unlock(&daemon->mutex);
+    return NULL;
+}
+
+// Join the connection threads that have finished. The mutex must not be
+// locked.
+static void _fseqDaemonReap(struct FSeqDaemon* daemon, FSeqBool all)
+{
+    struct _FSeqDaemonConnection* done = NULL;
+
+    pthread_mutex_lock(&daemon->mutex);
+    for (struct _FSeqDaemonConnection** i = &daemon->connections; *i;)
+    {
+        struct _FSeqDaemonConnection* connection = *i;
+        if (all || connection->done)
+        {
+            *i = connection->next;
+            connection->next = done;
+            done = connection;
+        }
+        else
+        {
+            i = &connection->next;
+        }
+    }
+    pthread_mutex_unlock(&daemon->mutex);
+
+    while (done)
+    {
+        struct _FSeqDaemonConnection* next = done->next;
+        pthread_join(done->thread, NULL);
+        close(done->fd);
+        free(done);
+        done = next;
+    }
+}
+
+static void* _fseqDaemonAcceptThread(void* data)
+{
+    struct FSeqDaemon* daemon = (struct FSeqDaemon*)data;
+    struct pollfd      fds[2];
+
+    fds[0].fd     = daemon->listenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd     = daemon->stopFd[0];
+    fds[1].events = POLLIN;
+    for (;;)
+    {
+        struct _FSeqDaemonConnection* connection = NULL;
+        int                           fd         = -1;
+
+        fds[0].revents = fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (fds[1].revents)
+        {
+            break;
+        }
+        if (!fds[0].revents)
+        {
+            continue;
+        }
+        fd = accept(daemon->listenFd, NULL, NULL);
+        if (-1 == fd)
+        {
+            continue;
+        }
+        if (!_fseqDaemonPeerIsUser(fd))
+        {
+            close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        _fseqDaemonReap(daemon, FSEQ_FALSE);
+
+        connection = (struct _FSeqDaemonConnection*)calloc(1, sizeof(struct _FSeqDaemonConnection));
+        if (!connection)
+        {
+            close(fd);
+            continue;
+        }
+        connection->daemon = daemon;
+        connection->fd     = fd;
+        pthread_mutex_lock(&daemon->mutex);
+        if (pthread_create(&connection->thread, NULL, _fseqDaemonConnectionThread, connection) != 0)
+        {
+            pthread_mutex_unlock(&daemon->mutex);
+            close(fd);
+            free(connection);
+            continue;
+        }
+        connection->next = daemon->connections;
+        daemon->connections = connection;
+        pthread_mutex_unlock(&daemon->mutex);
+    }
+    return NULL;
+}
+
+#if defined(__linux__)
+
+// Invalidate the cached listings when the watched directories change.
+static void* _fseqDaemonInotifyThread(void* data)
+{
+    struct FSeqDaemon* daemon = (struct FSeqDaemon*)data;
+    struct pollfd      fds[2];
+    char               buf[16 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    fds[0].fd     = daemon->inotifyFd;
+    fds[0].events = POLLIN;
+    fds[1].fd     = daemon->stopFd[0];
+    fds[1].events = POLLIN;
+    for (;;)
+    {
+        ssize_t count = 0;
+
+        fds[0].revents = fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (fds[1].revents)
+        {
+            break;
+        }
+        if (!fds[0].revents)
+        {
+            continue;
+        }
+        count = read(daemon->inotifyFd, buf, sizeof(buf));
+        if (count <= 0)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&daemon->mutex);
+        for (char* p = buf; p < buf + count;)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            for (struct _FSeqDaemonEntry* entry = daemon->entries; entry; entry = entry->next)
+            {
+                if ((event->mask & IN_Q_OVERFLOW) || entry->wd == event->wd)
+                {
+                    entry->valid = FSEQ_FALSE;
+                    ++entry->generation;
+                    if (event->mask & IN_IGNORED)
+                    {
+                        entry->wd = -1;
+                    }
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+        pthread_mutex_unlock(&daemon->mutex);
+    }
+    return NULL;
+}
+
+#endif // __linux__
+
+struct FSeqDaemon* fseqDaemonCreate(
+    const char*                     socketPath,
+    const struct FSeqDaemonOptions* options,
+    FSeqBool*                       error)
+{
+    struct FSeqDaemonOptions _options;
+    struct FSeqDaemon*       out     = NULL;
+    struct sockaddr_un       address;
+    int                      fd      = -1;
+
+    if (!options)
+    {
+        fseqDaemonOptionsInit(&_options);
+        options = &_options;
+    }
+    out = (struct FSeqDaemon*)calloc(1, sizeof(struct FSeqDaemon));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    pthread_mutex_init(&out->mutex, NULL);
+    pthread_cond_init(&out->cond, NULL);
+    out->listenFd  = -1;
+    out->stopFd[0] = out->stopFd[1] = -1;
+    out->inotifyFd = -1;
+    out->maxDirs   = FSEQ_MAX(options->maxDirs, (size_t)1);
+
+    out->listenFd = _fseqDaemonSocket(socketPath, &address);
+    if (-1 == out->listenFd || pipe(out->stopFd) != 0)
+    {
+        fseqDaemonDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    strcpy(out->socketPath, address.sun_path);
+
+    // Remove a stale socket, unless another daemon is listening on it.
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd != -1)
+    {
+        if (0 == connect(fd, (struct sockaddr*)&address, sizeof(struct sockaddr_un)))
+        {
+            close(fd);
+            out->socketPath[0] = 0;
+            fseqDaemonDel(out);
+            _fseqSetError(error);
+            return NULL;
+        }
+        close(fd);
+    }
+    unlink(out->socketPath);
+    if (bind(out->listenFd, (struct sockaddr*)&address, sizeof(struct sockaddr_un)) != 0 ||
+        chmod(out->socketPath, 0600) != 0 ||
+        listen(out->listenFd, SOMAXCONN) != 0)
+    {
+        fseqDaemonDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+
+#if defined(__linux__)
+    out->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (out->inotifyFd != -1)
+    {
+        out->inotifyStarted = 0 == pthread_create(&out->inotifyThread, NULL, _fseqDaemonInotifyThread, out);
+        if (!out->inotifyStarted)
+        {
+            close(out->inotifyFd);
+            out->inotifyFd = -1;
+        }
+    }
+#endif // __linux__
+    out->acceptStarted = 0 == pthread_create(&out->acceptThread, NULL, _fseqDaemonAcceptThread, out);
+    if (!out->acceptStarted)
+    {
+        fseqDaemonDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    return out;
+}
+
+void fseqDaemonDel(struct FSeqDaemon* value)
+{
+    if (!value)
+    {
+        return;
+    }
+
+    // Stop the threads.
+    if (value->stopFd[1] != -1)
+    {
+        const char c = 0;
+        ssize_t r = write(value->stopFd[1], &c, 1);
+        (void)r;
+    }
+    if (value->acceptStarted)
+    {
+        pthread_join(value->acceptThread, NULL);
+    }
+    if (value->inotifyStarted)
+    {
+        pthread_join(value->inotifyThread, NULL);
+    }
+    pthread_mutex_lock(&value->mutex);
+    for (struct _FSeqDaemonConnection* i = value->connections; i; i = i->next)
+    {
+        shutdown(i->fd, SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&value->mutex);
+    _fseqDaemonReap(value, FSEQ_TRUE);
+
+    while (value->entries)
+    {
+        struct _FSeqDaemonEntry* entry = value->entries;
+        value->entries = entry->next;
+        _fseqDaemonEntryDel(value, entry);
+    }
+    if (value->listenFd != -1)
+    {
+        close(value->listenFd);
+        if (value->socketPath[0])
+        {
+            unlink(value->socketPath);
+        }
+    }
+    if (value->stopFd[0] != -1)
+    {
+        close(value->stopFd[0]);
+        close(value->stopFd[1]);
+    }
+    if (value->inotifyFd != -1)
+    {
+        close(value->inotifyFd);
+    }
+    pthread_mutex_destroy(&value->mutex);
+    pthread_cond_destroy(&value->cond);
+    free(value);
+}
+
+struct FSeqDaemonClient
+{
+    int  fd;
+    char socketPath[FSEQ_STRING_LEN];
+};
+
+static FSeqBool _fseqDaemonClientConnect(struct FSeqDaemonClient* client)
+{
+    struct sockaddr_un address;
+    client->fd = _fseqDaemonSocket(client->socketPath, &address);
+    if (client->fd != -1 &&
+        (connect(client->fd, (struct sockaddr*)&address, sizeof(struct sockaddr_un)) != 0 ||
+        !_fseqDaemonPeerIsUser(client->fd)))
+    {
+        close(client->fd);
+        client->fd = -1;
+    }
+    return client->fd != -1;
+}
+
+struct FSeqDaemonClient* fseqDaemonConnect(const char* socketPath, FSeqBool* error)
+{
+    struct FSeqDaemonClient* out = (struct FSeqDaemonClient*)malloc(sizeof(struct FSeqDaemonClient));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    if (socketPath ?
+        snprintf(out->socketPath, FSEQ_STRING_LEN, "%s", socketPath) >= FSEQ_STRING_LEN :
+        !fseqDaemonSocketPath(out->socketPath, FSEQ_STRING_LEN))
+    {
+        free(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    if (!_fseqDaemonClientConnect(out))
+    {
+        free(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    return out;
+}
+
+void fseqDaemonDisconnect(struct FSeqDaemonClient* value)
+{
+    if (value)
+    {
+        if (value->fd != -1)
+        {
+            close(value->fd);
+        }
+        free(value);
+    }
+}
+
+// Send a request and receive the reply.
+static unsigned char* _fseqDaemonClientRequest(
+    struct FSeqDaemonClient* client,
+    const unsigned char*     request,
+    size_t                   requestSize,
+    uint32_t*                status,
+    uint64_t*                size)
+{
+    unsigned char  header[_FSEQ_DAEMON_REPLY_SIZE];
+    unsigned char* out   = NULL;
+    uint32_t       magic = 0;
+
+    if (client->fd == -1 && !_fseqDaemonClientConnect(client))
+    {
+        return NULL;
+    }
+    if (!_fseqSendAll(client->fd, request, requestSize) ||
+        !_fseqReadAll(client->fd, header, _FSEQ_DAEMON_REPLY_SIZE))
+    {
+        close(client->fd);
+        client->fd = -1;
+        return NULL;
+    }
+    memcpy(&magic, header, sizeof(uint32_t));
+    memcpy(status, header + 4, sizeof(uint32_t));
+    memcpy(size, header + 8, sizeof(uint64_t));
+    if (magic != _FSEQ_DAEMON_MAGIC)
+    {
+        close(client->fd);
+        client->fd = -1;
+        return NULL;
+    }
+    out = (unsigned char*)malloc((size_t)*size + 1);
+    if (!out || !_fseqReadAll(client->fd, out, (size_t)*size))
+    {
+        free(out);
+        close(client->fd);
+        client->fd = -1;
+        return NULL;
+    }
+    return out;
+}
+
+struct FSeqDirEntry* fseqDaemonList(
+    struct FSeqDaemonClient*     client,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    struct FSeqDirOptions _options;
+    struct FSeqDirEntry*  out     = NULL;
+    unsigned char         request[_FSEQ_DAEMON_REQUEST_SIZE + FSEQ_STRING_LEN];
+    char                  absolute[PATH_MAX];
+    unsigned char*        reply   = NULL;
+    const uint32_t        magic   = _FSEQ_DAEMON_MAGIC;
+    uint16_t              pathLen = 0;
+    uint32_t              status  = 0;
+    uint64_t              size    = 0;
+
+    if (!options)
+    {
+        fseqDirOptionsInit(&_options);
+        options = &_options;
+    }
+    if (options->partial)
+    {
+        *options->partial = FSEQ_FALSE;
+    }
+
+    // The daemon lists absolute paths, so requests from different working
+    // directories share the cache.
+    if (!realpath(path, absolute) || strlen(absolute) >= FSEQ_STRING_LEN)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    pathLen = (uint16_t)strlen(absolute);
+    memcpy(request, &magic, sizeof(uint32_t));
+    _fseqDaemonOptionsEncode(options, request + 4);
+    memcpy(request + 4 + _FSEQ_DAEMON_OPTIONS, &pathLen, sizeof(uint16_t));
+    memcpy(request + _FSEQ_DAEMON_REQUEST_SIZE, absolute, pathLen);
+
+    // Reconnect once if the daemon was restarted.
+    reply = _fseqDaemonClientRequest(client, request, _FSEQ_DAEMON_REQUEST_SIZE + pathLen, &status, &size);
+    if (!reply)
+    {
+        reply = _fseqDaemonClientRequest(client, request, _FSEQ_DAEMON_REQUEST_SIZE + pathLen, &status, &size);
+    }
+    if (!reply || status != 0)
+    {
+        free(reply);
+        _fseqSetError(error);
+        return NULL;
+    }
+    out = fseqDirListDecode(reply, (size_t)size, options->splitFileNames, error);
+    free(reply);
+    return out;
+}
+
+#endif // WIN32
+
+// This struct provides an indexed directory entry.
+struct _FSeqIndexItem
+{
+    const char*                key;
+    uint32_t                   keyLen;
+    uint32_t                   extensionLen;
+    const char*                extension;
+    const char*                path;
+    const struct FSeqDirEntry* entry;
+};
+
+// This struct provides a key in a sorted run, the text of the key starts at
+// the offset into the base name of the item. The first characters of the
+// text are also stored in the key, so most comparisons do not need to read
+// the base names.
+struct _FSeqIndexKey
+{
+    uint32_t prefix;
+    uint32_t item;
+    uint32_t offset;
+};
+
+// This struct provides a sorted run of keys.
+struct _FSeqIndexRun
+{
+    struct _FSeqIndexKey* keys;
+    size_t                count;
+};
+
+// This struct provides a set of sorted runs. A run is merged with the
+// previous run unless the previous run is more than twice its size, so
+// there are at most log2(N) runs and each key is merged at most log2(N)
+// times.
+#define _FSEQ_INDEX_MAX_RUNS 64
+
+struct _FSeqIndexRuns
+{
+    struct _FSeqIndexRun runs[_FSEQ_INDEX_MAX_RUNS];
+    size_t               count;
+};
+
+// This struct provides a block of lower case base names separated by NUL
+// characters, which can be scanned for substrings with a single memmem().
+#define _FSEQ_INDEX_BLOCK_SIZE (1024 * 1024)
+
+struct _FSeqIndexBlock
+{
+    char*  data;
+    size_t size;
+    size_t capacity;
+    size_t firstItem;
+    size_t itemCount;
+};
+
+// This struct provides a directory added to the index.
+struct _FSeqIndexDir
+{
+    char*                path;
+    struct FSeqDirEntry* list;
+};
+
+struct FSeqIndex
+{
+    struct _FSeqIndexItem*  items;
+    size_t                  itemCount;
+    size_t                  itemCapacity;
+    struct _FSeqIndexRuns   names;
+    struct _FSeqIndexRuns   words;
+    struct _FSeqIndexBlock* blocks;
+    size_t                  blockCount;
+    size_t                  blockCapacity;
+    struct _FSeqIndexDir*   dirs;
+    size_t                  dirCount;
+    size_t                  dirCapacity;
+};
+
+void fseqIndexQueryInit(struct FSeqIndexQuery* value)
+{
+    value->text       = NULL;
+    value->match      = FSEQ_INDEX_MATCH_PREFIX;
+    value->extensions = NULL;
+}
+
+void fseqIndexResultInit(struct FSeqIndexResult* value)
+{
+    value->path  = NULL;
+    value->entry = NULL;
+}
+
+struct FSeqIndex* fseqIndexCreate(FSeqBool* error)
+{
+    struct FSeqIndex* out = (struct FSeqIndex*)calloc(1, sizeof(struct FSeqIndex));
+    if (!out)
+    {
+        _fseqSetError(error);
+    }
+    return out;
+}
+
+void fseqIndexDel(struct FSeqIndex* value)
+{
+    if (!value)
+    {
+        return;
+    }
+    for (size_t i = 0; i < value->names.count; ++i)
+    {
+        free(value->names.runs[i].keys);
+    }
+    for (size_t i = 0; i < value->words.count; ++i)
+    {
+        free(value->words.runs[i].keys);
+    }
+    for (size_t i = 0; i < value->blockCount; ++i)
+    {
+        free(value->blocks[i].data);
+    }
+    for (size_t i = 0; i < value->dirCount; ++i)
+    {
+        free(value->dirs[i].path);
+        fseqDirListDel(value->dirs[i].list);
+    }
+    free(value->items);
+    free(value->blocks);
+    free(value->dirs);
+    free(value);
+}
+
+size_t fseqIndexSize(const struct FSeqIndex* value)
+{
+    return value->itemCount;
+}
+
+// Find a string in a buffer.
+static const void* _fseqMemmem(const void* data, size_t size, const void* value, size_t len)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    return memmem(data, size, value, len);
+#else // __linux__
+    const char*       p   = (const char*)data;
+    const char* const end = p + size;
+    while ((size_t)(end - p) >= len)
+    {
+        p = (const char*)memchr(p, *(const char*)value, end - p - len + 1);
+        if (!p)
+        {
+            break;
+        }
+        if (0 == memcmp(p, value, len))
+        {
+            return p;
+        }
+        ++p;
+    }
+    return NULL;
+#endif // __linux__
+}
+
+static inline char _fseqToLower(char value)
+{
+    return value >= 'A' && value <= 'Z' ? value + ('a' - 'A') : value;
+}
+
+#define _IS_ALPHA(V) ((V >= 'a' && V <= 'z') || (V >= 'A' && V <= 'Z'))
+
+// Whether a word starts at the given position of a lower case base name.
+// Words are separated by punctuation and by changes between letters and
+// digits, for example "shot010_comp_v002" has the words "shot", "010",
+// "comp", "v", and "002".
+static inline FSeqBool _fseqIndexWordStart(const char* key, size_t i)
+{
+    const char c = key[i];
+    const char p = i > 0 ? key[i - 1] : 0;
+    if (0 == i)
+    {
+        return FSEQ_TRUE;
+    }
+    if (_IS_ALPHA(c))
+    {
+        return !_IS_ALPHA(p);
+    }
+    if (_IS_NUMBER(c))
+    {
+        return !_IS_NUMBER(p);
+    }
+    return FSEQ_FALSE;
+}
+
+static inline const char* _fseqIndexKeyText(const struct FSeqIndex* index, struct _FSeqIndexKey key)
+{
+    return index->items[key.item].key + key.offset;
+}
+
+// Get the first characters of a key, in an order that compares the same as
+// the text.
+static inline uint32_t _fseqIndexPrefix(const char* value)
+{
+    uint32_t out = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        out <<= 8;
+        if (*value)
+        {
+            out |= (unsigned char)*value++;
+        }
+    }
+    return out;
+}
+
+static inline int _fseqIndexCompare(
+    const struct FSeqIndex* index,
+    struct _FSeqIndexKey    a,
+    struct _FSeqIndexKey    b)
+{
+    if (a.prefix != b.prefix)
+    {
+        return a.prefix < b.prefix ? -1 : 1;
+    }
+    if (a.prefix & 0xff)
+    {
+        const int r = strcmp(_fseqIndexKeyText(index, a) + 4, _fseqIndexKeyText(index, b) + 4);
+        if (r != 0)
+        {
+            return r;
+        }
+    }
+    if (a.item != b.item)
+    {
+        return a.item < b.item ? -1 : 1;
+    }
+    return a.offset < b.offset ? -1 : (a.offset > b.offset ? 1 : 0);
+}
+
+// Merge two sorted arrays of keys.
+static void _fseqIndexMergeKeys(
+    const struct FSeqIndex*     index,
+    const struct _FSeqIndexKey* a,
+    size_t                      aCount,
+    const struct _FSeqIndexKey* b,
+    size_t                      bCount,
+    struct _FSeqIndexKey*       out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    while (i < aCount && j < bCount)
+    {
+        *out++ = _fseqIndexCompare(index, a[i], b[j]) <= 0 ? a[i++] : b[j++];
+    }
+    memcpy(out, a + i, (aCount - i) * sizeof(struct _FSeqIndexKey));
+    memcpy(out + (aCount - i), b + j, (bCount - j) * sizeof(struct _FSeqIndexKey));
+}
+
+// Sort an array of keys, "tmp" must be the same size.
+static void _fseqIndexSort(
+    const struct FSeqIndex* index,
+    struct _FSeqIndexKey*   keys,
+    struct _FSeqIndexKey*   tmp,
+    size_t                  count)
+{
+    if (count <= 16)
+    {
+        for (size_t i = 1; i < count; ++i)
+        {
+            const struct _FSeqIndexKey key = keys[i];
+            size_t j = i;
+            for (; j > 0 && _fseqIndexCompare(index, key, keys[j - 1]) < 0; --j)
+            {
+                keys[j] = keys[j - 1];
+            }
+            keys[j] = key;
+        }
+        return;
+    }
+    const size_t half = count / 2;
+    _fseqIndexSort(index, keys, tmp, half);
+    _fseqIndexSort(index, keys + half, tmp + half, count - half);
+    _fseqIndexMergeKeys(index, keys, half, keys + half, count - half, tmp);
+    memcpy(keys, tmp, count * sizeof(struct _FSeqIndexKey));
+}
+
+// Sort the keys and add them as a new run, merging the smaller runs. The
+// keys are owned by the runs.
+static FSeqBool _fseqIndexRunAdd(
+    const struct FSeqIndex* index,
+    struct _FSeqIndexRuns*  runs,
+    struct _FSeqIndexKey*   keys,
+    size_t                  count)
+{
+    struct _FSeqIndexKey* tmp = (struct _FSeqIndexKey*)malloc(count * sizeof(struct _FSeqIndexKey));
+    if (!tmp)
+    {
+        free(keys);
+        return FSEQ_FALSE;
+    }
+    _fseqIndexSort(index, keys, tmp, count);
+    free(tmp);
+
+    runs->runs[runs->count].keys  = keys;
+    runs->runs[runs->count].count = count;
+    ++runs->count;
+    while (runs->count >= 2 &&
+        (runs->runs[runs->count - 2].count <= runs->runs[runs->count - 1].count * 2 ||
+         _FSEQ_INDEX_MAX_RUNS == runs->count))
+    {
+        struct _FSeqIndexRun* a = &runs->runs[runs->count - 2];
+        struct _FSeqIndexRun* b = &runs->runs[runs->count - 1];
+        struct _FSeqIndexKey* out = (struct _FSeqIndexKey*)malloc(
+            (a->count + b->count) * sizeof(struct _FSeqIndexKey));
+        if (!out)
+        {
+            return FSEQ_FALSE;
+        }
+        _fseqIndexMergeKeys(index, a->keys, a->count, b->keys, b->count, out);
+        free(a->keys);
+        free(b->keys);
+        a->keys   = out;
+        a->count += b->count;
+        --runs->count;
+    }
+    return FSEQ_TRUE;
+}
+
+// Copy a lower case base name into the last block.
+static const char* _fseqIndexKeyAdd(struct FSeqIndex* index, const char* key, size_t len)
+{
+    struct _FSeqIndexBlock* block = index->blockCount ? &index->blocks[index->blockCount - 1] : NULL;
+    char*                   out   = NULL;
+
+    if (!block || block->size + len + 1 > block->capacity)
+    {
+        if (index->blockCount == index->blockCapacity)
+        {
+            const size_t capacity = index->blockCapacity ? index->blockCapacity * 2 : 16;
+            struct _FSeqIndexBlock* blocks = (struct _FSeqIndexBlock*)realloc(
+                index->blocks,
+                capacity * sizeof(struct _FSeqIndexBlock));
+            if (!blocks)
+            {
+                return NULL;
+            }
+            index->blocks        = blocks;
+            index->blockCapacity = capacity;
+        }
+        block = &index->blocks[index->blockCount];
+        block->capacity = FSEQ_MAX((size_t)_FSEQ_INDEX_BLOCK_SIZE, len + 1);
+        block->data     = (char*)malloc(block->capacity);
+        if (!block->data)
+        {
+            return NULL;
+        }
+        block->size      = 0;
+        block->firstItem = index->itemCount;
+        block->itemCount = 0;
+        ++index->blockCount;
+    }
+    out = block->data + block->size;
+    for (size_t i = 0; i < len; ++i)
+    {
+        out[i] = _fseqToLower(key[i]);
+    }
+    out[len] = 0;
+    block->size += len + 1;
+    ++block->itemCount;
+    return out;
+}
+
+FSeqBool fseqIndexAdd(struct FSeqIndex* index, const char* path, struct FSeqDirEntry* list)
+{
+    struct _FSeqIndexDir* dir       = NULL;
+    struct _FSeqIndexKey* names     = NULL;
+    struct _FSeqIndexKey* words     = NULL;
+    size_t                nameCount = 0;
+    size_t                wordCount = 0;
+    size_t                wordMax   = 0;
+    size_t                count     = 0;
+    char                  buf[FSEQ_STRING_LEN];
+
+    // Take ownership of the list.
+    if (index->dirCount == index->dirCapacity)
+    {
+        const size_t capacity = index->dirCapacity ? index->dirCapacity * 2 : 64;
+        struct _FSeqIndexDir* dirs = (struct _FSeqIndexDir*)realloc(
+            index->dirs,
+            capacity * sizeof(struct _FSeqIndexDir));
+        if (!dirs)
+        {
+            fseqDirListDel(list);
+            return FSEQ_FALSE;
+        }
+        index->dirs        = dirs;
+        index->dirCapacity = capacity;
+    }
+    dir = &index->dirs[index->dirCount];
+    dir->path = path ? _fseqStrDup(path, strlen(path)) : NULL;
+    dir->list = list;
+    if (path && !dir->path)
+    {
+        fseqDirListDel(list);
+        return FSEQ_FALSE;
+    }
+    ++index->dirCount;
+
+    for (const struct FSeqDirEntry* entry = list; entry; entry = entry->next)
+    {
+        ++count;
+    }
+    if (0 == count)
+    {
+        return FSEQ_TRUE;
+    }
+    if (index->itemCount + count > UINT32_MAX)
+    {
+        return FSEQ_FALSE;
+    }
+    if (index->itemCount + count > index->itemCapacity)
+    {
+        const size_t capacity = FSEQ_MAX(index->itemCapacity * 2, index->itemCount + count);
+        struct _FSeqIndexItem* items = (struct _FSeqIndexItem*)realloc(
+            index->items,
+            capacity * sizeof(struct _FSeqIndexItem));
+        if (!items)
+        {
+            return FSEQ_FALSE;
+        }
+        index->items        = items;
+        index->itemCapacity = capacity;
+    }
+    names = (struct _FSeqIndexKey*)malloc(count * sizeof(struct _FSeqIndexKey));
+    if (!names)
+    {
+        return FSEQ_FALSE;
+    }
+
+    // Add the items, the keys are the base names.
+    for (const struct FSeqDirEntry* entry = list; entry; entry = entry->next)
+    {
+        struct _FSeqIndexItem*   item = &index->items[index->itemCount];
+        const char*              name = NULL;
+        struct FSeqFileNameSizes sizes;
+        const char*              base = NULL;
+        size_t                   len  = 0;
+
+        if (!_fseqDirEntryName(entry, buf, &name, &sizes))
+        {
+            continue;
+        }
+        base = name + sizes.path;
+        len  = sizes.base;
+        if (0 == len)
+        {
+            len = strlen(base);
+        }
+        item->key = _fseqIndexKeyAdd(index, base, len);
+        if (!item->key)
+        {
+            free(names);
+            free(words);
+            return FSEQ_FALSE;
+        }
+        item->keyLen       = (uint32_t)len;
+        item->extension    = entry->name ?
+            entry->name + sizes.path + sizes.base + sizes.number :
+            (entry->fileName.extension ? entry->fileName.extension : "");
+        item->extensionLen = sizes.extension;
+        item->path         = dir->path;
+        item->entry        = entry;
+
+        names[nameCount].prefix = _fseqIndexPrefix(item->key);
+        names[nameCount].item   = (uint32_t)index->itemCount;
+        names[nameCount].offset = 0;
+        ++nameCount;
+
+        // The words after the first are kept in a separate set of runs.
+        for (size_t i = 1; i < len; ++i)
+        {
+            if (!_fseqIndexWordStart(item->key, i))
+            {
+                continue;
+            }
+            if (wordCount == wordMax)
+            {
+                struct _FSeqIndexKey* tmp = NULL;
+                wordMax = wordMax ? wordMax * 2 : count * 4;
+                tmp = (struct _FSeqIndexKey*)realloc(words, wordMax * sizeof(struct _FSeqIndexKey));
+                if (!tmp)
+                {
+                    free(names);
+                    free(words);
+                    return FSEQ_FALSE;
+                }
+                words = tmp;
+            }
+            words[wordCount].prefix = _fseqIndexPrefix(item->key + i);
+            words[wordCount].item   = (uint32_t)index->itemCount;
+            words[wordCount].offset = (uint32_t)i;
+            ++wordCount;
+        }
+        ++index->itemCount;
+    }
+
+    if (nameCount > 0)
+    {
+        if (!_fseqIndexRunAdd(index, &index->names, names, nameCount))
+        {
+            free(words);
+            return FSEQ_FALSE;
+        }
+    }
+    else
+    {
+        free(names);
+    }
+    if (wordCount > 0)
+    {
+        return _fseqIndexRunAdd(index, &index->words, words, wordCount);
+    }
+    free(words);
+    return FSEQ_TRUE;
+}
+
+// Check whether an item matches the extension filter, a comma separated
+// list of extensions with or without the leading period.
+static FSeqBool _fseqIndexExtension(const struct _FSeqIndexItem* item, const char* extensions)
+{
+    const char* ext    = item->extension;
+    size_t      extLen = item->extensionLen;
+
+    if (!extensions || !extensions[0])
+    {
+        return FSEQ_TRUE;
+    }
+    if (extLen > 0 && '.' == ext[0])
+    {
+        ++ext;
+        --extLen;
+    }
+    for (const char* p = extensions; *p;)
+    {
+        const char* end = strchr(p, ',');
+        size_t      len = 0;
+        if (!end)
+        {
+            end = p + strlen(p);
+        }
+        if ('.' == *p)
+        {
+            ++p;
+        }
+        len = end - p;
+        if (len == extLen)
+        {
+            size_t i = 0;
+            for (; i < len && _fseqToLower(p[i]) == _fseqToLower(ext[i]); ++i)
+                ;
+            if (i == len)
+            {
+                return FSEQ_TRUE;
+            }
+        }
+        p = *end ? end + 1 : end;
+    }
+    return FSEQ_FALSE;
+}
+
+// Find the first key in a run that does not sort before the prefix, or
+// with "upper" the first key after the keys starting with the prefix.
+static size_t _fseqIndexBound(
+    const struct FSeqIndex*     index,
+    const struct _FSeqIndexRun* run,
+    const char*                 prefix,
+    size_t                      len,
+    FSeqBool                    upper)
+{
+    size_t lo = 0;
+    size_t hi = run->count;
+    while (lo < hi)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        const int    r   = strncmp(_fseqIndexKeyText(index, run->keys[mid]), prefix, len);
+        if (r < 0 || (upper && 0 == r))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Whether an earlier word of the item also starts with the prefix, so the
+// item is only returned once.
+static FSeqBool _fseqIndexEarlierWord(const char* key, size_t offset, const char* prefix, size_t len)
+{
+    for (size_t i = 0; i < offset; ++i)
+    {
+        if (_fseqIndexWordStart(key, i) && 0 == strncmp(key + i, prefix, len))
+        {
+            return FSEQ_TRUE;
+        }
+    }
+    return FSEQ_FALSE;
+}
+
+static size_t _fseqIndexFindSubstring(
+    const struct FSeqIndex*      index,
+    const struct FSeqIndexQuery* query,
+    const char*                  text,
+    size_t                       len,
+    struct FSeqIndexResult*      out,
+    size_t                       max)
+{
+    size_t count = 0;
+    for (size_t b = 0; b < index->blockCount && count < max; ++b)
+    {
+        const struct _FSeqIndexBlock* block = &index->blocks[b];
+        const char*                   p     = block->data;
+        const char* const             end   = block->data + block->size;
+        size_t                        lo    = block->firstItem;
+        while (count < max)
+        {
+            const char* match = (const char*)_fseqMemmem(p, end - p, text, len);
+            if (!match)
+            {
+                break;
+            }
+
+            // Find the base name containing the match.
+            size_t hi = block->firstItem + block->itemCount;
+            while (hi - lo > 1)
+            {
+                const size_t mid = lo + (hi - lo) / 2;
+                if (index->items[mid].key <= match)
+                {
+                    lo = mid;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            const struct _FSeqIndexItem* item = &index->items[lo];
+            if (_fseqIndexExtension(item, query->extensions))
+            {
+                out[count].path  = item->path;
+                out[count].entry = item->entry;
+                ++count;
+            }
+            p = item->key + item->keyLen + 1;
+            ++lo;
+        }
+    }
+    return count;
+}
+
+size_t fseqIndexFind(
+    const struct FSeqIndex*      index,
+    const struct FSeqIndexQuery* query,
+    struct FSeqIndexResult*      out,
+    size_t                       max)
+{
+    const struct _FSeqIndexRun* runs[_FSEQ_INDEX_MAX_RUNS * 2];
+    size_t                      begin[_FSEQ_INDEX_MAX_RUNS * 2];
+    size_t                      end[_FSEQ_INDEX_MAX_RUNS * 2];
+    size_t                      runCount = 0;
+    char                        text[FSEQ_STRING_LEN];
+    size_t                      len      = 0;
+    size_t                      count    = 0;
+
+    // The base names are compared in lower case.
+    if (query->text)
+    {
+        for (; query->text[len] && len < FSEQ_STRING_LEN - 1; ++len)
+        {
+            text[len] = _fseqToLower(query->text[len]);
+        }
+    }
+    text[len] = 0;
+
+    if (FSEQ_INDEX_MATCH_SUBSTRING == query->match && len > 0)
+    {
+        return _fseqIndexFindSubstring(index, query, text, len, out, max);
+    }
+
+    // Find the matching range of each run.
+    for (size_t i = 0; i < index->names.count; ++i)
+    {
+        runs[runCount++] = &index->names.runs[i];
+    }
+    if (FSEQ_INDEX_MATCH_PREFIX != query->match && len > 0)
+    {
+        for (size_t i = 0; i < index->words.count; ++i)
+        {
+            runs[runCount++] = &index->words.runs[i];
+        }
+    }
+    for (size_t r = 0; r < runCount; ++r)
+    {
+        begin[r] = _fseqIndexBound(index, runs[r], text, len, FSEQ_FALSE);
+        end[r]   = len > 0 ? _fseqIndexBound(index, runs[r], text, len, FSEQ_TRUE) : runs[r]->count;
+    }
+
+    // Merge the ranges, so the results are sorted.
+    while (count < max)
+    {
+        struct _FSeqIndexKey min;
+        size_t               minRun = runCount;
+        for (size_t r = 0; r < runCount; ++r)
+        {
+            if (begin[r] < end[r] &&
+                (minRun == runCount || _fseqIndexCompare(index, runs[r]->keys[begin[r]], min) < 0))
+            {
+                min    = runs[r]->keys[begin[r]];
+                minRun = r;
+            }
+        }
+        if (minRun == runCount)
+        {
+            break;
+        }
+        ++begin[minRun];
+
+        const struct _FSeqIndexItem* item = &index->items[min.item];
+        if ((0 == min.offset || !_fseqIndexEarlierWord(item->key, min.offset, text, len)) &&
+            _fseqIndexExtension(item, query->extensions))
+        {
+            out[count].path  = item->path;
+            out[count].entry = item->entry;
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Copy the name, frame range, and frames of a directory entry. The copy
+// stores the original file name rather than the components.
+static FSeqBool _fseqDirEntryCopy(const struct FSeqDirEntry* value, struct FSeqDirEntry* out)
+{
+    const char*              name = NULL;
+    struct FSeqFileNameSizes sizes;
+    char                     buf[FSEQ_STRING_LEN];
+
+    fseqDirEntryInit(out);
+    if (!_fseqDirEntryName(value, buf, &name, &sizes))
+    {
+        return FSEQ_FALSE;
+    }
+    out->name = _fseqStrDup(name, strlen(name));
+    if (!out->name || !fseqFrameSetCopy(&value->frames, &out->frames))
+    {
+        fseqDirEntryDel(out);
+        return FSEQ_FALSE;
+    }
+    out->sizes        = sizes;
+    out->type         = value->type;
+    out->frameMin     = value->frameMin;
+    out->frameMax     = value->frameMax;
+    out->framePadding = value->framePadding;
+    out->frameCount   = value->frameCount;
+    return FSEQ_TRUE;
+}
+
+// Whether a frame of a directory entry exists, according to the recorded
+// frames if available, otherwise the frame range.
+static inline FSeqBool _fseqDirEntryHasFrame(const struct FSeqDirEntry* entry, int64_t frame)
+{
+    if (frame < entry->frameMin || frame > entry->frameMax)
+    {
+        return FSEQ_FALSE;
+    }
+    return entry->frames.wordCount ? fseqFrameSetContains(&entry->frames, frame) : FSEQ_TRUE;
+}
+
+void fseqPrefetchOptionsInit(struct FSeqPrefetchOptions* value)
+{
+    value->window    = 8;
+    value->maxWindow = 240;
+    value->lead      = 1000;
+}
+
+void fseqPrefetchStatsInit(struct FSeqPrefetchStats* value)
+{
+    value->frames = 0;
+    value->failed = 0;
+    value->seeks  = 0;
+    value->window = 0;
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+struct FSeqPrefetch* fseqPrefetchCreate(
+    const char*                        path,
+    const struct FSeqDirEntry*         entry,
+    const struct FSeqPrefetchOptions*  options,
+    FSeqBool*                          error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+void fseqPrefetchDel(struct FSeqPrefetch* value)
+{}
+
+void fseqPrefetchUpdate(struct FSeqPrefetch* value, int64_t frame, int direction)
+{}
+
+void fseqPrefetchStats(const struct FSeqPrefetch* value, struct FSeqPrefetchStats* out)
+{
+    fseqPrefetchStatsInit(out);
+}
+
+#else // WIN32
+
+struct FSeqPrefetch
+{
+    pthread_mutex_t            mutex;
+    pthread_cond_t             cond;
+    pthread_t                  thread;
+    FSeqBool                   started;
+    FSeqBool                   stop;
+    char*                      path;
+    struct FSeqDirEntry        entry;
+    struct FSeqPrefetchOptions options;
+
+    // The playhead. The step is the signed number of frames between
+    // updates, so playback that skips frames only prefetches the frames
+    // that are shown. A new step is pending until it repeats, so a single
+    // skipped or repeated frame does not change the stride.
+    FSeqBool                   playing;
+    int64_t                    frame;
+    int64_t                    step;
+    int64_t                    pending;
+    int64_t                    time;
+    double                     rate;
+
+    // The next frame to prefetch.
+    int64_t                    next;
+
+    struct FSeqPrefetchStats   stats;
+};
+
+// Ask the operating system to read a file into the page cache without
+// waiting for it.
+static FSeqBool _fseqPrefetchFile(const char* fileName)
+{
+    const int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (-1 == fd)
+    {
+        return FSEQ_FALSE;
+    }
+#if defined(__APPLE__)
+    {
+        struct stat     st;
+        struct radvisory ra;
+        if (0 == fstat(fd, &st))
+        {
+            ra.ra_offset = 0;
+            ra.ra_count  = (int)FSEQ_MIN(st.st_size, (off_t)INT_MAX);
+            fcntl(fd, F_RDADVISE, &ra);
+        }
+    }
+#elif defined(POSIX_FADV_WILLNEED)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif // __APPLE__
+    close(fd);
+    return FSEQ_TRUE;
+}
+
+static void* _fseqPrefetchThread(void* data)
+{
+    struct FSeqPrefetch* prefetch = (struct FSeqPrefetch*)data;
+    char                 fileName[FSEQ_STRING_LEN];
+
+    pthread_mutex_lock(&prefetch->mutex);
+    while (!prefetch->stop)
+    {
+        int64_t  frame = 0;
+        FSeqBool found = FSEQ_FALSE;
+
+        // Find the next frame in the window ahead of the playhead.
+        if (prefetch->playing)
+        {
+            const int64_t step  = prefetch->step;
+            const int64_t ahead = prefetch->stats.window;
+            if ((prefetch->next - prefetch->frame) / step <= 0)
+            {
+                prefetch->next = prefetch->frame + step;
+            }
+            while ((prefetch->next - prefetch->frame) / step <= ahead &&
+                prefetch->next >= prefetch->entry.frameMin &&
+                prefetch->next <= prefetch->entry.frameMax)
+            {
+                frame = prefetch->next;
+                prefetch->next += step;
+                if (_fseqDirEntryHasFrame(&prefetch->entry, frame))
+                {
+                    found = FSEQ_TRUE;
+                    break;
+                }
+            }
+        }
+        if (!found)
+        {
+            pthread_cond_wait(&prefetch->cond, &prefetch->mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock(&prefetch->mutex);
+        const FSeqBool result =
+            _fseqFrameFileName(prefetch->path, &prefetch->entry, frame, fileName, FSEQ_STRING_LEN) &&
+            _fseqPrefetchFile(fileName);
+        pthread_mutex_lock(&prefetch->mutex);
+        if (result)
+        {
+            ++prefetch->stats.frames;
+        }
+        else
+        {
+            ++prefetch->stats.failed;
+        }
+    }
+    pthread_mutex_unlock(&prefetch->mutex);
+    return NULL;
+}
+
+struct FSeqPrefetch* fseqPrefetchCreate(
+    const char*                        path,
+    const struct FSeqDirEntry*         entry,
+    const struct FSeqPrefetchOptions*  options,
+    FSeqBool*                          error)
+{
+    struct FSeqPrefetch* out = (struct FSeqPrefetch*)calloc(1, sizeof(struct FSeqPrefetch));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    pthread_mutex_init(&out->mutex, NULL);
+    pthread_cond_init(&out->cond, NULL);
+    fseqDirEntryInit(&out->entry);
+    if (options)
+    {
+        out->options = *options;
+    }
+    else
+    {
+        fseqPrefetchOptionsInit(&out->options);
+    }
+    out->options.window    = FSEQ_MAX(out->options.window, (int64_t)1);
+    out->options.maxWindow = FSEQ_MAX(out->options.maxWindow, out->options.window);
+    fseqPrefetchStatsInit(&out->stats);
+    out->stats.window = out->options.window;
+    out->step         = 1;
+
+    if ((path && !(out->path = _fseqStrDup(path, strlen(path)))) ||
+        !_fseqDirEntryCopy(entry, &out->entry))
+    {
+        fseqPrefetchDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    out->started = 0 == pthread_create(&out->thread, NULL, _fseqPrefetchThread, out);
+    if (!out->started)
+    {
+        fseqPrefetchDel(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    return out;
+}
+
+void fseqPrefetchDel(struct FSeqPrefetch* value)
+{
+    if (!value)
+    {
+        return;
+    }
+    if (value->started)
+    {
+        pthread_mutex_lock(&value->mutex);
+        value->stop = FSEQ_TRUE;
+        pthread_cond_signal(&value->cond);
+        pthread_mutex_unlock(&value->mutex);
+        pthread_join(value->thread, NULL);
+    }
+    pthread_mutex_destroy(&value->mutex);
+    pthread_cond_destroy(&value->cond);
+    fseqDirEntryDel(&value->entry);
+    free(value->path);
+    free(value);
+}
+
+void fseqPrefetchUpdate(struct FSeqPrefetch* value, int64_t frame, int direction)
+{
+    const int64_t now = _fseqTime();
+
+    pthread_mutex_lock(&value->mutex);
+    const int64_t delta  = frame - value->frame;
+    const int64_t stride = FSEQ_MAX(value->step, -value->step);
+    if (value->playing &&
+        delta != 0 &&
+        (delta > 0) == (direction >= 0) &&
+        FSEQ_MAX(delta, -delta) <= FSEQ_MAX(stride * 4, (int64_t)4))
+    {
+        // Continued playback, follow the stride once it repeats and measure
+        // the rate of updates.
+        const int64_t elapsed = now - value->time;
+        if (delta == value->step)
+        {
+            value->pending = 0;
+        }
+        else if (delta == value->pending)
+        {
+            // The frames queued with the old stride are no longer needed.
+            value->step    = delta;
+            value->next    = frame + delta;
+            value->pending = 0;
+        }
+        else
+        {
+            value->pending = delta;
+        }
+        if (elapsed > 0)
+        {
+            const double rate = 1000.0 / (double)elapsed;
+            value->rate = value->rate > 0.0 ? value->rate * 0.75 + rate * 0.25 : rate;
+        }
+    }
+    else if (!value->playing || delta != 0 || (value->step > 0) != (direction >= 0))
+    {
+        // A seek or a change of direction, the frames that were queued
+        // are no longer needed.
+        value->step    = direction >= 0 ? 1 : -1;
+        value->pending = 0;
+        value->next    = frame;
+        value->rate    = 0.0;
+        if (value->playing)
+        {
+            ++value->stats.seeks;
+        }
+    }
+    value->playing = FSEQ_TRUE;
+    value->frame   = frame;
+    value->time    = now;
+
+    // Prefetch enough frames to cover the lead time at the current rate.
+    value->stats.window = FSEQ_MIN(
+        FSEQ_MAX((int64_t)(value->rate * (double)value->options.lead / 1000.0), value->options.window),
+        value->options.maxWindow);
+
+    pthread_cond_signal(&value->cond);
+    pthread_mutex_unlock(&value->mutex);
+}
+
+void fseqPrefetchStats(const struct FSeqPrefetch* value, struct FSeqPrefetchStats* out)
+{
+    pthread_mutex_lock((pthread_mutex_t*)&value->mutex);
+    *out = value->stats;
+    pthread_mutex_unlock((pthread_mutex_t*)&value->mutex);
+}
+
+#endif // WIN32
+
+void fseqCacheOptionsInit(struct FSeqCacheOptions* value)
+{
+    value->maxBytes = (size_t)1024 * 1024 * 1024;
+    value->shards   = 16;
+    value->map      = FSEQ_TRUE;
+}
+
+void fseqCacheStatsInit(struct FSeqCacheStats* value)
+{
+    value->hits      = 0;
+    value->misses    = 0;
+    value->evictions = 0;
+    value->bytes     = 0;
+    value->frames    = 0;
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+struct FSeqCache* fseqCacheCreate(const struct FSeqCacheOptions* options, FSeqBool* error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+void fseqCacheDel(struct FSeqCache* value)
+{}
+
+struct FSeqCacheSequence* fseqCacheAddSequence(
+    struct FSeqCache*          cache,
+    const char*                path,
+    const struct FSeqDirEntry* entry,
+    FSeqBool*                  error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+const struct FSeqCacheFrame* fseqCacheGet(
+    struct FSeqCache*                cache,
+    const struct FSeqCacheSequence*  sequence,
+    int64_t                          frame,
+    FSeqBool*                        error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+void fseqCacheRelease(struct FSeqCache* cache, const struct FSeqCacheFrame* frame)
+{}
+
+void fseqCacheStats(struct FSeqCache* cache, struct FSeqCacheStats* out)
+{
+    fseqCacheStatsInit(out);
+}
+
+#else // WIN32
+
+struct FSeqCacheSequence
+{
+    char*                     path;
+    struct FSeqDirEntry       entry;
+    struct FSeqCacheSequence* next;
+};
+
+// This struct provides a cached frame. The public struct is the first
+// member so the entries can be returned directly.
+struct _FSeqCacheEntry
+{
+    struct FSeqCacheFrame           frame;
+    const struct FSeqCacheSequence* sequence;
+    int64_t                         number;
+    uint64_t                        hash;
+    uint64_t                        used;
+    size_t                          refs;
+    FSeqBool                        mapped;
+    FSeqBool                        cached;
+    struct _FSeqCacheShard*         shard;
+    struct _FSeqCacheEntry*         prev;
+    struct _FSeqCacheEntry*         next;
+    struct _FSeqCacheEntry*         bucketNext;
+};
+
+// This struct provides a shard of the cache, with its own lock, hash
+// table, and least recently used list.
+struct _FSeqCacheShard
+{
+    pthread_mutex_t          mutex;
+    struct _FSeqCacheEntry** buckets;
+    size_t                   bucketCount;
+    size_t                   count;
+    struct _FSeqCacheEntry*  first;
+    struct _FSeqCacheEntry*  last;
+    int64_t                  hits;
+    int64_t                  misses;
+    int64_t                  evictions;
+};
+
+struct FSeqCache
+{
+    struct FSeqCacheOptions   options;
+    struct _FSeqCacheShard*   shards;
+    size_t                    shardCount;
+    atomic_size_t             bytes;
+    atomic_uint_fast64_t      clock;
+    pthread_mutex_t           mutex;
+    struct FSeqCacheSequence* sequences;
+};
+
+static uint64_t _fseqCacheHash(const struct FSeqCacheSequence* sequence, int64_t frame)
+{
+    uint64_t h = (uint64_t)(uintptr_t)sequence * 0x9e3779b97f4a7c15ull ^ (uint64_t)frame;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+static void _fseqCacheEntryFree(struct _FSeqCacheEntry* entry)
+{
+    if (entry->mapped)
+    {
+        munmap((void*)entry->frame.data, entry->frame.size);
+    }
+    else
+    {
+        free((void*)entry->frame.data);
+    }
+    free(entry);
+}
+
+// Remove an entry from the hash table and list of a shard. The shard must
+// be locked.
+static void _fseqCacheUnlink(struct FSeqCache* cache, struct _FSeqCacheShard* shard, struct _FSeqCacheEntry* entry)
+{
+    struct _FSeqCacheEntry** bucket = &shard->buckets[entry->hash & (shard->bucketCount - 1)];
+    for (; *bucket != entry; bucket = &(*bucket)->bucketNext)
+        ;
+    *bucket = entry->bucketNext;
+    if (entry->prev)
+    {
+        entry->prev->next = entry->next;
+    }
+    else
+    {
+        shard->first = entry->next;
+    }
+    if (entry->next)
+    {
+        entry->next->prev = entry->prev;
+    }
+    else
+    {
+        shard->last = entry->prev;
+    }
+    entry->prev = entry->next = entry->bucketNext = NULL;
+    entry->cached = FSEQ_FALSE;
+    --shard->count;
+    atomic_fetch_sub(&cache->bytes, entry->frame.size);
+}
+
+// Add an entry to a shard, growing the hash table when it is full. The
+// shard must be locked.
+static FSeqBool _fseqCacheLink(struct FSeqCache* cache, struct _FSeqCacheShard* shard, struct _FSeqCacheEntry* entry)
+{
+    struct _FSeqCacheEntry** bucket = NULL;
+    if (shard->count >= shard->bucketCount)
+    {
+        const size_t             bucketCount = shard->bucketCount ? shard->bucketCount * 2 : 64;
+        struct _FSeqCacheEntry** buckets     = (struct _FSeqCacheEntry**)calloc(
+            bucketCount,
+            sizeof(struct _FSeqCacheEntry*));
+        if (!buckets)
+        {
+            return FSEQ_FALSE;
+        }
+        for (size_t i = 0; i < shard->bucketCount; ++i)
+        {
+            struct _FSeqCacheEntry* tmp = shard->buckets[i];
+            while (tmp)
+            {
+                struct _FSeqCacheEntry* next = tmp->bucketNext;
+                struct _FSeqCacheEntry** b = &buckets[tmp->hash & (bucketCount - 1)];
+                tmp->bucketNext = *b;
+                *b = tmp;
+                tmp = next;
+            }
+        }
+        free(shard->buckets);
+        shard->buckets     = buckets;
+        shard->bucketCount = bucketCount;
+    }
+    bucket = &shard->buckets[entry->hash & (shard->bucketCount - 1)];
+    entry->bucketNext = *bucket;
+    *bucket = entry;
+    entry->prev = NULL;
+    entry->next = shard->first;
+    if (shard->first)
+    {
+        shard->first->prev = entry;
+    }
+    else
+    {
+        shard->last = entry;
+    }
+    shard->first  = entry;
+    entry->shard  = shard;
+    entry->used   = atomic_fetch_add(&cache->clock, 1);
+    entry->cached = FSEQ_TRUE;
+    ++shard->count;
+    atomic_fetch_add(&cache->bytes, entry->frame.size);
+    return FSEQ_TRUE;
+}
+
+// Remove the least recently used frames until the cache is within its
+// budget. Each shard has its own list ordered by use, so the oldest frame
+// in the cache is the oldest of the last frames of the shards. Only one
+// shard is locked at a time, so a frame used while the shards are compared
+// may still be removed.
+static void _fseqCacheTrim(struct FSeqCache* cache)
+{
+    while (atomic_load(&cache->bytes) > cache->options.maxBytes)
+    {
+        struct _FSeqCacheShard* shard = NULL;
+        struct _FSeqCacheEntry* entry = NULL;
+        uint64_t                used  = 0;
+        for (size_t i = 0; i < cache->shardCount; ++i)
+        {
+            struct _FSeqCacheShard* tmp = &cache->shards[i];
+            pthread_mutex_lock(&tmp->mutex);
+            if (tmp->last && (!shard || tmp->last->used < used))
+            {
+                shard = tmp;
+                used  = tmp->last->used;
+            }
+            pthread_mutex_unlock(&tmp->mutex);
+        }
+        if (!shard)
+        {
+            break;
+        }
+        pthread_mutex_lock(&shard->mutex);
+        entry = shard->last;
+        if (entry)
+        {
+            _fseqCacheUnlink(cache, shard, entry);
+            ++shard->evictions;
+            if (0 == entry->refs)
+            {
+                _fseqCacheEntryFree(entry);
+            }
+        }
+        pthread_mutex_unlock(&shard->mutex);
+    }
+}
+
+// Read a frame file, either by mapping it or reading it into memory.
+static struct _FSeqCacheEntry* _fseqCacheLoad(const char* fileName, FSeqBool map)
+{
+    struct _FSeqCacheEntry* out = NULL;
+    struct stat             st;
+    const int               fd  = open(fileName, O_RDONLY | O_CLOEXEC);
+
+    if (-1 == fd)
+    {
+        return NULL;
+    }
+    out = (struct _FSeqCacheEntry*)calloc(1, sizeof(struct _FSeqCacheEntry));
+    if (!out || fstat(fd, &st) != 0)
+    {
+        free(out);
+        close(fd);
+        return NULL;
+    }
+    out->frame.size = (size_t)st.st_size;
+    if (out->frame.size > 0 && map)
+    {
+        void* data = mmap(NULL, out->frame.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == data)
+        {
+            free(out);
+            close(fd);
+            return NULL;
+        }
+        out->frame.data = data;
+        out->mapped     = FSEQ_TRUE;
+    }
+    else if (out->frame.size > 0)
+    {
+        unsigned char* data = (unsigned char*)malloc(out->frame.size);
+        size_t         size = 0;
+        while (data && size < out->frame.size)
+        {
+            const ssize_t count = read(fd, data + size, out->frame.size - size);
+            if (count < 0 && EINTR == errno)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                break;
+            }
+            size += (size_t)count;
+        }
+        if (!data || size < out->frame.size)
+        {
+            free(data);
+            free(out);
+            close(fd);
+            return NULL;
+        }
+        out->frame.data = data;
+    }
+    close(fd);
+    return out;
+}
+
+struct FSeqCache* fseqCacheCreate(const struct FSeqCacheOptions* options, FSeqBool* error)
+{
+    struct FSeqCache* out = (struct FSeqCache*)calloc(1, sizeof(struct FSeqCache));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    if (options)
+    {
+        out->options = *options;
+    }
+    else
+    {
+        fseqCacheOptionsInit(&out->options);
+    }
+    atomic_init(&out->bytes, 0);
+    atomic_init(&out->clock, 0);
+    pthread_mutex_init(&out->mutex, NULL);
+    out->shardCount = FSEQ_MAX(out->options.shards, (size_t)1);
+    out->shards = (struct _FSeqCacheShard*)calloc(out->shardCount, sizeof(struct _FSeqCacheShard));
+    if (!out->shards)
+    {
+        pthread_mutex_destroy(&out->mutex);
+        free(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    for (size_t i = 0; i < out->shardCount; ++i)
+    {
+        pthread_mutex_init(&out->shards[i].mutex, NULL);
+    }
+    return out;
+}
+
+void fseqCacheDel(struct FSeqCache* value)
+{
+    if (!value)
+    {
+        return;
+    }
+    for (size_t i = 0; i < value->shardCount; ++i)
+    {
+        struct _FSeqCacheShard* shard = &value->shards[i];
+        struct _FSeqCacheEntry* entry = shard->first;
+        while (entry)
+        {
+            struct _FSeqCacheEntry* next = entry->next;
+            _fseqCacheEntryFree(entry);
+            entry = next;
+        }
+        free(shard->buckets);
+        pthread_mutex_destroy(&shard->mutex);
+    }
+    while (value->sequences)
+    {
+        struct FSeqCacheSequence* next = value->sequences->next;
+        free(value->sequences->path);
+        fseqDirEntryDel(&value->sequences->entry);
+        free(value->sequences);
+        value->sequences = next;
+    }
+    pthread_mutex_destroy(&value->mutex);
+    free(value->shards);
+    free(value);
+}
+
+struct FSeqCacheSequence* fseqCacheAddSequence(
+    struct FSeqCache*          cache,
+    const char*                path,
+    const struct FSeqDirEntry* entry,
+    FSeqBool*                  error)
+{
+    struct FSeqCacheSequence* out = (struct FSeqCacheSequence*)calloc(1, sizeof(struct FSeqCacheSequence));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    if ((path && !(out->path = _fseqStrDup(path, strlen(path)))) ||
+        !_fseqDirEntryCopy(entry, &out->entry))
+    {
+        free(out->path);
+        free(out);
+        _fseqSetError(error);
+        return NULL;
+    }
+    pthread_mutex_lock(&cache->mutex);
+    out->next = cache->sequences;
+    cache->sequences = out;
+    pthread_mutex_unlock(&cache->mutex);
+    return out;
+}
+
+const struct FSeqCacheFrame* fseqCacheGet(
+    struct FSeqCache*                cache,
+    const struct FSeqCacheSequence*  sequence,
+    int64_t                          frame,
+    FSeqBool*                        error)
+{
+    const uint64_t          hash       = _fseqCacheHash(sequence, frame);
+    const size_t            shardIndex = (size_t)(hash >> 32) % cache->shardCount;
+    struct _FSeqCacheShard* shard      = &cache->shards[shardIndex];
+    struct _FSeqCacheEntry* entry      = NULL;
+    struct _FSeqCacheEntry* loaded     = NULL;
+    char                    fileName[FSEQ_STRING_LEN];
+
+    // Look for the frame in the cache. The file name is only created when
+    // the frame needs to be read.
+    pthread_mutex_lock(&shard->mutex);
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        entry = shard->bucketCount ? shard->buckets[hash & (shard->bucketCount - 1)] : NULL;
+        for (; entry; entry = entry->bucketNext)
+        {
+            if (hash == entry->hash && sequence == entry->sequence && frame == entry->number)
+            {
+                break;
+            }
+        }
+        if (entry)
+        {
+            // Move the frame to the front of the list.
+            entry->used = atomic_fetch_add(&cache->clock, 1);
+            if (entry->prev)
+            {
+                entry->prev->next = entry->next;
+                if (entry->next)
+                {
+                    entry->next->prev = entry->prev;
+                }
+                else
+                {
+                    shard->last = entry->prev;
+                }
+                entry->prev = NULL;
+                entry->next = shard->first;
+                shard->first->prev = entry;
+                shard->first = entry;
+            }
+            ++entry->refs;
+            if (0 == pass)
+            {
+                ++shard->hits;
+            }
+            pthread_mutex_unlock(&shard->mutex);
+            if (loaded)
+            {
+                // Another thread read the frame at the same time.
+                _fseqCacheEntryFree(loaded);
+            }
+            return &entry->frame;
+        }
+        if (1 == pass)
+        {
+            break;
+        }
+        ++shard->misses;
+        pthread_mutex_unlock(&shard->mutex);
+
+        // Read the frame without holding the lock.
+        if (!_fseqDirEntryHasFrame(&sequence->entry, frame) ||
+            !_fseqFrameFileName(sequence->path, &sequence->entry, frame, fileName, FSEQ_STRING_LEN) ||
+            !(loaded = _fseqCacheLoad(fileName, cache->options.map)))
+        {
+            _fseqSetError(error);
+            return NULL;
+        }
+        loaded->sequence = sequence;
+        loaded->number   = frame;
+        loaded->hash     = hash;
+        loaded->refs     = 1;
+        pthread_mutex_lock(&shard->mutex);
+    }
+
+    // Add the frame. Frames larger than the cache are returned without
+    // being cached, and freed when they are released.
+    if (loaded->frame.size <= cache->options.maxBytes && !_fseqCacheLink(cache, shard, loaded))
+    {
+        pthread_mutex_unlock(&shard->mutex);
+        _fseqCacheEntryFree(loaded);
+        _fseqSetError(error);
+        return NULL;
+    }
+    loaded->shard = shard;
+    pthread_mutex_unlock(&shard->mutex);
+    _fseqCacheTrim(cache);
+    return &loaded->frame;
+}
+
+void fseqCacheRelease(struct FSeqCache* cache, const struct FSeqCacheFrame* frame)
+{
+    struct _FSeqCacheEntry* entry = (struct _FSeqCacheEntry*)frame;
+    struct _FSeqCacheShard* shard = NULL;
+    FSeqBool                del   = FSEQ_FALSE;
+
+    (void)cache;
+    if (!entry)
+    {
+        return;
+    }
+    shard = entry->shard;
+    pthread_mutex_lock(&shard->mutex);
+    del = 0 == --entry->refs && !entry->cached;
+    pthread_mutex_unlock(&shard->mutex);
+    if (del)
+    {
+        _fseqCacheEntryFree(entry);
+    }
+}
+
+void fseqCacheStats(struct FSeqCache* cache, struct FSeqCacheStats* out)
+{
+    fseqCacheStatsInit(out);
+    for (size_t i = 0; i < cache->shardCount; ++i)
+    {
+        struct _FSeqCacheShard* shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        out->hits      += shard->hits;
+        out->misses    += shard->misses;
+        out->evictions += shard->evictions;
+        out->frames    += shard->count;
+        pthread_mutex_unlock(&shard->mutex);
+    }
+    out->bytes = atomic_load(&cache->bytes);
+}
+
+#endif // WIN32
+
+#if defined(WIN32) || defined(_WIN32)
+
+struct FSeqListing* fseqListingCreate(FSeqBool* error)
+{
+    _fseqSetError(error);
+    return NULL;
+}
+
+void fseqListingDel(struct FSeqListing* value)
+{}
+
+void fseqListingPublish(
+    struct FSeqListing*  listing,
+    struct FSeqDirEntry* list,
+    FSeqBool*            error)
+{
+    fseqDirListDel(list);
+    _fseqSetError(error);
+}
+
+void fseqListingRefresh(
+    struct FSeqListing*          listing,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    _fseqSetError(error);
+}
+
+const struct FSeqSnapshot* fseqSnapshotAcquire(struct FSeqListing* listing)
+{
+    return NULL;
+}
+
+void fseqSnapshotRelease(const struct FSeqSnapshot* snapshot)
+{}
+
+#else // WIN32
+
+// Builds with FSEQ_SNAPSHOT_TEST call a function provided by the test
+// between the steps of acquiring and publishing snapshots, so the test can
+// interleave the threads at every step.
+#if defined(FSEQ_SNAPSHOT_TEST)
+void fseqSnapshotTestStep(int step);
+#define _FSEQ_SNAPSHOT_STEP(step) fseqSnapshotTestStep(step)
+#else // FSEQ_SNAPSHOT_TEST
+#define _FSEQ_SNAPSHOT_STEP(step)
+#endif // FSEQ_SNAPSHOT_TEST
+
+// This struct provides a published snapshot. The public struct is the first
+// member so the snapshots can be returned directly. The publisher holds one
+// reference to the current snapshot, and each reader holds another.
+struct _FSeqSnapshot
+{
+    struct FSeqSnapshot  snapshot;
+    atomic_size_t        refs;
+    struct FSeqDirEntry* list;
+};
+
+// The readers announce themselves in one of two counters, chosen by the
+// parity of the epoch, while they load the current snapshot and take a
+// reference to it. After replacing the snapshot the publisher advances the
+// epoch and waits for the counter of the previous epoch to drain, twice, so
+// both counters have drained since the snapshot was replaced. A reader
+// that may have loaded the old snapshot registered before it was replaced,
+// in one of the counters, so it has taken its reference and the old
+// snapshot can be released. (Draining only one counter is not enough: a
+// reader that loads the epoch before the previous publisher advanced it
+// may register in the other counter afterwards.) Each counter is drained
+// while new readers use the other one, so a steady stream of readers cannot
+// hold up the publisher, and readers never wait or retry.
+struct FSeqListing
+{
+    _Atomic(struct _FSeqSnapshot*) current;
+    atomic_size_t                  epoch;
+    atomic_size_t                  readers[2];
+    pthread_mutex_t                mutex;
+    int64_t                        version;
+};
+
+static void _fseqSnapshotRelease(struct _FSeqSnapshot* snapshot)
+{
+    if (snapshot && 1 == atomic_fetch_sub_explicit(&snapshot->refs, 1, memory_order_acq_rel))
+    {
+        fseqDirListDel(snapshot->list);
+        free(snapshot);
+    }
+}
+
+struct FSeqListing* fseqListingCreate(FSeqBool* error)
+{
+    struct FSeqListing* out = (struct FSeqListing*)calloc(1, sizeof(struct FSeqListing));
+    if (!out)
+    {
+        _fseqSetError(error);
+        return NULL;
+    }
+    atomic_init(&out->current, NULL);
+    atomic_init(&out->epoch, 0);
+    atomic_init(&out->readers[0], 0);
+    atomic_init(&out->readers[1], 0);
+    pthread_mutex_init(&out->mutex, NULL);
+    return out;
+}
+
+void fseqListingDel(struct FSeqListing* value)
+{
+    if (!value)
+    {
+        return;
+    }
+    _fseqSnapshotRelease(atomic_exchange(&value->current, NULL));
+    pthread_mutex_destroy(&value->mutex);
+    free(value);
+}
+
+void fseqListingPublish(
+    struct FSeqListing*  listing,
+    struct FSeqDirEntry* list,
+    FSeqBool*            error)
+{
+    struct _FSeqSnapshot* snapshot = (struct _FSeqSnapshot*)malloc(sizeof(struct _FSeqSnapshot));
+    struct _FSeqSnapshot* prev     = NULL;
+    size_t                epoch    = 0;
+    if (!snapshot)
+    {
+        fseqDirListDel(list);
+        _fseqSetError(error);
+        return;
+    }
+    snapshot->snapshot.entries = list;
+    snapshot->list             = list;
+    atomic_init(&snapshot->refs, 1);
+
+    pthread_mutex_lock(&listing->mutex);
+    snapshot->snapshot.version = ++listing->version;
+    prev = atomic_exchange(&listing->current, snapshot);
+    _FSEQ_SNAPSHOT_STEP(0);
+
+    // Wait for the readers that may have loaded the previous snapshot.
+    for (int i = 0; i < 2; ++i)
+    {
+        epoch = atomic_fetch_add(&listing->epoch, 1);
+        while (atomic_load(&listing->readers[epoch & 1]) > 0)
+        {
+            sched_yield();
+        }
+    }
+    pthread_mutex_unlock(&listing->mutex);
+
+    _fseqSnapshotRelease(prev);
+}
+
+void fseqListingRefresh(
+    struct FSeqListing*          listing,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error)
+{
+    FSeqBool             listError = FSEQ_FALSE;
+    struct FSeqDirEntry* list      = fseqDirList(path, options, &listError);
+    if (listError)
+    {
+        fseqDirListDel(list);
+        _fseqSetError(error);
+        return;
+    }
+    fseqListingPublish(listing, list, error);
+}
+
+const struct FSeqSnapshot* fseqSnapshotAcquire(struct FSeqListing* listing)
+{
+    const size_t          epoch    = atomic_load(&listing->epoch) & 1;
+    struct _FSeqSnapshot* snapshot = NULL;
+    _FSEQ_SNAPSHOT_STEP(1);
+    atomic_fetch_add(&listing->readers[epoch], 1);
+    _FSEQ_SNAPSHOT_STEP(2);
+    snapshot = atomic_load(&listing->current);
+    _FSEQ_SNAPSHOT_STEP(3);
+    if (snapshot)
+    {
+        atomic_fetch_add_explicit(&snapshot->refs, 1, memory_order_relaxed);
+    }
+    atomic_fetch_sub_explicit(&listing->readers[epoch], 1, memory_order_release);
+    return snapshot ? &snapshot->snapshot : NULL;
+}
+
+void fseqSnapshotRelease(const struct FSeqSnapshot* snapshot)
+{
+    _fseqSnapshotRelease((struct _FSeqSnapshot*)snapshot);
+}
+
+#endif // WIN32
@@ -104,18 +104,108 @@ FSeqBool fseqFileNameMatch(
     const char*,
     const struct FSeqFileNameSizes*);
 
+// This struct provides a set of frame numbers. The frames are stored as a
+// bitmap, one bit per frame, where the first frame is a multiple of 64 so
+// that the words of different sets line up. The memory used is proportional
+// to the range of the frames, not the number of frames.
+struct FSeqFrameSet
+{
+    int64_t   first;
+    uint64_t* words;
+    size_t    wordCount;
+};
+void fseqFrameSetInit(struct FSeqFrameSet*);
+void fseqFrameSetDel(struct FSeqFrameSet*);
+
+// Copy a frame set.
+FSeqBool fseqFrameSetCopy(const struct FSeqFrameSet*, struct FSeqFrameSet* out);
+
+// Add frames to a set.
+FSeqBool fseqFrameSetAdd(struct FSeqFrameSet*, int64_t frame);
+FSeqBool fseqFrameSetAddRange(struct FSeqFrameSet*, int64_t min, int64_t max);
+
+// Test whether a set contains a frame.
+FSeqBool fseqFrameSetContains(const struct FSeqFrameSet*, int64_t frame);
+
+// Get the number of frames in a set.
+int64_t fseqFrameSetCount(const struct FSeqFrameSet*);
+
+// Find the next frame in a set. Iterating over a set:
+//     int64_t frame = 0;
+//     for (FSeqBool i = fseqFrameSetNext(set, INT64_MIN, &frame); i;
+//         i = frame < INT64_MAX && fseqFrameSetNext(set, frame + 1, &frame))
+// Args:
+// * set - The frame set
+// * frame - The frame to start searching from
+// * out - The next frame that is greater than or equal to "frame"
+// Returns:
+// * Whether a frame was found
+FSeqBool fseqFrameSetNext(const struct FSeqFrameSet* set, int64_t frame, int64_t* out);
+
+// Set operations, the output may be one of the inputs.
+FSeqBool fseqFrameSetUnion(
+    const struct FSeqFrameSet* a,
+    const struct FSeqFrameSet* b,
+    struct FSeqFrameSet*       out);
+FSeqBool fseqFrameSetIntersection(
+    const struct FSeqFrameSet* a,
+    const struct FSeqFrameSet* b,
+    struct FSeqFrameSet*       out);
+FSeqBool fseqFrameSetDifference(
+    const struct FSeqFrameSet* a,
+    const struct FSeqFrameSet* b,
+    struct FSeqFrameSet*       out);
+
+// File types.
+typedef uint8_t FSeqFileType;
+#define FSEQ_FILE_TYPE_UNKNOWN 0
+#define FSEQ_FILE_TYPE_FILE    1
+#define FSEQ_FILE_TYPE_DIR     2
+#define FSEQ_FILE_TYPE_LINK    3
+#define FSEQ_FILE_TYPE_OTHER   4
+
 // This struct provides a directory entry.
+//
+// When a directory is listed without splitting the file names (see
+// FSeqDirOptions), the file name components are NULL and the entry instead
+// stores the original file name and the component sizes. Use
+// fseqDirEntrySplit() to create the components on demand.
+//
+// The type is taken from the directory listing without following symbolic
+// links. Directories are never grouped into sequences.
+//
+// The frames are only recorded when requested with FSeqDirOptions.
+//
+// The frame padding is the smallest number of digits of the zero padded
+// frame numbers, or zero if no frame number is zero padded. It does not
+// depend on the order of the files, so "0999" and "1000" have a padding
+// of four.
 struct FSeqDirEntry
 {
-    struct FSeqFileName  fileName;
-    int64_t              frameMin;
-    int64_t              frameMax;
-    uint8_t              framePadding;
-    struct FSeqDirEntry* next;
+    struct FSeqFileName      fileName;
+    char*                    name;
+    struct FSeqFileNameSizes sizes;
+    FSeqFileType             type;
+    int64_t                  frameMin;
+    int64_t                  frameMax;
+    uint8_t                  framePadding;
+    int64_t                  frameCount;
+    struct FSeqFrameSet      frames;
+    struct FSeqDirEntry*     next;
 };
 void fseqDirEntryInit(struct FSeqDirEntry*);
 void fseqDirEntryDel(struct FSeqDirEntry*);
 
+// Create the file name components from the original file name, if they
+// have not already been created.
+// Returns:
+// * Whether the file name components are available
+FSeqBool fseqDirEntrySplit(struct FSeqDirEntry*);
+
+// Get the frames of a directory entry. The recorded frames are used if
+// available, otherwise every frame from the minimum to the maximum.
+FSeqBool fseqDirEntryFrames(const struct FSeqDirEntry*, struct FSeqFrameSet* out);
+
 // Convert a directory entry to a string.
 // Args:
 // * entry - The directory entry
@@ -128,13 +218,194 @@ void fseqDirEntryToString(
     FSeqBool                   path,
     size_t                     max);
 
+// Get the file name of a frame of a directory entry, formatted with the
+// frame padding. Entries that are not sequences return the file name.
+// Args:
+// * entry - The directory entry
+// * frame - The frame number
+// * path - Whether to include the path
+// * out - The output string
+// * max - The maximum output string length
+// Returns:
+// * Whether the file name fits in the output string
+FSeqBool fseqDirEntryFrameName(
+    const struct FSeqDirEntry* entry,
+    int64_t                    frame,
+    FSeqBool                   path,
+    char*                      out,
+    size_t                     max);
+
+// Parse a file sequence string into a list of directory entries without
+// accessing the file system. Use fseqDirListDel() to delete the list.
+// Supported forms:
+// * A frame or frame range: "render.0042.exr", "render.0001-0100.exr"
+// * Comma separated frame ranges, one entry per range: "render.1-10,20-30.exr"
+// * Padding notation: "render.####.exr", "render.%04d.exr"; the entry has
+//   no frames and the frame count is zero
+// * Padding notation followed by frame ranges: "render.%04d.exr 1-100"
+// Args:
+// * in - The string to be parsed
+// * max - The maximum length of the string
+// * options - The options or NULL
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * A list of directory entries
+struct FSeqDirEntry* fseqDirEntryParse(
+    const char*                       in,
+    size_t                            max,
+    const struct FSeqFileNameOptions* options,
+    FSeqBool*                         error);
+
+// Parse multiple file sequence strings. The list for each string is stored
+// in the corresponding element of "out", use fseqDirListDel() to delete each
+// list. Intermediate buffers are shared between the strings.
+// Args:
+// * in - The strings to be parsed
+// * count - The number of strings
+// * out - The output lists
+// * max - The maximum length of each string
+// * options - The options or NULL
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * The total number of directory entries
+size_t fseqDirEntryParseBatch(
+    const char* const*                in,
+    size_t                            count,
+    struct FSeqDirEntry**             out,
+    size_t                            max,
+    const struct FSeqFileNameOptions* options,
+    FSeqBool*                         error);
+
+// This struct provides an entry read from a directory source. The name
+// does not need to be NUL terminated.
+struct FSeqDirSourceEntry
+{
+    const char*  name;
+    size_t       len;
+    FSeqFileType type;
+};
+
+// This struct provides a source of directory entries, so the file names can
+// be grouped from somewhere other than the file system, for example from
+// memory for tests and benchmarks.
+// * open - Open a directory, returns a handle or NULL if the directory
+//   cannot be opened. The data member is passed as the first argument.
+// * next - Read the next batch of at most max entries, returns the number
+//   of entries or zero at the end of the directory. The names remain valid
+//   until the next call. Errors are reported by setting the error.
+// * close - Close a directory handle
+// * data - Data passed to open
+struct FSeqDirSource
+{
+    void*  (*open)(void* data, const char* path);
+    size_t (*next)(void* handle, struct FSeqDirSourceEntry* out, size_t max, FSeqBool* error);
+    void   (*close)(void* handle);
+    void*  data;
+};
+
+// Get the file system directory source, which uses readdir() (or
+// FindFirstFileW() on Windows).
+const struct FSeqDirSource* fseqDirSourceSystem();
+
+// Create a directory source that serves names from a buffer. The names are
+// separated by the delimiter and are paths relative to the root of the
+// source; names ending with '/' are directories. Opening a directory serves
+// the names directly inside it, and the root is opened with "" or ".".
+// Other directories must have their own entry, opening a path without one
+// is an error. The buffer is copied. Use fseqDirSourceMemoryDel() to delete the source.
+// Args:
+// * names - The names
+// * size - The size of the names in bytes
+// * delimiter - The character that separates the names
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqDirSource* fseqDirSourceMemoryCreate(
+    const char* names,
+    size_t      size,
+    char        delimiter,
+    FSeqBool*   error);
+
+// Delete a memory directory source.
+void fseqDirSourceMemoryDel(struct FSeqDirSource*);
+
+// This struct provides throttle statistics.
+// * operations - The number of operations
+// * waits - The number of times operations waited
+// * waitTime - The total time spent waiting in microseconds
+struct FSeqThrottleStats
+{
+    int64_t operations;
+    int64_t waits;
+    int64_t waitTime;
+};
+void fseqThrottleStatsInit(struct FSeqThrottleStats*);
+
+// The throttle limits the rate of file system operations with a token
+// bucket, for example so background scans do not overload the servers of
+// shared storage. A throttle may be shared by any number of threads and
+// listings, and the rate may be changed while it is in use. Opening a
+// directory, each read of up to 64 directory entries, and getting the
+// status of a file each count as one operation.
+struct FSeqThrottle;
+
+// Create a throttle.
+// Args:
+// * rate - The maximum number of operations per second, or zero for no limit
+// * burst - The number of operations that may run without waiting after the
+//   throttle has been idle, or zero for one second of operations
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqThrottle* fseqThrottleCreate(double rate, double burst, FSeqBool* error);
+
+// Delete a throttle. No operations may be waiting for it.
+void fseqThrottleDel(struct FSeqThrottle*);
+
+// Change the rate of a throttle. Operations that are already waiting use
+// the new rate within 100 milliseconds.
+void fseqThrottleSetRate(struct FSeqThrottle*, double rate, double burst);
+
+// Wait until a number of operations may run.
+// Returns:
+// * The time spent waiting in microseconds
+int64_t fseqThrottleAcquire(struct FSeqThrottle*, int64_t count);
+
+// Get the throttle statistics.
+void fseqThrottleStats(struct FSeqThrottle*, struct FSeqThrottleStats* out);
+
 // This struct provides directory listing options.
+//
+// The timeout is the maximum time in milliseconds to spend reading the
+// directory, or zero for no limit. It is checked between reads of the
+// directory, so a single read that blocks (for example on an unresponsive
+// network file system) is not interrupted. When the timeout expires
+// fseqDirList() returns the entries grouped so far; use FSeqDirCursor to
+// continue the listing instead. If partial is not NULL it is set to whether
+// the listing stopped at the timeout, which is not an error. For
+// asynchronous listings it is set when the result is collected with
+// fseqAsyncPoll(). Listings through the fseqd daemon have no timeout and
+// are never partial.
+//
+// The source is where the directory entries are read from, or NULL for the
+// file system. Listings through the fseqd daemon always use the file
+// system.
+//
+// The throttle limits the rate of reads from the directory, and of getting
+// the status of entries whose type the file system does not report, or
+// NULL for no limit; it must remain valid until the listing is complete. If throttled
+// is not NULL the time in microseconds that the listing waited for the
+// throttle is added to it atomically, so listings on several threads can
+// share the counter. Listings through the fseqd daemon are not throttled.
 struct FSeqDirOptions
 {
-    FSeqBool                   dotAndDotDotDirs;
-    FSeqBool                   dotFiles;
-    FSeqBool                   sequence;
-    struct FSeqFileNameOptions fileNameOptions;
+    FSeqBool                    dotAndDotDotDirs;
+    FSeqBool                    dotFiles;
+    FSeqBool                    sequence;
+    FSeqBool                    splitFileNames;
+    FSeqBool                    frames;
+    struct FSeqFileNameOptions  fileNameOptions;
+    int64_t                     timeout;
+    const struct FSeqDirSource* source;
+    struct FSeqThrottle*        throttle;
+    int64_t*                    throttled;
+    FSeqBool*                   partial;
 };
 void fseqDirOptionsInit(struct FSeqDirOptions*);
 
@@ -150,9 +421,799 @@ struct FSeqDirEntry* fseqDirList(
     const struct FSeqDirOptions* options,
     FSeqBool*                    error);
 
+// The directory cursor lists a directory in steps, each limited by the
+// timeout option, for example to keep an interactive application
+// responsive while a slow directory is listed. The directory is kept open
+// between steps.
+struct FSeqDirCursor;
+
+// Open a directory for listing.
+// Args:
+// * path - The directory path
+// * options - The directory listing options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqDirCursor* fseqDirCursorCreate(
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error);
+
+// Close the directory.
+void fseqDirCursorDel(struct FSeqDirCursor*);
+
+// Continue listing the directory until it is complete or the timeout
+// expires. Each call returns every entry listed so far, including the
+// entries from previous calls, so sequences that span the steps are
+// returned whole. Use fseqDirListDel() to delete each list.
+// Args:
+// * cursor - The directory cursor
+// * partial - Whether the listing is incomplete, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * The entries listed so far
+struct FSeqDirEntry* fseqDirCursorList(
+    struct FSeqDirCursor* cursor,
+    FSeqBool*             partial,
+    FSeqBool*             error);
+
+// Find the sequence that a file belongs to, with a single pass over the
+// directory containing the file. Only the names with the same base and
+// extension are parsed, and no memory is allocated for other names. The
+// directory is read through the source of the options, and the timeout and
+// throttle apply as for fseqDirList(); if the timeout expires the frames
+// found so far are returned.
+// Args:
+// * fileName - The file name, for example "/show/render.0042.exr"
+// * out - The output directory entry, initialized with fseqDirEntryInit()
+// * options - The directory listing options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * Whether the sequence was found
+FSeqBool fseqDirFindSequence(
+    const char*                  fileName,
+    struct FSeqDirEntry*         out,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error);
+
 // Delete a directory list.
 void fseqDirListDel(struct FSeqDirEntry*);
 
+// This struct provides a directory lister that can be reused, for example
+// by programs that list the same directories many times. The entries, names,
+// and hash tables of a listing are allocated from memory that the lister
+// keeps for the next listing, so once it has grown to fit the directories
+// listing does not allocate (except for the frame sets, if requested).
+struct FSeqLister;
+
+// Create a lister.
+// Args:
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqLister* fseqListerCreate(FSeqBool* error);
+
+// Delete a lister and the list from the last call.
+void fseqListerDel(struct FSeqLister*);
+
+// Invalidate the list from the last call. The memory is kept for the next
+// listing.
+void fseqListerReset(struct FSeqLister*);
+
+// List the contents of a directory like fseqDirList(). The list is owned by
+// the lister and remains valid until the next call, fseqListerReset(), or
+// fseqListerDel(); do not delete it with fseqDirListDel() or split the
+// entries with fseqDirEntrySplit().
+// Args:
+// * lister - The lister
+// * path - The directory path
+// * options - The directory listing options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * A list of directory entries
+const struct FSeqDirEntry* fseqListerList(
+    struct FSeqLister*           lister,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error);
+
+// This struct provides grouping of file names into sequences without
+// accessing the file system, for example from a list of paths. File names
+// are grouped across directories since the paths are part of the names.
+struct FSeqGroup;
+
+// Create a group.
+// Args:
+// * options - The directory listing options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqGroup* fseqGroupCreate(const struct FSeqDirOptions* options, FSeqBool* error);
+
+// Delete a group.
+void fseqGroupDel(struct FSeqGroup*);
+
+// Add a file name to a group. The file name does not need to be NUL
+// terminated, and it is copied only when it starts a new entry.
+// Args:
+// * group - The group
+// * fileName - The file name
+// * len - The length of the file name
+// * type - The file type
+// Returns:
+// * Whether the file name was added, file names that are empty or longer
+//   than FSEQ_STRING_LEN are not added
+FSeqBool fseqGroupAdd(
+    struct FSeqGroup* group,
+    const char*       fileName,
+    size_t            len,
+    FSeqFileType      type);
+
+// Get the list of directory entries in the order they were added, and reset
+// the group. Use fseqDirListDel() to delete the list.
+struct FSeqDirEntry* fseqGroupList(struct FSeqGroup*, FSeqBool* error);
+
+// List the sequences in a tar archive without extracting it. Only the
+// member headers are read, the member data is skipped, so the time depends
+// on the number of members rather than the size of the archive. The ustar,
+// GNU (long names and base-256 sizes), and pax formats are supported;
+// compressed archives are not. The member names are grouped across
+// directories like fseqGroupList(), and members with names longer than
+// FSEQ_STRING_LEN are skipped and set the error. Use fseqDirListDel() to
+// delete the list.
+// Args:
+// * fileName - The archive file name
+// * options - The directory listing options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * A list of directory entries, if the archive is damaged the entries
+//   read before the damage are returned and the error is set
+struct FSeqDirEntry* fseqArchiveList(
+    const char*                  fileName,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error);
+
+// Asynchronous directory listing for event loops. Listings are run on a
+// pool of worker threads, and a file descriptor becomes readable while
+// results are waiting to be collected with fseqAsyncPoll(). On Linux the
+// file descriptor is an eventfd, on other POSIX systems it is a pipe. The
+// asynchronous interface is not available on Windows.
+struct FSeqAsync;
+
+// Create the worker threads.
+// Args:
+// * threads - The number of worker threads, or zero for one per CPU
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqAsync* fseqAsyncCreate(size_t threads, FSeqBool* error);
+
+// Cancel any remaining requests and stop the worker threads.
+void fseqAsyncDel(struct FSeqAsync*);
+
+// Get the file descriptor used to wait for results (for example with
+// poll() or epoll). The file descriptor should not be read directly.
+int fseqAsyncFd(const struct FSeqAsync*);
+
+// Submit a directory listing request.
+// Args:
+// * async - The asynchronous lister
+// * path - The directory path
+// * options - The directory listing options, may also pass NULL instead
+// Returns:
+// * The request ID, or zero if the request could not be submitted
+uint64_t fseqAsyncSubmit(
+    struct FSeqAsync*            async,
+    const char*                  path,
+    const struct FSeqDirOptions* options);
+
+// Cancel a request. A listing that is in progress is stopped early and
+// its results are discarded.
+// Returns:
+// * Whether the request was found
+FSeqBool fseqAsyncCancel(struct FSeqAsync*, uint64_t id);
+
+// Collect a completed request without blocking. Use fseqDirListDel() to
+// delete the list.
+// Args:
+// * async - The asynchronous lister
+// * id - The request ID, may also pass NULL instead
+// * out - The list of directory entries
+// * error - Whether any errors occurred listing the directory, may also
+//   pass NULL instead
+// Returns:
+// * Whether a request was collected
+FSeqBool fseqAsyncPoll(
+    struct FSeqAsync*     async,
+    uint64_t*             id,
+    struct FSeqDirEntry** out,
+    FSeqBool*             error);
+
+// Compute a fast non-cryptographic hash of data. The hash is compatible
+// with XXH64 from the xxHash library.
+uint64_t fseqHash64(const void* data, size_t size, uint64_t seed);
+
+// This struct provides checksum options.
+struct FSeqChecksumOptions
+{
+    size_t threads;
+    size_t bufferSize;
+};
+void fseqChecksumOptionsInit(struct FSeqChecksumOptions*);
+
+// This struct provides the checksum of a frame.
+struct FSeqFrameChecksum
+{
+    int64_t  frame;
+    uint64_t digest;
+    FSeqBool error;
+};
+
+// This struct provides the checksums of a sequence. The sequence digest is
+// the hash of the frame digests in frame order.
+struct FSeqChecksums
+{
+    struct FSeqFrameChecksum* frames;
+    size_t                    frameCount;
+    uint64_t                  digest;
+};
+void fseqChecksumsInit(struct FSeqChecksums*);
+void fseqChecksumsDel(struct FSeqChecksums*);
+
+// Compute the checksums of the frames of a directory entry with
+// fseqHash64(). The frames are read with large sequential reads and spread
+// across threads (zero threads for one per CPU). The recorded frames are
+// used if available, otherwise every frame from the minimum to the maximum.
+// Args:
+// * path - The directory containing the entry, may also pass NULL instead
+// * entry - The directory entry
+// * out - The output checksums, initialized with fseqChecksumsInit()
+// * options - The checksum options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * Whether every frame was read, frames that could not be read are
+//   marked with an error
+FSeqBool fseqChecksum(
+    const char*                       path,
+    const struct FSeqDirEntry*        entry,
+    struct FSeqChecksums*             out,
+    const struct FSeqChecksumOptions* options,
+    FSeqBool*                         error);
+
+// This struct provides options for copying and moving sequences.
+// * frameOffset - Added to the frame numbers, for example -1000 to
+//   renumber frame 1001 to 1
+// * framePadding - The new frame padding, or -1 to keep the padding
+// * overwrite - Whether to replace existing files
+// * threads - The number of threads, or zero for one per CPU
+struct FSeqCopyOptions
+{
+    int64_t  frameOffset;
+    int      framePadding;
+    FSeqBool overwrite;
+    size_t   threads;
+};
+void fseqCopyOptionsInit(struct FSeqCopyOptions*);
+
+// Copy or move the frames of a directory entry, optionally renumbering
+// and re-padding them. The frames are processed in parallel batches; files
+// are copied with copy_file_range() on Linux, and moved with renameat()
+// (falling back to a copy between file systems). If a move fails part way,
+// the frames that were moved are moved back to their original names, so
+// the sequence is not left split between two directories. A copy that
+// fails part way keeps the frames that were copied.
+//
+// When renumbered frames in the same directory overlap the original frames
+// (for example moving 1-100 to 51-150) the frames are first moved to
+// temporary names so no frame is replaced before it has been moved. If any
+// frame fails, the moved frames are put back under their original names,
+// and temporary copies are removed. Copying over overlapping frames
+// requires the overwrite option.
+//
+// The recorded frames are used if available, otherwise every frame from
+// the minimum to the maximum. Entries without frames (padding notation
+// without frame ranges) are rejected with an error.
+// Args:
+// * path - The directory containing the entry, may also pass NULL instead
+// * entry - The directory entry
+// * outPath - The output directory, or NULL for the same directory
+// * options - The options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * Whether every frame was copied or moved
+FSeqBool fseqCopy(
+    const char*                   path,
+    const struct FSeqDirEntry*    entry,
+    const char*                   outPath,
+    const struct FSeqCopyOptions* options,
+    FSeqBool*                     error);
+FSeqBool fseqMove(
+    const char*                   path,
+    const struct FSeqDirEntry*    entry,
+    const char*                   outPath,
+    const struct FSeqCopyOptions* options,
+    FSeqBool*                     error);
+
+// This struct provides options for removing sequences.
+// * dryRun - Check which frames exist instead of removing them
+// * threads - The number of threads, or zero for one per CPU. Removing files
+//   is usually bound by the latency of the file system rather than the CPU
+//   (especially on network file systems), so the default is 16.
+struct FSeqRemoveOptions
+{
+    FSeqBool dryRun;
+    size_t   threads;
+};
+void fseqRemoveOptionsInit(struct FSeqRemoveOptions*);
+
+// This struct provides the number of frames removed, the number that did
+// not exist, and the number that could not be removed.
+struct FSeqRemoveResult
+{
+    int64_t removed;
+    int64_t missing;
+    int64_t failed;
+};
+void fseqRemoveResultInit(struct FSeqRemoveResult*);
+
+// Remove the frames of a directory entry. The frames are removed with
+// unlinkat() relative to the directory, in parallel batches. Directories,
+// and entries without frames (padding notation without frame ranges), are
+// rejected with an error.
+//
+// The recorded frames are used if available, otherwise every frame from
+// the minimum to the maximum; frames that do not exist are counted as
+// missing.
+// Args:
+// * path - The directory containing the entry, may also pass NULL instead
+// * entry - The directory entry
+// * out - The result counts
+// * options - The options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * Whether no frames failed to be removed
+FSeqBool fseqRemove(
+    const char*                     path,
+    const struct FSeqDirEntry*      entry,
+    struct FSeqRemoveResult*        out,
+    const struct FSeqRemoveOptions* options,
+    FSeqBool*                       error);
+
+// This struct provides options for measuring disk usage.
+// * threads - The number of threads, or zero for one per CPU. The default is
+//   16 since the file status is usually bound by the latency of the file
+//   system rather than the CPU.
+// * apparent - Count the file sizes instead of the allocated blocks
+// * throttle - Limits the rate of getting the file status, may also be NULL
+// * throttled - If not NULL, the time in microseconds spent waiting for the
+//   throttle is added to it atomically (the longest time of any of the
+//   threads)
+struct FSeqDiskUsageOptions
+{
+    size_t               threads;
+    FSeqBool             apparent;
+    struct FSeqThrottle* throttle;
+    int64_t*             throttled;
+};
+void fseqDiskUsageOptionsInit(struct FSeqDiskUsageOptions*);
+
+// This struct provides the disk usage of a directory entry: the number of
+// bytes, the number of files, the number of frames that did not exist, and
+// the number that could not be read.
+struct FSeqDiskUsage
+{
+    int64_t bytes;
+    int64_t files;
+    int64_t missing;
+    int64_t failed;
+};
+void fseqDiskUsageInit(struct FSeqDiskUsage*);
+
+// Measure the disk usage of each entry of a directory list. The status of
+// each frame is read with fstatat() relative to the directory, in parallel
+// batches across all of the entries, so lists with many short sequences
+// are measured as quickly as lists with a few long ones. Directories are
+// not descended into and their usage is zero.
+//
+// The recorded frames are used if available, otherwise every frame from
+// the minimum to the maximum. Hard links are counted once for each name.
+// Args:
+// * path - The directory containing the entries, may also pass NULL instead
+// * list - The directory list
+// * out - The disk usage of each entry, in the order of the list
+// * options - The options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * Whether the status of every frame that exists could be read
+FSeqBool fseqDiskUsage(
+    const char*                        path,
+    const struct FSeqDirEntry*         list,
+    struct FSeqDiskUsage*              out,
+    const struct FSeqDiskUsageOptions* options,
+    FSeqBool*                          error);
+
+// Encode a directory list into a compact binary buffer, for example to
+// send it to another process or store it in a cache. The frame sets are
+// included.
+// Args:
+// * value - The directory list
+// * out - The output buffer, may also pass NULL to get the size
+// * max - The size of the output buffer
+// Returns:
+// * The size of the encoded list, or zero if it could not be encoded. If
+//   the size is larger than max nothing is written.
+size_t fseqDirListEncode(const struct FSeqDirEntry* value, void* out, size_t max);
+
+// Decode a directory list encoded with fseqDirListEncode().
+// Args:
+// * in - The encoded list
+// * size - The size of the encoded list
+// * splitFileNames - Whether to split the file names into components
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * The directory list, which should be deleted with fseqDirListDel()
+struct FSeqDirEntry* fseqDirListDecode(
+    const void* in,
+    size_t      size,
+    FSeqBool    splitFileNames,
+    FSeqBool*   error);
+
+// Get the default socket path of the listing daemon: $FSEQD_SOCKET if it
+// is set, otherwise "fseqd.sock" in $XDG_RUNTIME_DIR, otherwise
+// "/tmp/fseqd-<uid>.sock".
+// Returns:
+// * Whether the path fits in the output buffer
+FSeqBool fseqDaemonSocketPath(char* out, size_t max);
+
+// This struct provides options for the listing daemon.
+// * maxDirs - The maximum number of cached directory listings, the least
+//   recently used listings are removed first
+struct FSeqDaemonOptions
+{
+    size_t maxDirs;
+};
+void fseqDaemonOptionsInit(struct FSeqDaemonOptions*);
+
+// The listing daemon caches directory listings and serves them to other
+// processes over a Unix domain socket. Concurrent requests for the same
+// directory wait for a single scan. Cached listings are invalidated with
+// inotify on Linux, or by comparing the directory modification time on
+// other systems. The daemon runs on background threads until it is
+// deleted. Only connections from the same user are served. Not available
+// on Windows.
+struct FSeqDaemon;
+
+// Start the listing daemon.
+// Args:
+// * socketPath - The socket path, may also pass NULL for the default path
+// * options - The options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead. It is
+//   an error if another daemon is already listening on the socket.
+struct FSeqDaemon* fseqDaemonCreate(
+    const char*                     socketPath,
+    const struct FSeqDaemonOptions* options,
+    FSeqBool*                       error);
+
+// Stop the listing daemon and remove the socket.
+void fseqDaemonDel(struct FSeqDaemon*);
+
+// This struct provides a connection to the listing daemon.
+struct FSeqDaemonClient;
+
+// Connect to the listing daemon. It is an error if the daemon runs as
+// another user.
+// Args:
+// * socketPath - The socket path, may also pass NULL for the default path
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqDaemonClient* fseqDaemonConnect(const char* socketPath, FSeqBool* error);
+
+// Close the connection to the listing daemon.
+void fseqDaemonDisconnect(struct FSeqDaemonClient*);
+
+// List the contents of a directory through the listing daemon. The result
+// is the same as fseqDirList(); if the daemon cannot be reached an error is
+// returned, and the caller may fall back to fseqDirList().
+// Args:
+// * client - The connection
+// * path - The directory path, relative paths are resolved by the client
+// * options - The directory listing options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * The directory list, which should be deleted with fseqDirListDel()
+struct FSeqDirEntry* fseqDaemonList(
+    struct FSeqDaemonClient*     client,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error);
+
+// The sequence index provides fast searches of the base names of entries
+// across many directories, for example type-ahead search in a file browser.
+// Directories are added incrementally as they are listed; the base names and
+// the words within them are kept in sorted runs that are merged as they
+// grow, so prefix and word searches are a binary search of each run.
+// Searches are case insensitive for ASCII characters.
+//
+// Searches may run concurrently, but not concurrently with adding
+// directories.
+struct FSeqIndex;
+
+// Create a sequence index.
+struct FSeqIndex* fseqIndexCreate(FSeqBool* error);
+
+// Delete a sequence index and the directory lists that were added.
+void fseqIndexDel(struct FSeqIndex*);
+
+// Add a directory list to the index. The index takes ownership of the list,
+// which is deleted with the index.
+// Args:
+// * index - The sequence index
+// * path - The directory path, which is returned with the search results
+// * list - The directory list
+// Returns:
+// * Whether the list was added
+FSeqBool fseqIndexAdd(struct FSeqIndex* index, const char* path, struct FSeqDirEntry* list);
+
+// Get the number of entries in the index.
+size_t fseqIndexSize(const struct FSeqIndex*);
+
+// How the search text is matched against the base names:
+// * FSEQ_INDEX_MATCH_PREFIX - The beginning of the base name
+// * FSEQ_INDEX_MATCH_WORD - The beginning of any word in the base name,
+//   words are separated by punctuation and by changes between letters and
+//   digits, for example "comp" and "010" in "shot010_comp"
+// * FSEQ_INDEX_MATCH_SUBSTRING - Anywhere in the base name. The base names
+//   are scanned, which takes milliseconds for millions of entries, so the
+//   word match is better suited to type-ahead search.
+typedef uint8_t FSeqIndexMatch;
+#define FSEQ_INDEX_MATCH_PREFIX    0
+#define FSEQ_INDEX_MATCH_WORD      1
+#define FSEQ_INDEX_MATCH_SUBSTRING 2
+
+// This struct provides a search of the sequence index.
+// * text - The text to search for, an empty string matches every entry
+// * match - How the text is matched. Prefix and word matches are returned
+//   sorted by the matching text, substring matches in the order the entries
+//   were added.
+// * extensions - A comma separated list of file extensions, for example
+//   "exr,tif", or NULL for every extension
+struct FSeqIndexQuery
+{
+    const char*    text;
+    FSeqIndexMatch match;
+    const char*    extensions;
+};
+void fseqIndexQueryInit(struct FSeqIndexQuery*);
+
+// This struct provides a search result. The values point into the index.
+// * path - The path of the directory containing the entry
+// * entry - The directory entry
+struct FSeqIndexResult
+{
+    const char*                path;
+    const struct FSeqDirEntry* entry;
+};
+void fseqIndexResultInit(struct FSeqIndexResult*);
+
+// Search the sequence index.
+// Args:
+// * index - The sequence index
+// * query - The search
+// * out - The results
+// * max - The maximum number of results
+// Returns:
+// * The number of results
+size_t fseqIndexFind(
+    const struct FSeqIndex*      index,
+    const struct FSeqIndexQuery* query,
+    struct FSeqIndexResult*      out,
+    size_t                       max);
+
+// This struct provides options for prefetching the frames of a sequence.
+// * window - The minimum number of frames to prefetch ahead of the playhead
+// * maxWindow - The maximum number of frames to prefetch ahead
+// * lead - The playback time to prefetch ahead, in milliseconds. The number
+//   of frames is adapted to the rate of playback, between the minimum and
+//   maximum windows.
+struct FSeqPrefetchOptions
+{
+    int64_t window;
+    int64_t maxWindow;
+    int64_t lead;
+};
+void fseqPrefetchOptionsInit(struct FSeqPrefetchOptions*);
+
+// This struct provides prefetching statistics.
+// * frames - The number of frames prefetched
+// * failed - The number of frames that could not be opened
+// * seeks - The number of seeks and changes of direction
+// * window - The current number of frames prefetched ahead
+struct FSeqPrefetchStats
+{
+    int64_t frames;
+    int64_t failed;
+    int64_t seeks;
+    int64_t window;
+};
+void fseqPrefetchStatsInit(struct FSeqPrefetchStats*);
+
+// The prefetcher reads ahead of the playhead of a sequence, so the frames
+// are in the page cache before they are shown. A background thread asks
+// the operating system to read the upcoming frames without waiting for them
+// (posix_fadvise() with POSIX_FADV_WILLNEED, or F_RDADVISE on macOS).
+// Frames that are not in the recorded frames of the entry are skipped.
+// Not available on Windows.
+struct FSeqPrefetch;
+
+// Create a prefetcher for a sequence. The entry is copied.
+// Args:
+// * path - The directory containing the entry, may also pass NULL instead
+// * entry - The directory entry
+// * options - The options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqPrefetch* fseqPrefetchCreate(
+    const char*                        path,
+    const struct FSeqDirEntry*         entry,
+    const struct FSeqPrefetchOptions*  options,
+    FSeqBool*                          error);
+
+// Stop prefetching and delete the prefetcher.
+void fseqPrefetchDel(struct FSeqPrefetch*);
+
+// Update the playhead, for example each time a frame is shown. Moving by a
+// few frames in the direction of playback continues prefetching; a new
+// stride (for example every second frame) is followed once it repeats.
+// Any other move is a seek, which cancels the frames that were queued and
+// starts prefetching from the new frame.
+// Args:
+// * prefetch - The prefetcher
+// * frame - The current frame
+// * direction - The direction of playback, forward if zero or positive
+void fseqPrefetchUpdate(struct FSeqPrefetch* prefetch, int64_t frame, int direction);
+
+// Get the prefetching statistics.
+void fseqPrefetchStats(const struct FSeqPrefetch*, struct FSeqPrefetchStats* out);
+
+// This struct provides options for the frame cache.
+// * maxBytes - The maximum size of the cached frames in bytes
+// * shards - The number of shards, each with its own lock, so threads
+//   reading different frames rarely wait for each other
+// * map - Whether to map the frame files into memory instead of reading them
+struct FSeqCacheOptions
+{
+    size_t   maxBytes;
+    size_t   shards;
+    FSeqBool map;
+};
+void fseqCacheOptionsInit(struct FSeqCacheOptions*);
+
+// This struct provides frame cache statistics.
+struct FSeqCacheStats
+{
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+    size_t  bytes;
+    size_t  frames;
+};
+void fseqCacheStatsInit(struct FSeqCacheStats*);
+
+// This struct provides the contents of a cached frame file.
+struct FSeqCacheFrame
+{
+    const void* data;
+    size_t      size;
+};
+
+// The frame cache keeps the contents of frame files in memory, for example
+// for scrubbing back and forth in a player. Frames are looked up by
+// sequence and frame number, so a cached frame is returned without creating
+// the file name or accessing the file system. The least recently used frames
+// are removed when the cache is full. The cache is thread safe. Not
+// available on Windows.
+struct FSeqCache;
+
+// This struct provides a sequence registered with a frame cache.
+struct FSeqCacheSequence;
+
+// Create a frame cache.
+// Args:
+// * options - The options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqCache* fseqCacheCreate(const struct FSeqCacheOptions* options, FSeqBool* error);
+
+// Delete a frame cache. Every frame must have been released.
+void fseqCacheDel(struct FSeqCache*);
+
+// Register a sequence with the cache. The entry is copied, and the sequence
+// is deleted with the cache.
+// Args:
+// * cache - The frame cache
+// * path - The directory containing the entry, may also pass NULL instead
+// * entry - The directory entry
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqCacheSequence* fseqCacheAddSequence(
+    struct FSeqCache*          cache,
+    const char*                path,
+    const struct FSeqDirEntry* entry,
+    FSeqBool*                  error);
+
+// Get the contents of a frame, reading the frame file if it is not cached.
+// The frame remains valid until it is released, even if it is removed from
+// the cache.
+// Args:
+// * cache - The frame cache
+// * sequence - The sequence
+// * frame - The frame number
+// * error - Whether any errors occurred, may also pass NULL instead
+// Returns:
+// * The frame, or NULL if the frame could not be read
+const struct FSeqCacheFrame* fseqCacheGet(
+    struct FSeqCache*                cache,
+    const struct FSeqCacheSequence*  sequence,
+    int64_t                          frame,
+    FSeqBool*                        error);
+
+// Release a frame returned by fseqCacheGet().
+void fseqCacheRelease(struct FSeqCache*, const struct FSeqCacheFrame*);
+
+// Get the frame cache statistics.
+void fseqCacheStats(struct FSeqCache*, struct FSeqCacheStats* out);
+
+// This struct provides an immutable directory listing shared between
+// threads.
+// * entries - The list of directory entries
+// * version - The number of the listing, starting from one and increasing
+//   each time a listing is published
+struct FSeqSnapshot
+{
+    const struct FSeqDirEntry* entries;
+    int64_t                    version;
+};
+
+// The listing publisher shares a directory listing between threads, for
+// example between a thread that refreshes the listing and many threads that
+// read it. Publishing replaces the current snapshot; readers acquire the
+// current snapshot without locking or copying, and a snapshot is deleted
+// when the last reader has released it. Acquiring and releasing snapshots
+// never waits for the publishing thread. Not available on Windows.
+struct FSeqListing;
+
+// Create a listing publisher with no snapshot.
+// Args:
+// * error - Whether any errors occurred, may also pass NULL instead
+struct FSeqListing* fseqListingCreate(FSeqBool* error);
+
+// Delete a listing publisher. Snapshots that have not been released remain
+// valid until they are released. No threads may acquire snapshots while the
+// publisher is deleted.
+void fseqListingDel(struct FSeqListing*);
+
+// Publish a directory list as the current snapshot. The publisher takes
+// ownership of the list, which must not be changed afterwards; it is also
+// deleted if an error occurs. Publishing is thread safe.
+// Args:
+// * listing - The listing publisher
+// * list - The list of directory entries, for example from fseqDirList()
+// * error - Whether any errors occurred, may also pass NULL instead
+void fseqListingPublish(
+    struct FSeqListing*  listing,
+    struct FSeqDirEntry* list,
+    FSeqBool*            error);
+
+// List the contents of a directory with fseqDirList() and publish the
+// result. If the directory cannot be listed the current snapshot is kept.
+// Args:
+// * listing - The listing publisher
+// * path - The directory path
+// * options - The directory listing options, may also pass NULL instead
+// * error - Whether any errors occurred, may also pass NULL instead
+void fseqListingRefresh(
+    struct FSeqListing*          listing,
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    FSeqBool*                    error);
+
+// Acquire the current snapshot. The snapshot remains valid until it is
+// released, even if newer snapshots are published.
+// Returns:
+// * The snapshot, or NULL if nothing has been published
+const struct FSeqSnapshot* fseqSnapshotAcquire(struct FSeqListing*);
+
+// Release a snapshot returned by fseqSnapshotAcquire().
+void fseqSnapshotRelease(const struct FSeqSnapshot*);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,373 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2019-2021 Darby Johnston
+// All rights reserved.
+
+#ifndef FSEQ_HPP
+#define FSEQ_HPP
+
+// Optional header-only C++17 interface. The classes own the C structs and
+// release them automatically, the accessors return views into the C strings
+// so no copies are made.
+
+#include "fseq.h"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace fseq
+{
+    // Get a view of a C string, NULL strings are returned as empty views.
+    inline std::string_view view(const char* value) noexcept
+    {
+        return value ? std::string_view(value) : std::string_view();
+    }
+
+    // This class provides owned file name components.
+    class FileName
+    {
+    public:
+        FileName() noexcept
+        {
+            fseqFileNameInit(&_value);
+        }
+
+        explicit FileName(
+            const char*                       fileName,
+            const FSeqFileNameOptions*        options = nullptr,
+            size_t                            max     = FSEQ_STRING_LEN)
+        {
+            fseqFileNameInit(&_value);
+            fseqFileNameSplit(fileName, &_value, max, options);
+        }
+
+        FileName(FileName&& other) noexcept
+        {
+            _value = other._value;
+            fseqFileNameInit(&other._value);
+        }
+
+        FileName& operator = (FileName&& other) noexcept
+        {
+            if (this != &other)
+            {
+                fseqFileNameDel(&_value);
+                _value = other._value;
+                fseqFileNameInit(&other._value);
+            }
+            return *this;
+        }
+
+        FileName(const FileName&) = delete;
+        FileName& operator = (const FileName&) = delete;
+
+        ~FileName()
+        {
+            fseqFileNameDel(&_value);
+        }
+
+        std::string_view path() const noexcept { return view(_value.path); }
+        std::string_view base() const noexcept { return view(_value.base); }
+        std::string_view number() const noexcept { return view(_value.number); }
+        std::string_view extension() const noexcept { return view(_value.extension); }
+
+        const FSeqFileName& get() const noexcept { return _value; }
+
+    private:
+        FSeqFileName _value;
+    };
+
+    // This class provides an owned set of frame numbers.
+    class FrameSet
+    {
+    public:
+        FrameSet() noexcept
+        {
+            fseqFrameSetInit(&_value);
+        }
+
+        FrameSet(FrameSet&& other) noexcept :
+            _error(std::exchange(other._error, false))
+        {
+            _value = other._value;
+            fseqFrameSetInit(&other._value);
+        }
+
+        FrameSet& operator = (FrameSet&& other) noexcept
+        {
+            if (this != &other)
+            {
+                fseqFrameSetDel(&_value);
+                _value = other._value;
+                fseqFrameSetInit(&other._value);
+                _error = std::exchange(other._error, false);
+            }
+            return *this;
+        }
+
+        FrameSet(const FrameSet&) = delete;
+        FrameSet& operator = (const FrameSet&) = delete;
+
+        ~FrameSet()
+        {
+            fseqFrameSetDel(&_value);
+        }
+
+        // Get the frames of a directory entry.
+        static FrameSet frames(const FSeqDirEntry* entry)
+        {
+            FrameSet out;
+            out._error = !fseqDirEntryFrames(entry, &out._value);
+            return out;
+        }
+
+        // Whether any errors occurred creating the set. The set operators
+        // return an empty set with the error flag if memory could not be
+        // allocated.
+        bool error() const noexcept { return _error; }
+
+        bool add(int64_t frame) { return fseqFrameSetAdd(&_value, frame) != FSEQ_FALSE; }
+        bool add(int64_t min, int64_t max) { return fseqFrameSetAddRange(&_value, min, max) != FSEQ_FALSE; }
+        bool contains(int64_t frame) const noexcept { return fseqFrameSetContains(&_value, frame) != FSEQ_FALSE; }
+        int64_t count() const noexcept { return fseqFrameSetCount(&_value); }
+        bool empty() const noexcept { return 0 == count(); }
+
+        // Call a function for each frame in the set.
+        template<typename T>
+        void forEach(T&& function) const
+        {
+            int64_t frame = 0;
+            for (bool i = fseqFrameSetNext(&_value, INT64_MIN, &frame) != FSEQ_FALSE; i;
+                i = frame < INT64_MAX && fseqFrameSetNext(&_value, frame + 1, &frame) != FSEQ_FALSE)
+            {
+                function(frame);
+            }
+        }
+
+        FrameSet operator | (const FrameSet& other) const
+        {
+            FrameSet out;
+            out._error = !fseqFrameSetUnion(&_value, &other._value, &out._value);
+            return out;
+        }
+
+        FrameSet operator & (const FrameSet& other) const
+        {
+            FrameSet out;
+            out._error = !fseqFrameSetIntersection(&_value, &other._value, &out._value);
+            return out;
+        }
+
+        FrameSet operator - (const FrameSet& other) const
+        {
+            FrameSet out;
+            out._error = !fseqFrameSetDifference(&_value, &other._value, &out._value);
+            return out;
+        }
+
+        const FSeqFrameSet& get() const noexcept { return _value; }
+
+    private:
+        FSeqFrameSet _value;
+        bool         _error = false;
+    };
+
+    // This class provides a non-owning view of a directory entry.
+    class DirEntry
+    {
+    public:
+        DirEntry() noexcept = default;
+
+        explicit DirEntry(const FSeqDirEntry* value) noexcept :
+            _value(value)
+        {}
+
+        // The components are returned from the original file name if the
+        // entry was listed without splitting the file names.
+        std::string_view path() const noexcept
+        {
+            return _value->fileName.path || !_value->name ?
+                view(_value->fileName.path) :
+                std::string_view(_value->name, _value->sizes.path);
+        }
+
+        std::string_view base() const noexcept
+        {
+            return _value->fileName.base || !_value->name ?
+                view(_value->fileName.base) :
+                std::string_view(_value->name + _value->sizes.path, _value->sizes.base);
+        }
+
+        std::string_view number() const noexcept
+        {
+            return _value->fileName.number || !_value->name ?
+                view(_value->fileName.number) :
+                std::string_view(
+                    _value->name + _value->sizes.path + _value->sizes.base,
+                    _value->sizes.number);
+        }
+
+        std::string_view extension() const noexcept
+        {
+            return _value->fileName.extension || !_value->name ?
+                view(_value->fileName.extension) :
+                std::string_view(
+                    _value->name + _value->sizes.path + _value->sizes.base + _value->sizes.number,
+                    _value->sizes.extension);
+        }
+
+        FSeqFileType type() const noexcept { return _value->type; }
+        bool isDir() const noexcept { return FSEQ_FILE_TYPE_DIR == _value->type; }
+
+        int64_t frameMin() const noexcept { return _value->frameMin; }
+        int64_t frameMax() const noexcept { return _value->frameMax; }
+        uint8_t framePadding() const noexcept { return _value->framePadding; }
+        int64_t frameCount() const noexcept { return _value->frameCount; }
+
+        // Whether the entry is a sequence of frames.
+        bool isSequence() const noexcept { return !number().empty(); }
+
+        // Convert the entry to a string.
+        std::string toString(bool path = false) const
+        {
+            char buf[FSEQ_STRING_LEN];
+            fseqDirEntryToString(_value, buf, path ? FSEQ_TRUE : FSEQ_FALSE, FSEQ_STRING_LEN);
+            return std::string(buf);
+        }
+
+        const FSeqDirEntry* get() const noexcept { return _value; }
+
+    private:
+        const FSeqDirEntry* _value = nullptr;
+    };
+
+    // This class provides a forward iterator over a list of directory
+    // entries.
+    class DirIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = DirEntry;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const DirEntry*;
+        using reference         = const DirEntry&;
+
+        DirIterator() noexcept = default;
+
+        explicit DirIterator(const FSeqDirEntry* value) noexcept :
+            _entry(value)
+        {}
+
+        reference operator * () const noexcept { return _entry; }
+        pointer operator -> () const noexcept { return &_entry; }
+
+        DirIterator& operator ++ () noexcept
+        {
+            _entry = DirEntry(_entry.get()->next);
+            return *this;
+        }
+
+        DirIterator operator ++ (int) noexcept
+        {
+            DirIterator out = *this;
+            ++(*this);
+            return out;
+        }
+
+        bool operator == (const DirIterator& other) const noexcept { return _entry.get() == other._entry.get(); }
+        bool operator != (const DirIterator& other) const noexcept { return _entry.get() != other._entry.get(); }
+
+    private:
+        DirEntry _entry;
+    };
+
+    // This class provides an owned list of directory entries. The list is
+    // deleted with fseqDirListDel() when the object is destroyed.
+    class DirList
+    {
+    public:
+        DirList() noexcept = default;
+
+        // Take ownership of a list.
+        explicit DirList(FSeqDirEntry* value, bool error = false) noexcept :
+            _value(value),
+            _error(error)
+        {}
+
+        DirList(DirList&& other) noexcept :
+            _value(std::exchange(other._value, nullptr)),
+            _error(std::exchange(other._error, false))
+        {}
+
+        DirList& operator = (DirList&& other) noexcept
+        {
+            if (this != &other)
+            {
+                fseqDirListDel(_value);
+                _value = std::exchange(other._value, nullptr);
+                _error = std::exchange(other._error, false);
+            }
+            return *this;
+        }
+
+        DirList(const DirList&) = delete;
+        DirList& operator = (const DirList&) = delete;
+
+        ~DirList()
+        {
+            fseqDirListDel(_value);
+        }
+
+        // List the contents of a directory.
+        static DirList list(const char* path, const FSeqDirOptions* options = nullptr)
+        {
+            FSeqBool error = FSEQ_FALSE;
+            FSeqDirEntry* value = fseqDirList(path, options, &error);
+            return DirList(value, error != FSEQ_FALSE);
+        }
+
+        // Parse a file sequence string.
+        static DirList parse(std::string_view value, const FSeqFileNameOptions* options = nullptr)
+        {
+            FSeqBool error = FSEQ_FALSE;
+            FSeqDirEntry* out = fseqDirEntryParse(value.data(), value.size(), options, &error);
+            return DirList(out, error != FSEQ_FALSE);
+        }
+
+        // Whether any errors occurred creating the list.
+        bool error() const noexcept { return _error; }
+
+        bool empty() const noexcept { return !_value; }
+
+        size_t size() const noexcept
+        {
+            size_t out = 0;
+            for (const FSeqDirEntry* i = _value; i; i = i->next)
+            {
+                ++out;
+            }
+            return out;
+        }
+
+        DirIterator begin() const noexcept { return DirIterator(_value); }
+        DirIterator end() const noexcept { return DirIterator(); }
+
+        const FSeqDirEntry* get() const noexcept { return _value; }
+
+        // Release ownership of the list.
+        FSeqDirEntry* release() noexcept
+        {
+            return std::exchange(_value, nullptr);
+        }
+
+    private:
+        FSeqDirEntry* _value = nullptr;
+        bool          _error = false;
+    };
+
+} // namespace fseq
+
+#endif // FSEQ_HPP
@@ -4,11 +4,14 @@
 
 #include "fseq.h"
 
+#include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#if defined(WIN32)
+#if defined(WIN32) || defined(_WIN32)
+#include <direct.h>
 #define FSEQ_SNPRINTF sprintf_s
 FILE* _fopen(const char* fileName, const char* mode)
 {
@@ -16,13 +19,14 @@ FILE* _fopen(const char* fileName, const char* mode)
     fopen_s(&out, fileName, mode);
     return out;
 }
-#else
+#else // WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #define FSEQ_SNPRINTF snprintf
-FILE* _fopen(const char* fileName, const char* mode)
-{
-    return fopen(fileName, mode);
-}
-#endif
+#endif // WIN32
 
 static const char fileNames[][FSEQ_STRING_LEN] =
 {
@@ -32,43 +36,428 @@ static const char fileNames[][FSEQ_STRING_LEN] =
 };
 static const size_t fileNamesSize = sizeof(fileNames) / sizeof(fileNames[0]);
 
-int randInt(int max)
+// The random numbers are generated with SplitMix64 instead of rand(), so the
+// same seed creates the same files on every platform.
+uint64_t randNext(uint64_t* state)
 {
-    return (int)(max * (rand() / (float)RAND_MAX));
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
 }
 
-int main(int argc, char** argv)
+// Get a random number from zero to max - 1 without modulo bias.
+int64_t randInt(uint64_t* state, int64_t max)
+{
+    const uint64_t range = (uint64_t)max;
+    const uint64_t limit = range ? UINT64_MAX - UINT64_MAX % range : 0;
+    uint64_t       value = 0;
+    if (max <= 0)
+    {
+        return 0;
+    }
+    do
+    {
+        value = randNext(state);
+    }
+    while (value >= limit);
+    return (int64_t)(value % range);
+}
+
+// This struct provides the options.
+struct Options
+{
+    uint64_t seed;
+    size_t   threads;
+    int      gaps;
+    int      padding;
+    FSeqBool negative;
+    size_t   dirs;
+    int64_t  size;
+};
+
+// This struct provides a sequence to create. The names and frames are
+// chosen before the files are created, so the result does not depend on
+// the number of threads.
+struct Sequence
+{
+    size_t   dir;
+    char     name[64];
+    int64_t  frame;
+    int64_t  count;
+    uint64_t state;
+};
+
+// This struct provides the state shared by the threads.
+struct Create
 {
-    int fileCount = 0;
-    int seqCount  = 0;
+    const struct Options* options;
+    char**                dirs;
+    struct Sequence*      sequences;
+    size_t                sequenceCount;
+#if !defined(WIN32) && !defined(_WIN32)
+    atomic_size_t         next;
+    atomic_int            result;
+#else // WIN32
+    size_t                next;
+    int                   result;
+#endif // WIN32
+};
 
-    if (argc != 4)
+// Create the files of a sequence. Frames are skipped at random to make gaps,
+// so the last frame is later than the frame count implies.
+FSeqBool createSequence(struct Create* create, struct Sequence* sequence)
+{
+    const struct Options* options = create->options;
+    char                  buf[FSEQ_STRING_LEN];
+    int64_t               frame   = sequence->frame;
+    FSeqBool              result  = FSEQ_TRUE;
+#if defined(WIN32) || defined(_WIN32)
+    const char*           dir     = create->dirs[sequence->dir];
+#else // WIN32
+    const int             dir     = open(create->dirs[sequence->dir], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (-1 == dir)
     {
-        printf("usage: fseqCreateRandom (directory) (total file count) (sequence count)\n");
-        return 1;
+        fprintf(stderr, "cannot open %s\n", create->dirs[sequence->dir]);
+        return FSEQ_FALSE;
     }
-    fileCount = atoi(argv[2]);
-    seqCount  = atoi(argv[3]);
+#endif // WIN32
 
-    for (size_t i = 0; i < seqCount; ++i)
+    for (int64_t i = 0; i < sequence->count && result; ++i, ++frame)
     {
-        static char seq[FSEQ_STRING_LEN];
-        int frame = 0;
-        FSEQ_SNPRINTF(seq, FSEQ_STRING_LEN, fileNames[randInt((int)fileNamesSize - 1)], randInt(100), randInt(100));
-        frame = randInt(1000);
-        for (size_t j = 0; j < fileCount / seqCount; ++j, ++frame)
+        while (options->gaps > 0 && randInt(&sequence->state, 100) < options->gaps)
+        {
+            ++frame;
+        }
+#if defined(WIN32) || defined(_WIN32)
         {
-            static char buf[FSEQ_STRING_LEN];
             FILE* f = NULL;
-            FSEQ_SNPRINTF(buf, FSEQ_STRING_LEN, "%s/%s.%d.tif", argv[1], seq, frame);
+            FSEQ_SNPRINTF(
+                buf,
+                FSEQ_STRING_LEN,
+                "%s/%s.%0*" PRId64 ".tif",
+                dir,
+                sequence->name,
+                options->padding,
+                frame);
             f = _fopen(buf, "w");
             if (!f)
             {
-                printf("cannot create %s\n", buf);
-                return 1;
+                fprintf(stderr, "cannot create %s\n", buf);
+                result = FSEQ_FALSE;
+                break;
+            }
+            if (options->size > 0)
+            {
+                _fseeki64(f, options->size - 1, SEEK_SET);
+                fputc(0, f);
             }
             fclose(f);
         }
+#else // WIN32
+        {
+            int fd = -1;
+            FSEQ_SNPRINTF(
+                buf,
+                FSEQ_STRING_LEN,
+                "%s.%0*" PRId64 ".tif",
+                sequence->name,
+                options->padding,
+                frame);
+            fd = openat(dir, buf, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (-1 == fd)
+            {
+                fprintf(stderr, "cannot create %s/%s\n", create->dirs[sequence->dir], buf);
+                result = FSEQ_FALSE;
+                break;
+            }
+
+            // The size is set without writing any data, so the files are
+            // sparse where the file system supports it.
+            if (options->size > 0 && ftruncate(fd, (off_t)options->size) != 0)
+            {
+                fprintf(stderr, "cannot resize %s/%s\n", create->dirs[sequence->dir], buf);
+                result = FSEQ_FALSE;
+            }
+            close(fd);
+        }
+#endif // WIN32
+    }
+
+#if !defined(WIN32) && !defined(_WIN32)
+    close(dir);
+#endif // WIN32
+    return result;
+}
+
+// Add the name of a sequence to a hash table of the names in each
+// directory. The table has a power of two size, larger than the number of
+// sequences, and holds the sequence indices plus one.
+// Returns:
+// * Whether the name was added, or false if another sequence in the same
+//   directory has the same name
+FSeqBool addName(size_t* table, size_t size, const struct Sequence* sequences, size_t index)
+{
+    const struct Sequence* sequence = &sequences[index];
+    size_t                 i        = (size_t)fseqHash64(
+        sequence->name,
+        strlen(sequence->name),
+        (uint64_t)sequence->dir) & (size - 1);
+    for (; table[i]; i = (i + 1) & (size - 1))
+    {
+        const struct Sequence* other = &sequences[table[i] - 1];
+        if (other->dir == sequence->dir && 0 == strcmp(other->name, sequence->name))
+        {
+            return FSEQ_FALSE;
+        }
+    }
+    table[i] = index + 1;
+    return FSEQ_TRUE;
+}
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+void* createThread(void* data)
+{
+    struct Create* create = (struct Create*)data;
+    size_t         i      = 0;
+    while ((i = atomic_fetch_add(&create->next, 1)) < create->sequenceCount)
+    {
+        if (!createSequence(create, &create->sequences[i]))
+        {
+            atomic_store(&create->result, 1);
+        }
+    }
+    return NULL;
+}
+
+#endif // WIN32
+
+// Create a directory, it is not an error if it already exists.
+FSeqBool makeDir(const char* path)
+{
+#if defined(WIN32) || defined(_WIN32)
+    return 0 == _mkdir(path) || EEXIST == errno;
+#else // WIN32
+    return 0 == mkdir(path, 0755) || EEXIST == errno;
+#endif // WIN32
+}
+
+void printUsage()
+{
+    printf("usage: fseqCreateRandom [-seed n] [-j threads] [-gaps percent] [-pad digits]\n");
+    printf("                        [-neg] [-dirs count] [-size bytes]\n");
+    printf("                        (directory) (total file count) (sequence count)\n");
+    printf("Create empty files in random sequences, for example as benchmark fixtures.\n");
+    printf("The same seed and options always create the same files.\n");
+    printf("  -seed  The random seed (default 0)\n");
+    printf("  -j     The number of threads (default 16)\n");
+    printf("  -gaps  The percentage of frames to skip, making gaps in the sequences\n");
+    printf("  -pad   The number of digits to pad the frame numbers to (default 0)\n");
+    printf("  -neg   Allow the sequences to start at negative frame numbers\n");
+    printf("  -dirs  The number of nested directories to spread the sequences over\n");
+    printf("  -size  The size of each file; the files are sparse where supported\n");
+}
+
+int main(int argc, char** argv)
+{
+    struct Options   options;
+    struct Create    create;
+    struct Sequence* sequences = NULL;
+    char**           dirs      = NULL;
+    size_t*          names     = NULL;
+    size_t           namesSize = 1;
+    int64_t          fileCount = 0;
+    int64_t          seqCount  = 0;
+    uint64_t         state     = 0;
+    int              result    = 0;
+    int              i         = 1;
+
+    memset(&options, 0, sizeof(struct Options));
+    options.threads = 16;
+    options.dirs    = 1;
+
+    // Parse the command line options.
+    for (; i < argc && '-' == argv[i][0] && argv[i][1]; ++i)
+    {
+        if (0 == strcmp(argv[i], "-seed") && i + 1 < argc)
+        {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "-j") && i + 1 < argc)
+        {
+            options.threads = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "-gaps") && i + 1 < argc)
+        {
+            const int value = atoi(argv[++i]);
+            options.gaps = FSEQ_MIN(value, 90);
+        }
+        else if (0 == strcmp(argv[i], "-pad") && i + 1 < argc)
+        {
+            const int value = atoi(argv[++i]);
+            options.padding = FSEQ_MIN(value, 20);
+        }
+        else if (0 == strcmp(argv[i], "-neg"))
+        {
+            options.negative = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-dirs") && i + 1 < argc)
+        {
+            const size_t value = (size_t)strtoul(argv[++i], NULL, 10);
+            options.dirs = FSEQ_MAX(value, 1);
+        }
+        else if (0 == strcmp(argv[i], "-size") && i + 1 < argc)
+        {
+            options.size = strtoll(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (argc - i != 3)
+    {
+        printUsage();
+        return 1;
+    }
+    fileCount = strtoll(argv[i + 1], NULL, 10);
+    seqCount  = strtoll(argv[i + 2], NULL, 10);
+    if (fileCount < 0 || seqCount <= 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    while (namesSize < (size_t)seqCount * 2)
+    {
+        namesSize *= 2;
+    }
+    sequences = (struct Sequence*)calloc((size_t)seqCount, sizeof(struct Sequence));
+    dirs      = (char**)calloc(options.dirs, sizeof(char*));
+    names     = (size_t*)calloc(namesSize, sizeof(size_t));
+    if (!sequences || !dirs || !names)
+    {
+        fprintf(stderr, "out of memory\n");
+        free(sequences);
+        free(dirs);
+        free(names);
+        return 1;
+    }
+
+    // Create the directories. Each directory after the first is placed in a
+    // random earlier one, making a tree.
+    state = options.seed;
+    dirs[0] = (char*)malloc(strlen(argv[i]) + 1);
+    if (dirs[0])
+    {
+        memcpy(dirs[0], argv[i], strlen(argv[i]) + 1);
+    }
+    for (size_t j = 1; j < options.dirs && dirs[j - 1]; ++j)
+    {
+        const char* parent = dirs[randInt(&state, (int64_t)j)];
+        const size_t len   = strlen(parent) + 32;
+        dirs[j] = (char*)malloc(len);
+        if (dirs[j])
+        {
+            FSEQ_SNPRINTF(dirs[j], len, "%s/dir%zu", parent, j);
+        }
+    }
+    for (size_t j = 0; j < options.dirs; ++j)
+    {
+        if (!dirs[j] || !makeDir(dirs[j]))
+        {
+            fprintf(stderr, "cannot create %s\n", dirs[j] ? dirs[j] : argv[i]);
+            result = 1;
+            break;
+        }
+    }
+
+    // Choose the sequences. The files are divided evenly, and any remainder
+    // goes to the first sequences. Sequences in the same directory must have
+    // different names, otherwise their frames would overwrite each other;
+    // a name is chosen again if it is already used, and if that keeps
+    // failing the sequence number is added to the name.
+    for (int64_t j = 0; j < seqCount && 0 == result; ++j)
+    {
+        struct Sequence* sequence = &sequences[j];
+        sequence->dir   = (size_t)randInt(&state, (int64_t)options.dirs);
+        for (int tries = 0;; ++tries)
+        {
+            const int64_t shot  = randInt(&state, 100);
+            const int64_t scene = randInt(&state, 100);
+            const int     len   = FSEQ_SNPRINTF(
+                sequence->name,
+                sizeof(sequence->name),
+                fileNames[randInt(&state, (int64_t)fileNamesSize)],
+                (int)shot,
+                (int)scene);
+            if (tries >= 100 && len > 0)
+            {
+                FSEQ_SNPRINTF(
+                    sequence->name + len,
+                    sizeof(sequence->name) - (size_t)len,
+                    "_%" PRId64,
+                    j);
+            }
+            if (addName(names, namesSize, sequences, (size_t)j))
+            {
+                break;
+            }
+        }
+        sequence->frame = options.negative ? randInt(&state, 2000) - 1000 : randInt(&state, 1000);
+        sequence->count = fileCount / seqCount + (j < fileCount % seqCount ? 1 : 0);
+        sequence->state = randNext(&state);
+    }
+
+    // Create the files.
+    memset(&create, 0, sizeof(struct Create));
+    create.options       = &options;
+    create.dirs          = dirs;
+    create.sequences     = sequences;
+    create.sequenceCount = (size_t)seqCount;
+    if (0 == result)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        for (size_t j = 0; j < create.sequenceCount; ++j)
+        {
+            if (!createSequence(&create, &sequences[j]))
+            {
+                result = 1;
+                break;
+            }
+        }
+#else // WIN32
+        pthread_t* threads = NULL;
+        size_t     started = 0;
+        atomic_init(&create.next, 0);
+        atomic_init(&create.result, 0);
+        options.threads = FSEQ_MAX(FSEQ_MIN(options.threads, create.sequenceCount), 1);
+        threads = (pthread_t*)malloc(options.threads * sizeof(pthread_t));
+        for (; threads && started + 1 < options.threads; ++started)
+        {
+            if (pthread_create(&threads[started], NULL, createThread, &create) != 0)
+            {
+                break;
+            }
+        }
+        createThread(&create);
+        for (size_t j = 0; j < started; ++j)
+        {
+            pthread_join(threads[j], NULL);
+        }
+        free(threads);
+        result = atomic_load(&create.result);
+#endif // WIN32
+    }
+
+    for (size_t j = 0; j < options.dirs; ++j)
+    {
+        free(dirs[j]);
     }
-    return 0;
+    free(dirs);
+    free(names);
+    free(sequences);
+    return result;
 }
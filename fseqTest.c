@@ -18,6 +18,10 @@
 #define WIN32_LEAN_AND_MEAN
 #endif // WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else // WIN32
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
 #endif
 
 #if defined(WIN32) || defined(_WIN32)
@@ -513,6 +517,2275 @@ void test15()
     fseqDirListDel(entry);
 }
 
+void test16()
+{
+    const char* const testData[][4] =
+    {
+        { "render.0001-0100.exr", "render.", "0001-0100", ".exr" },
+        { "/tmp/render.1-100.exr", "render.", "1-100", ".exr" },
+        { "render.0042.exr", "render.", "0042", ".exr" },
+        { "render-0001-0100.exr", "render-", "0001-0100", ".exr" },
+        { "render.####.exr", "render.", "####", ".exr" },
+        { "render.%04d.exr", "render.", "####", ".exr" },
+        { "render.%04d.exr 1-100", "render.", "0001-0100", ".exr" },
+        { "render.#.exr 5-10", "render.", "5-10", ".exr" },
+        { "render.exr", "render", "", ".exr" },
+        { "render 1.exr", "render ", "1", ".exr" }
+    };
+    const size_t testDataSize = sizeof(testData) / sizeof(testData[0]);
+    char buf[FSEQ_STRING_LEN];
+    char buf2[FSEQ_STRING_LEN];
+
+    for (size_t i = 0; i < testDataSize; ++i)
+    {
+        FSeqBool error = FSEQ_FALSE;
+        struct FSeqDirEntry* entry = fseqDirEntryParse(testData[i][0], FSEQ_STRING_LEN, NULL, &error);
+        assert(entry != NULL);
+        assert(NULL == entry->next);
+        assert(FSEQ_FALSE == error);
+        assert(0 == strcmp(entry->fileName.base, testData[i][1]));
+        assert(0 == strcmp(entry->fileName.extension, testData[i][3]));
+        fseqDirEntryToString(entry, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+        snprintf(buf2, FSEQ_STRING_LEN, "%s%s%s", testData[i][1], testData[i][2], testData[i][3]);
+        printf("\"%s\": \"%s\"\n", testData[i][0], buf);
+        assert(0 == strcmp(buf, buf2));
+        fseqDirListDel(entry);
+    }
+
+    // Padding notation without frame ranges has no frames, and is not
+    // removed or copied.
+    const char* const patterns[] = { "render.####.exr", "render.%04d.exr" };
+    for (size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i)
+    {
+        FSeqBool error = FSEQ_FALSE;
+        struct FSeqDirEntry* entry = fseqDirEntryParse(patterns[i], FSEQ_STRING_LEN, NULL, &error);
+        assert(entry != NULL);
+        assert(FSEQ_FALSE == error);
+        assert(0 == entry->frameCount);
+        assert(4 == entry->framePadding);
+
+        struct FSeqFrameSet frames;
+        fseqFrameSetInit(&frames);
+        const FSeqBool ok = fseqDirEntryFrames(entry, &frames);
+        assert(ok);
+        assert(0 == fseqFrameSetCount(&frames));
+        fseqFrameSetDel(&frames);
+
+        struct FSeqRemoveOptions removeOptions;
+        struct FSeqRemoveResult removeResult;
+        fseqRemoveOptionsInit(&removeOptions);
+        removeOptions.dryRun = FSEQ_TRUE;
+        const FSeqBool removed = fseqRemove("tests", entry, &removeResult, &removeOptions, &error);
+        assert(!removed);
+        assert(error);
+
+        error = FSEQ_FALSE;
+        const FSeqBool copied = fseqCopy("tests", entry, "tests", NULL, &error);
+        assert(!copied);
+        assert(error);
+        fseqDirListDel(entry);
+    }
+}
+
+void test17()
+{
+    struct FSeqDirEntry* entry = NULL;
+    struct FSeqFileNameOptions options;
+    char buf[FSEQ_STRING_LEN];
+
+    entry = fseqDirEntryParse("/tmp/render.1-10,0020-0030,40.exr", FSEQ_STRING_LEN, NULL, NULL);
+    assert(entry != NULL);
+    assert(0 == strcmp(entry->fileName.path, "/tmp/"));
+    assert(1 == entry->frameMin && 10 == entry->frameMax && 4 == entry->framePadding);
+    assert(entry->next != NULL);
+    assert(20 == entry->next->frameMin && 30 == entry->next->frameMax);
+    assert(entry->next->next != NULL);
+    assert(40 == entry->next->next->frameMin && 40 == entry->next->next->frameMax);
+    assert(NULL == entry->next->next->next);
+    fseqDirEntryToString(entry->next, buf, FSEQ_TRUE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "/tmp/render.0020-0030.exr"));
+    fseqDirListDel(entry);
+
+    fseqFileNameOptionsInit(&options);
+    options.negativeNumbers = FSEQ_TRUE;
+    entry = fseqDirEntryParse("render.-10--1.exr", FSEQ_STRING_LEN, &options, NULL);
+    assert(entry != NULL);
+    assert(-10 == entry->frameMin && -1 == entry->frameMax);
+    fseqDirListDel(entry);
+
+    entry = fseqDirEntryParse("render.1-2,.exr", FSEQ_STRING_LEN, NULL, NULL);
+    assert(entry != NULL);
+    assert(0 == strcmp(entry->fileName.base, "render.1-2,"));
+    assert(0 == strcmp(entry->fileName.number, ""));
+    fseqDirListDel(entry);
+
+    entry = fseqDirEntryParse("", FSEQ_STRING_LEN, NULL, NULL);
+    assert(NULL == entry);
+}
+
+void test18()
+{
+    const char* in[] =
+    {
+        "a.1-10.exr",
+        "b.%04d.exr 1-5,7-9",
+        "",
+        "c.exr"
+    };
+    const size_t count = sizeof(in) / sizeof(in[0]);
+    struct FSeqDirEntry* out[4];
+    FSeqBool error = FSEQ_FALSE;
+    size_t parsed = 0;
+
+    parsed = fseqDirEntryParseBatch(in, count, out, FSEQ_STRING_LEN, NULL, &error);
+    assert(4 == parsed);
+    assert(FSEQ_FALSE == error);
+    assert(1 == out[0]->frameMin && 10 == out[0]->frameMax);
+    assert(1 == out[1]->frameMin && 5 == out[1]->frameMax && 4 == out[1]->framePadding);
+    assert(7 == out[1]->next->frameMin && 9 == out[1]->next->frameMax);
+    assert(NULL == out[2]);
+    assert(0 == strcmp(out[3]->fileName.base, "c"));
+    for (size_t i = 0; i < count; ++i)
+    {
+        fseqDirListDel(out[i]);
+    }
+}
+
+void test19()
+{
+    struct FSeqDirEntry* entry = NULL;
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test19");
+    fseqTouch("tests/test19/seq.1.exr");
+    fseqTouch("tests/test19/seq.2.exr");
+    fseqTouch("tests/test19/seq.5.exr");
+    fseqTouch("tests/test19/file");
+    entry = fseqDirList("tests/test19", NULL, NULL);
+    assert(entry != NULL);
+
+    size_t matches = 0;
+    for (const struct FSeqDirEntry* i = entry; i != NULL; i = i->next)
+    {
+        if (0 == strcmp(i->fileName.base, "seq."))
+        {
+            assert(1 == i->frameMin);
+            assert(5 == i->frameMax);
+            assert(3 == i->frameCount);
+            ++matches;
+        }
+        else if (0 == strcmp(i->fileName.base, "file"))
+        {
+            assert(1 == i->frameCount);
+            ++matches;
+        }
+    }
+    assert(2 == matches);
+
+    fseqDirListDel(entry);
+}
+
+void test20()
+{
+    struct FSeqDirEntry* entry = NULL;
+    struct FSeqDirOptions options;
+    char buf[FSEQ_STRING_LEN];
+
+    fseqDirOptionsInit(&options);
+    options.splitFileNames = FSEQ_FALSE;
+    fseqMkdir("tests");
+    fseqMkdir("tests/test20");
+    fseqTouch("tests/test20/seq.0001.exr");
+    fseqTouch("tests/test20/seq.0002.exr");
+    fseqTouch("tests/test20/seq.0003.exr");
+    fseqTouch("tests/test20/file.txt");
+    entry = fseqDirList("tests/test20", &options, NULL);
+    assert(entry != NULL);
+
+    size_t matches = 0;
+    for (struct FSeqDirEntry* i = entry; i != NULL; i = i->next)
+    {
+        assert(NULL == i->fileName.base);
+        assert(i->name != NULL);
+        fseqDirEntryToString(i, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+        if (0 == strcmp(buf, "seq.0001-0003.exr"))
+        {
+            assert(4 == i->sizes.base);
+            assert(4 == i->sizes.number);
+            const FSeqBool split = fseqDirEntrySplit(i);
+            assert(FSEQ_TRUE == split);
+            assert(0 == strcmp(i->fileName.base, "seq."));
+            assert(0 == strcmp(i->fileName.extension, ".exr"));
+            fseqDirEntryToString(i, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+            assert(0 == strcmp(buf, "seq.0001-0003.exr"));
+            ++matches;
+        }
+        else if (0 == strcmp(buf, "file.txt"))
+        {
+            ++matches;
+        }
+    }
+    assert(2 == matches);
+
+    fseqDirListDel(entry);
+}
+
+void test21()
+{
+    struct FSeqDirEntry* entry = NULL;
+    char buf[FSEQ_STRING_LEN];
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test21");
+    fseqTouch("tests/test21/seq.1.exr");
+    fseqTouch("tests/test21/seq.2.exr");
+    fseqMkdir("tests/test21/seq.3.exr");
+    fseqMkdir("tests/test21/dir.1");
+    fseqMkdir("tests/test21/dir.2");
+    entry = fseqDirList("tests/test21", NULL, NULL);
+    assert(entry != NULL);
+
+    size_t matches = 0;
+    for (const struct FSeqDirEntry* i = entry; i != NULL; i = i->next)
+    {
+        fseqDirEntryToString(i, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+        if (0 == strcmp(buf, "seq.1-2.exr"))
+        {
+            assert(FSEQ_FILE_TYPE_FILE == i->type);
+            ++matches;
+        }
+        else if (0 == strcmp(buf, "seq.3.exr") ||
+            0 == strcmp(buf, "dir.1") ||
+            0 == strcmp(buf, "dir.2"))
+        {
+            assert(FSEQ_FILE_TYPE_DIR == i->type);
+            ++matches;
+        }
+    }
+    assert(4 == matches);
+
+    fseqDirListDel(entry);
+}
+
+void test22()
+{
+    struct FSeqDirEntry entry;
+    FSeqBool error = FSEQ_FALSE;
+    FSeqBool found = FSEQ_FALSE;
+    char buf[FSEQ_STRING_LEN];
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test22");
+    fseqTouch("tests/test22/render.0001.exr");
+    fseqTouch("tests/test22/render.0002.exr");
+    fseqTouch("tests/test22/render.0042.exr");
+    fseqTouch("tests/test22/render.0003.tif");
+    fseqTouch("tests/test22/render2.0004.exr");
+    fseqTouch("tests/test22/render.exr");
+    fseqMkdir("tests/test22/render.0100.exr");
+
+    fseqDirEntryInit(&entry);
+    found = fseqDirFindSequence("tests/test22/render.0042.exr", &entry, NULL, &error);
+    assert(FSEQ_TRUE == found);
+    assert(FSEQ_FALSE == error);
+    assert(1 == entry.frameMin);
+    assert(42 == entry.frameMax);
+    assert(4 == entry.framePadding);
+    assert(3 == entry.frameCount);
+    assert(FSEQ_FILE_TYPE_FILE == entry.type);
+    fseqDirEntryToString(&entry, buf, FSEQ_TRUE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "tests/test22/render.0001-0042.exr"));
+    fseqDirEntryDel(&entry);
+
+    fseqDirEntryInit(&entry);
+    found = fseqDirFindSequence("tests/test22/render.exr", &entry, NULL, &error);
+    assert(FSEQ_TRUE == found);
+    assert(1 == entry.frameCount);
+    fseqDirEntryDel(&entry);
+
+    fseqDirEntryInit(&entry);
+    found = fseqDirFindSequence("tests/test22/missing.0001.exr", &entry, NULL, &error);
+    assert(FSEQ_FALSE == found);
+    assert(FSEQ_FALSE == error);
+    found = fseqDirFindSequence("tests/dir4/render.0001.exr", &entry, NULL, &error);
+    assert(FSEQ_FALSE == found);
+    assert(FSEQ_TRUE == error);
+    fseqDirEntryDel(&entry);
+}
+
+void test23()
+{
+    struct FSeqFrameSet a;
+    struct FSeqFrameSet b;
+    struct FSeqFrameSet c;
+    int64_t frame = 0;
+    int64_t count = 0;
+    FSeqBool ok = FSEQ_FALSE;
+
+    fseqFrameSetInit(&a);
+    fseqFrameSetInit(&b);
+    fseqFrameSetInit(&c);
+    assert(0 == fseqFrameSetCount(&a));
+    ok = fseqFrameSetNext(&a, INT64_MIN, &frame);
+    assert(FSEQ_FALSE == ok);
+
+    ok = fseqFrameSetAddRange(&a, 1, 100);
+    assert(ok);
+    ok = fseqFrameSetAdd(&a, -10);
+    assert(ok);
+    ok = fseqFrameSetAdd(&a, 1000);
+    assert(ok);
+    assert(102 == fseqFrameSetCount(&a));
+    assert(fseqFrameSetContains(&a, -10));
+    assert(fseqFrameSetContains(&a, 64));
+    assert(!fseqFrameSetContains(&a, 0));
+    assert(!fseqFrameSetContains(&a, 101));
+    assert(!fseqFrameSetContains(&a, 100000));
+
+    ok = fseqFrameSetNext(&a, INT64_MIN, &frame);
+    assert(ok && -10 == frame);
+    ok = fseqFrameSetNext(&a, frame + 1, &frame);
+    assert(ok && 1 == frame);
+    ok = fseqFrameSetNext(&a, 101, &frame);
+    assert(ok && 1000 == frame);
+    ok = fseqFrameSetNext(&a, 1001, &frame);
+    assert(!ok);
+    for (FSeqBool i = fseqFrameSetNext(&a, INT64_MIN, &frame); i;
+        i = frame < INT64_MAX && fseqFrameSetNext(&a, frame + 1, &frame))
+    {
+        ++count;
+    }
+    assert(102 == count);
+
+    ok = fseqFrameSetAddRange(&b, 50, 200);
+    assert(ok);
+    ok = fseqFrameSetIntersection(&a, &b, &c);
+    assert(ok);
+    assert(51 == fseqFrameSetCount(&c));
+    ok = fseqFrameSetNext(&c, INT64_MIN, &frame);
+    assert(ok && 50 == frame);
+    ok = fseqFrameSetUnion(&a, &b, &c);
+    assert(ok);
+    assert(202 == fseqFrameSetCount(&c));
+    ok = fseqFrameSetDifference(&a, &b, &c);
+    assert(ok);
+    assert(51 == fseqFrameSetCount(&c));
+    assert(!fseqFrameSetContains(&c, 50));
+    assert(fseqFrameSetContains(&c, 49));
+    assert(fseqFrameSetContains(&c, 1000));
+
+    // The output may be one of the inputs.
+    ok = fseqFrameSetDifference(&c, &c, &c);
+    assert(ok);
+    assert(0 == fseqFrameSetCount(&c));
+    assert(0 == c.wordCount);
+    ok = fseqFrameSetUnion(&a, &b, &a);
+    assert(ok);
+    assert(202 == fseqFrameSetCount(&a));
+
+    fseqFrameSetDel(&a);
+    fseqFrameSetDel(&b);
+    fseqFrameSetDel(&c);
+}
+
+void test24()
+{
+    struct FSeqDirEntry* entry = NULL;
+    struct FSeqDirOptions options;
+    struct FSeqFrameSet frames;
+    int64_t frame = 0;
+    FSeqBool ok = FSEQ_FALSE;
+
+    fseqDirOptionsInit(&options);
+    options.frames = FSEQ_TRUE;
+    fseqMkdir("tests");
+    fseqMkdir("tests/test24");
+    fseqTouch("tests/test24/seq.1.exr");
+    fseqTouch("tests/test24/seq.2.exr");
+    fseqTouch("tests/test24/seq.5.exr");
+    fseqTouch("tests/test24/seq.70.exr");
+    entry = fseqDirList("tests/test24", &options, NULL);
+    assert(entry != NULL);
+    assert(NULL == entry->next);
+    assert(4 == fseqFrameSetCount(&entry->frames));
+    assert(!fseqFrameSetContains(&entry->frames, 3));
+
+    fseqFrameSetInit(&frames);
+    ok = fseqDirEntryFrames(entry, &frames);
+    assert(ok);
+    assert(4 == fseqFrameSetCount(&frames));
+    ok = fseqFrameSetNext(&frames, 6, &frame);
+    assert(ok && 70 == frame);
+    fseqDirListDel(entry);
+
+    entry = fseqDirEntryParse("seq.1-10,20-30.exr", FSEQ_STRING_LEN, NULL, NULL);
+    ok = fseqDirEntryFrames(entry->next, &frames);
+    assert(ok);
+    assert(11 == fseqFrameSetCount(&frames));
+    fseqDirListDel(entry);
+
+    entry = fseqDirEntryParse("file.exr", FSEQ_STRING_LEN, NULL, NULL);
+    ok = fseqDirEntryFrames(entry, &frames);
+    assert(ok);
+    assert(0 == fseqFrameSetCount(&frames));
+    fseqDirListDel(entry);
+    fseqFrameSetDel(&frames);
+}
+
+void test25()
+{
+#if !defined(WIN32) && !defined(_WIN32)
+    struct FSeqAsync* async = NULL;
+    struct FSeqDirEntry* entry = NULL;
+    struct pollfd pfd;
+    uint64_t ids[3];
+    uint64_t id = 0;
+    FSeqBool error = FSEQ_FALSE;
+    FSeqBool ok = FSEQ_FALSE;
+    int count = 0;
+    int ready = 0;
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test25");
+    fseqTouch("tests/test25/seq.1.exr");
+    fseqTouch("tests/test25/seq.2.exr");
+    fseqTouch("tests/test25/seq.3.exr");
+
+    async = fseqAsyncCreate(2, &error);
+    assert(async != NULL);
+    assert(!error);
+    assert(fseqAsyncFd(async) != -1);
+    ok = fseqAsyncPoll(async, &id, &entry, NULL);
+    assert(!ok);
+
+    ids[0] = fseqAsyncSubmit(async, "tests/test25", NULL);
+    ids[1] = fseqAsyncSubmit(async, "tests/test25", NULL);
+    ids[2] = fseqAsyncSubmit(async, "tests/doesNotExist", NULL);
+    assert(ids[0] && ids[1] && ids[2]);
+    while (count < 3)
+    {
+        pfd.fd = fseqAsyncFd(async);
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        ready = poll(&pfd, 1, -1);
+        assert(1 == ready);
+        while (fseqAsyncPoll(async, &id, &entry, &error))
+        {
+            if (ids[2] == id)
+            {
+                assert(error);
+                assert(NULL == entry);
+            }
+            else
+            {
+                assert(entry != NULL);
+                assert(NULL == entry->next);
+                assert(3 == entry->frameCount);
+            }
+            error = FSEQ_FALSE;
+            fseqDirListDel(entry);
+            ++count;
+        }
+    }
+    pfd.revents = 0;
+    ready = poll(&pfd, 1, 0);
+    assert(0 == ready);
+
+    id = fseqAsyncSubmit(async, "tests/test25", NULL);
+    fseqAsyncCancel(async, id);
+    ok = fseqAsyncCancel(async, id + 1);
+    assert(!ok);
+
+    fseqAsyncDel(async);
+#endif // WIN32
+}
+
+void test26()
+{
+    struct FSeqDirOptions options;
+    struct FSeqGroup* group = NULL;
+    struct FSeqDirEntry* entries = NULL;
+    struct FSeqDirEntry* entry = NULL;
+    const char* paths = "/a/render.0001.exr\n/b/render.0001.exr\n/a/render.0002.exr\n/a/dir5\n/a/render.0010.exr";
+    const char* p = paths;
+    char buf[FSEQ_STRING_LEN];
+    FSeqBool error = FSEQ_FALSE;
+    FSeqBool ok = FSEQ_FALSE;
+
+    fseqDirOptionsInit(&options);
+    options.splitFileNames = FSEQ_FALSE;
+    group = fseqGroupCreate(&options, &error);
+    assert(group != NULL);
+    assert(!error);
+    while (*p)
+    {
+        const char* end = strchr(p, '\n');
+        if (!end)
+        {
+            end = p + strlen(p);
+        }
+        ok = fseqGroupAdd(
+            group,
+            p,
+            end - p,
+            0 == strncmp(p, "/a/dir5", end - p) ? FSEQ_FILE_TYPE_DIR : FSEQ_FILE_TYPE_FILE);
+        assert(ok);
+        p = *end ? end + 1 : end;
+    }
+    ok = fseqGroupAdd(group, paths, 0, FSEQ_FILE_TYPE_FILE);
+    assert(!ok);
+    ok = fseqGroupAdd(group, paths, FSEQ_STRING_LEN, FSEQ_FILE_TYPE_FILE);
+    assert(!ok);
+
+    entries = fseqGroupList(group, &error);
+    assert(!error);
+    entry = entries;
+    fseqDirEntryToString(entry, buf, FSEQ_TRUE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "/a/render.0001-0010.exr"));
+    assert(3 == entry->frameCount);
+    entry = entry->next;
+    fseqDirEntryToString(entry, buf, FSEQ_TRUE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "/b/render.0001.exr"));
+    entry = entry->next;
+    assert(FSEQ_FILE_TYPE_DIR == entry->type);
+    assert(NULL == entry->next);
+    fseqDirListDel(entries);
+
+    // The group is reset after getting the list.
+    ok = fseqGroupAdd(group, "x.1.exr", 7, FSEQ_FILE_TYPE_FILE);
+    assert(ok);
+    entries = fseqGroupList(group, NULL);
+    assert(entries != NULL && NULL == entries->next);
+    fseqDirListDel(entries);
+    fseqGroupDel(group);
+}
+
+void test27()
+{
+    const char* text = "Nobody inspects the spammish repetition";
+    struct FSeqDirEntry* entry = NULL;
+    struct FSeqChecksumOptions options;
+    struct FSeqChecksums checksums;
+    char buf[FSEQ_STRING_LEN];
+    uint64_t digest = 0;
+    FILE* f = NULL;
+    FSeqBool error = FSEQ_FALSE;
+    FSeqBool ok = FSEQ_FALSE;
+
+    // XXH64 test vectors.
+    assert(0xef46db3751d8e999ull == fseqHash64("", 0, 0));
+    assert(0x44bc2cf5ad770999ull == fseqHash64("abc", 3, 0));
+    assert(0xfbcea83c8a378bf1ull == fseqHash64(text, strlen(text), 0));
+
+    entry = fseqDirEntryParse("render.%04d.exr 9-11", FSEQ_STRING_LEN, NULL, NULL);
+    ok = fseqDirEntryFrameName(entry, 10, FSEQ_FALSE, buf, FSEQ_STRING_LEN);
+    assert(ok);
+    assert(0 == strcmp(buf, "render.0010.exr"));
+    ok = fseqDirEntryFrameName(entry, -10, FSEQ_FALSE, buf, FSEQ_STRING_LEN);
+    assert(ok);
+    assert(0 == strcmp(buf, "render.-010.exr"));
+    ok = fseqDirEntryFrameName(entry, 10, FSEQ_FALSE, buf, 15);
+    assert(!ok);
+    fseqDirListDel(entry);
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test27");
+    f = fopen("tests/test27/seq.1.txt", "w");
+    fputs(text, f);
+    fclose(f);
+    fseqTouch("tests/test27/seq.2.txt");
+    entry = fseqDirList("tests/test27", NULL, NULL);
+    assert(entry != NULL && NULL == entry->next);
+
+    fseqChecksumOptionsInit(&options);
+    options.threads = 1;
+    fseqChecksumsInit(&checksums);
+    ok = fseqChecksum("tests/test27", entry, &checksums, &options, &error);
+    assert(ok);
+    assert(!error);
+    assert(2 == checksums.frameCount);
+    assert(1 == checksums.frames[0].frame);
+    assert(0xfbcea83c8a378bf1ull == checksums.frames[0].digest);
+    assert(0xef46db3751d8e999ull == checksums.frames[1].digest);
+    digest = checksums.digest;
+
+    // The sequence digest does not depend on the number of threads.
+    options.threads = 4;
+    options.bufferSize = 1;
+    ok = fseqChecksum("tests/test27", entry, &checksums, &options, NULL);
+    assert(ok);
+    assert(digest == checksums.digest);
+
+    // Missing frames are reported.
+    entry->frameMax = 3;
+    ok = fseqChecksum("tests/test27", entry, &checksums, &options, &error);
+    assert(!ok);
+    assert(error);
+    assert(3 == checksums.frameCount);
+    assert(!checksums.frames[1].error);
+    assert(checksums.frames[2].error);
+
+    fseqChecksumsDel(&checksums);
+    fseqDirListDel(entry);
+}
+
+FSeqBool fseqExists(const char* fileName)
+{
+    FILE* f = fopen(fileName, "r");
+    if (f)
+    {
+        fclose(f);
+        return FSEQ_TRUE;
+    }
+    return FSEQ_FALSE;
+}
+
+void test28()
+{
+    struct FSeqDirOptions dirOptions;
+    struct FSeqCopyOptions options;
+    struct FSeqDirEntry* entry = NULL;
+    char buf[FSEQ_STRING_LEN];
+    FILE* f = NULL;
+    FSeqBool error = FSEQ_FALSE;
+    FSeqBool ok = FSEQ_FALSE;
+    int read = 0;
+    int i = 0;
+
+    fseqDirOptionsInit(&dirOptions);
+    dirOptions.frames = FSEQ_TRUE;
+    fseqMkdir("tests");
+    fseqMkdir("tests/test28");
+    fseqMkdir("tests/test28/a");
+    fseqMkdir("tests/test28/b");
+    for (i = 1; i <= 100; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/b/seq.%04d.exr", i);
+        remove(buf);
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/b/seq.%06d.exr", i);
+        remove(buf);
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/a/seq.%04d.exr", i);
+        f = fopen(buf, "w");
+        fprintf(f, "%d", i);
+        fclose(f);
+    }
+
+    // Copy with new padding.
+    entry = fseqDirList("tests/test28/a", &dirOptions, NULL);
+    fseqCopyOptionsInit(&options);
+    options.framePadding = 6;
+    options.threads = 4;
+    ok = fseqCopy("tests/test28/a", entry, "tests/test28/b", &options, &error);
+    assert(ok);
+    assert(!error);
+    assert(fseqExists("tests/test28/b/seq.000001.exr"));
+    assert(fseqExists("tests/test28/b/seq.000100.exr"));
+    assert(fseqExists("tests/test28/a/seq.0001.exr"));
+
+    // Copying again fails without the overwrite option.
+    ok = fseqCopy("tests/test28/a", entry, "tests/test28/b", &options, &error);
+    assert(!ok);
+    assert(error);
+    error = FSEQ_FALSE;
+    options.overwrite = FSEQ_TRUE;
+    ok = fseqCopy("tests/test28/a", entry, "tests/test28/b", &options, NULL);
+    assert(ok);
+
+    // Copying over overlapping frames fails without the overwrite option.
+    fseqCopyOptionsInit(&options);
+    options.frameOffset = 50;
+    ok = fseqCopy("tests/test28/a", entry, NULL, &options, NULL);
+    assert(!ok);
+    assert(!fseqExists("tests/test28/a/seq.0101.exr"));
+
+    // Renumber overlapping frames in place.
+    ok = fseqMove("tests/test28/a", entry, NULL, &options, &error);
+    assert(ok);
+    assert(!error);
+    fseqDirListDel(entry);
+    entry = fseqDirList("tests/test28/a", &dirOptions, NULL);
+    assert(entry != NULL && NULL == entry->next);
+    assert(51 == entry->frameMin);
+    assert(150 == entry->frameMax);
+    assert(100 == entry->frameCount);
+    f = fopen("tests/test28/a/seq.0051.exr", "r");
+    read = fscanf(f, "%d", &i);
+    assert(1 == read);
+    assert(1 == i);
+    fclose(f);
+
+    // Renumber back down.
+    options.frameOffset = -50;
+    ok = fseqMove("tests/test28/a", entry, NULL, &options, NULL);
+    assert(ok);
+    fseqDirListDel(entry);
+    entry = fseqDirList("tests/test28/a", &dirOptions, NULL);
+    assert(1 == entry->frameMin && 100 == entry->frameMax && 100 == entry->frameCount);
+    f = fopen("tests/test28/a/seq.0100.exr", "r");
+    read = fscanf(f, "%d", &i);
+    assert(1 == read);
+    assert(100 == i);
+    fclose(f);
+
+    // Move to another directory.
+    fseqCopyOptionsInit(&options);
+    options.overwrite = FSEQ_TRUE;
+    ok = fseqMove("tests/test28/a", entry, "tests/test28/b", &options, NULL);
+    assert(ok);
+    assert(!fseqExists("tests/test28/a/seq.0001.exr"));
+    assert(fseqExists("tests/test28/b/seq.0001.exr"));
+    fseqDirListDel(entry);
+
+    // A frame that cannot be given its new name moves every frame back.
+    fseqMkdir("tests/test28/c");
+    for (i = 1; i <= 6; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/c/.fseqtmp.seq.%04d.exr", i);
+        remove(buf);
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/c/seq.%04d.exr", i);
+        f = fopen(buf, "w");
+        fprintf(f, "%d", i);
+        fclose(f);
+    }
+    entry = fseqDirEntryParse("tests/test28/c/seq.0001-0005.exr", FSEQ_STRING_LEN, NULL, NULL);
+    fseqCopyOptionsInit(&options);
+    options.frameOffset = 1;
+    ok = fseqMove(NULL, entry, NULL, &options, &error);
+    assert(!ok);
+    assert(error);
+    error = FSEQ_FALSE;
+    for (int j = 1; j <= 6; ++j)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/c/seq.%04d.exr", j);
+        f = fopen(buf, "r");
+        assert(f);
+        read = fscanf(f, "%d", &i);
+        assert(1 == read);
+        assert(j == i);
+        fclose(f);
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/c/.fseqtmp.seq.%04d.exr", j);
+        assert(!fseqExists(buf));
+    }
+    fseqDirListDel(entry);
+
+    // A move to another directory that fails part way moves every frame
+    // back.
+    fseqMkdir("tests/test28/d");
+    fseqMkdir("tests/test28/e");
+    for (i = 1; i <= 5; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/d/seq.%04d.exr", i);
+        f = fopen(buf, "w");
+        fprintf(f, "%d", i);
+        fclose(f);
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/e/seq.%04d.exr", i);
+        remove(buf);
+    }
+    f = fopen("tests/test28/e/seq.0003.exr", "w");
+    fprintf(f, "%d", 99);
+    fclose(f);
+    entry = fseqDirEntryParse("tests/test28/d/seq.0001-0005.exr", FSEQ_STRING_LEN, NULL, NULL);
+    fseqCopyOptionsInit(&options);
+    ok = fseqMove(NULL, entry, "tests/test28/e", &options, &error);
+    assert(!ok);
+    assert(error);
+    error = FSEQ_FALSE;
+    for (int j = 1; j <= 5; ++j)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/d/seq.%04d.exr", j);
+        f = fopen(buf, "r");
+        assert(f);
+        read = fscanf(f, "%d", &i);
+        assert(1 == read);
+        assert(j == i);
+        fclose(f);
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test28/e/seq.%04d.exr", j);
+        assert(fseqExists(buf) == (3 == j));
+    }
+    f = fopen("tests/test28/e/seq.0003.exr", "r");
+    read = fscanf(f, "%d", &i);
+    assert(1 == read);
+    assert(99 == i);
+    fclose(f);
+    fseqDirListDel(entry);
+}
+
+void test29()
+{
+    struct FSeqDirOptions dirOptions;
+    struct FSeqRemoveOptions options;
+    struct FSeqRemoveResult result;
+    struct FSeqDirEntry* entry = NULL;
+    char buf[FSEQ_STRING_LEN];
+    FSeqBool error = FSEQ_FALSE;
+    FSeqBool ok = FSEQ_FALSE;
+    int i = 0;
+
+    fseqDirOptionsInit(&dirOptions);
+    dirOptions.frames = FSEQ_TRUE;
+    fseqMkdir("tests");
+    fseqMkdir("tests/test29");
+    for (i = 1; i <= 200; ++i)
+    {
+        if (i != 50)
+        {
+            snprintf(buf, FSEQ_STRING_LEN, "tests/test29/seq.%d.exr", i);
+            fseqTouch(buf);
+        }
+    }
+
+    // Dry run.
+    entry = fseqDirEntryParse("tests/test29/seq.1-200.exr", FSEQ_STRING_LEN, NULL, NULL);
+    fseqRemoveOptionsInit(&options);
+    options.dryRun = FSEQ_TRUE;
+    ok = fseqRemove(NULL, entry, &result, &options, &error);
+    assert(ok);
+    assert(!error);
+    assert(199 == result.removed);
+    assert(1 == result.missing);
+    assert(0 == result.failed);
+    assert(fseqExists("tests/test29/seq.1.exr"));
+    fseqDirListDel(entry);
+
+    // Remove the listed frames.
+    entry = fseqDirList("tests/test29", &dirOptions, NULL);
+    assert(entry != NULL && NULL == entry->next);
+    options.dryRun = FSEQ_FALSE;
+    options.threads = 4;
+    ok = fseqRemove("tests/test29", entry, &result, &options, NULL);
+    assert(ok);
+    assert(199 == result.removed);
+    assert(0 == result.missing);
+    assert(!fseqExists("tests/test29/seq.1.exr"));
+    assert(!fseqExists("tests/test29/seq.200.exr"));
+    fseqDirListDel(entry);
+    entry = fseqDirList("tests/test29", NULL, NULL);
+    assert(NULL == entry);
+}
+
+// Compare two directory lists, returns the number of entries.
+int fseqDirListCompare(const struct FSeqDirEntry* a, const struct FSeqDirEntry* b)
+{
+    int count = 0;
+    for (; a && b; a = a->next, b = b->next, ++count)
+    {
+        char bufA[FSEQ_STRING_LEN];
+        char bufB[FSEQ_STRING_LEN];
+        fseqDirEntryToString(a, bufA, FSEQ_FALSE, FSEQ_STRING_LEN);
+        fseqDirEntryToString(b, bufB, FSEQ_FALSE, FSEQ_STRING_LEN);
+        assert(0 == strcmp(bufA, bufB));
+        assert(a->type == b->type);
+        assert(a->frameMin == b->frameMin);
+        assert(a->frameMax == b->frameMax);
+        assert(a->framePadding == b->framePadding);
+        assert(a->frameCount == b->frameCount);
+        assert(a->frames.wordCount == b->frames.wordCount);
+    }
+    assert(NULL == a && NULL == b);
+    return count;
+}
+
+void test30()
+{
+    struct FSeqDirOptions options;
+    struct FSeqDirEntry* entry = NULL;
+    struct FSeqDirEntry* decoded = NULL;
+    void* buf = NULL;
+    size_t size = 0;
+    size_t encoded = 0;
+    FSeqBool error = FSEQ_FALSE;
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test30");
+    fseqTouch("tests/test30/file");
+    fseqTouch("tests/test30/seq.1.exr");
+    fseqTouch("tests/test30/seq.2.exr");
+    fseqTouch("tests/test30/seq.4.exr");
+    fseqTouch("tests/test30/seq.0001.tiff");
+
+    // Encode and decode a list.
+    fseqDirOptionsInit(&options);
+    options.frames = FSEQ_TRUE;
+    entry = fseqDirList("tests/test30", &options, &error);
+    assert(!error);
+    size = fseqDirListEncode(entry, NULL, 0);
+    assert(size > 0);
+    buf = malloc(size);
+    encoded = fseqDirListEncode(entry, buf, size);
+    assert(encoded == size);
+    decoded = fseqDirListDecode(buf, size, FSEQ_TRUE, &error);
+    assert(!error);
+    assert(3 == fseqDirListCompare(entry, decoded));
+    assert(fseqFrameSetContains(&decoded->next->frames, 4) ||
+        fseqFrameSetContains(&decoded->frames, 4));
+    fseqDirListDel(decoded);
+    decoded = fseqDirListDecode(buf, size - 1, FSEQ_FALSE, &error);
+    assert(error);
+    fseqDirListDel(decoded);
+    free(buf);
+    fseqDirListDel(entry);
+
+#if !defined(WIN32) && !defined(_WIN32)
+    {
+        struct FSeqDaemon* daemon = NULL;
+        struct FSeqDaemon* other = NULL;
+        struct FSeqDaemonClient* client = NULL;
+        int i = 0;
+
+        // List through the daemon.
+        error = FSEQ_FALSE;
+        daemon = fseqDaemonCreate("tests/test30.sock", NULL, &error);
+        assert(daemon);
+        assert(!error);
+        other = fseqDaemonCreate("tests/test30.sock", NULL, &error);
+        assert(NULL == other);
+        assert(error);
+        error = FSEQ_FALSE;
+        client = fseqDaemonConnect("tests/test30.sock", &error);
+        assert(client);
+        entry = fseqDirList("tests/test30", NULL, NULL);
+        for (i = 0; i < 2; ++i)
+        {
+            decoded = fseqDaemonList(client, "tests/test30", NULL, &error);
+            assert(!error);
+            assert(3 == fseqDirListCompare(entry, decoded));
+            fseqDirListDel(decoded);
+        }
+        fseqDirListDel(entry);
+        decoded = fseqDaemonList(client, "tests/test30/missing", NULL, &error);
+        assert(error);
+        assert(NULL == decoded);
+        error = FSEQ_FALSE;
+
+        // Changes to the directory invalidate the cached listing.
+        fseqTouch("tests/test30/file2");
+        for (i = 0; i < 100; ++i)
+        {
+            int count = 0;
+            decoded = fseqDaemonList(client, "tests/test30", NULL, &error);
+            assert(!error);
+            for (entry = decoded; entry; entry = entry->next)
+            {
+                ++count;
+            }
+            fseqDirListDel(decoded);
+            if (4 == count)
+            {
+                break;
+            }
+            usleep(10000);
+        }
+        assert(i < 100);
+        remove("tests/test30/file2");
+
+        fseqDaemonDisconnect(client);
+        fseqDaemonDel(daemon);
+        client = fseqDaemonConnect("tests/test30.sock", &error);
+        assert(NULL == client);
+        assert(error);
+    }
+#endif // WIN32
+}
+
+void test31()
+{
+    struct FSeqIndex* index = NULL;
+    struct FSeqIndexQuery query;
+    struct FSeqIndexResult results[16];
+    struct FSeqDirEntry* list = NULL;
+    char buf[FSEQ_STRING_LEN];
+    FSeqBool error = FSEQ_FALSE;
+    FSeqBool ok = FSEQ_FALSE;
+    size_t count = 0;
+    int i = 0;
+
+    index = fseqIndexCreate(&error);
+    assert(index);
+    assert(!error);
+
+    // Add a listed directory.
+    fseqMkdir("tests");
+    fseqMkdir("tests/test31");
+    fseqTouch("tests/test31/Shot010_comp_v002.1.exr");
+    fseqTouch("tests/test31/Shot010_comp_v002.2.exr");
+    fseqTouch("tests/test31/shot010_plate.1.dpx");
+    fseqTouch("tests/test31/notes.txt");
+    list = fseqDirList("tests/test31", NULL, NULL);
+    ok = fseqIndexAdd(index, "tests/test31", list);
+    assert(ok);
+    assert(3 == fseqIndexSize(index));
+
+    // Add many small lists, so the runs are merged.
+    for (i = 0; i < 100; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "seq%03d_light.1-10.%s", i, i % 2 ? "exr" : "tif");
+        list = fseqDirEntryParse(buf, FSEQ_STRING_LEN, NULL, NULL);
+        ok = fseqIndexAdd(index, "parsed", list);
+        assert(ok);
+    }
+    assert(103 == fseqIndexSize(index));
+
+    // Prefix searches are sorted and case insensitive.
+    fseqIndexQueryInit(&query);
+    query.text = "SHOT010";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(2 == count);
+    assert(0 == strcmp(results[0].path, "tests/test31"));
+    fseqDirEntryToString(results[0].entry, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "Shot010_comp_v002.1-2.exr"));
+    fseqDirEntryToString(results[1].entry, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "shot010_plate.1.dpx"));
+    query.text = "seq05";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(10 == count);
+    for (i = 0; i < 10; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "seq%03d_light.", 50 + i);
+        assert(0 == strncmp(results[i].entry->fileName.base, buf, strlen(buf)));
+    }
+    query.text = "";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(16 == count);
+    query.text = "zzz";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(0 == count);
+
+    // Extension filters.
+    query.text = "shot";
+    query.extensions = ".DPX";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(1 == count);
+    query.text = "seq";
+    query.extensions = "exr,jpg";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(16 == count);
+    count = fseqIndexFind(index, &query, results, 0);
+    assert(0 == count);
+    query.extensions = NULL;
+
+    // Word searches.
+    query.match = FSEQ_INDEX_MATCH_WORD;
+    query.text = "comp";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(1 == count);
+    query.text = "010";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(3 == count);
+    query.text = "v002";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(1 == count);
+    query.text = "light";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(16 == count);
+    query.text = "s";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(16 == count);
+    for (i = 1; i < 16; ++i)
+    {
+        assert(results[i].entry != results[0].entry);
+    }
+    query.text = "omp";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(0 == count);
+
+    // Substring searches.
+    query.match = FSEQ_INDEX_MATCH_SUBSTRING;
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(1 == count);
+    query.text = "_LIG";
+    query.extensions = "tif";
+    count = fseqIndexFind(index, &query, results, 16);
+    assert(16 == count);
+    fseqDirEntryToString(results[0].entry, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "seq000_light.1-10.tif"));
+
+    fseqIndexDel(index);
+}
+
+// Count the entries in a directory list.
+size_t fseqDirListCount(const struct FSeqDirEntry* value)
+{
+    size_t out = 0;
+    for (; value; value = value->next)
+    {
+        ++out;
+    }
+    return out;
+}
+
+void test32()
+{
+    struct FSeqDirOptions options;
+    struct FSeqDirCursor* cursor = NULL;
+    struct FSeqDirEntry* entry = NULL;
+    struct FSeqThrottle* throttle = NULL;
+    struct FSeqDirEntry find;
+#if !defined(WIN32) && !defined(_WIN32)
+    struct FSeqAsync* async = NULL;
+    uint64_t id = 0;
+    FSeqBool collected = FSEQ_FALSE;
+#endif // WIN32
+    char buf[FSEQ_STRING_LEN];
+    FSeqBool partial = FSEQ_TRUE;
+    FSeqBool found = FSEQ_FALSE;
+    FSeqBool error = FSEQ_FALSE;
+    int64_t frameCount = 0;
+    int64_t frameSetCount = 0;
+    int partialSteps = 0;
+    int i = 0;
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test32");
+    for (i = 1; i <= 2000; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test32/seq.%d.exr", i);
+        fseqTouch(buf);
+    }
+    fseqTouch("tests/test32/file");
+
+    // List in steps until the listing is complete. Each step returns the
+    // entries listed so far. The directory reads are throttled so the
+    // timeout expires before the listing is complete.
+    throttle = fseqThrottleCreate(1000.0, 1.0, &error);
+    assert(throttle);
+    fseqDirOptionsInit(&options);
+    options.frames = FSEQ_TRUE;
+    options.timeout = 1;
+    options.throttle = throttle;
+    cursor = fseqDirCursorCreate("tests/test32", &options, &error);
+    assert(cursor);
+    assert(!error);
+    for (i = 0; partial && i < 100000; ++i)
+    {
+        int64_t count = 0;
+        entry = fseqDirCursorList(cursor, &partial, &error);
+        assert(!error);
+        frameSetCount = 0;
+        for (const struct FSeqDirEntry* e = entry; e; e = e->next)
+        {
+            count += e->frameCount;
+            if (e->frameCount > 1)
+            {
+                assert(fseqFrameSetCount(&e->frames) == e->frameCount);
+            }
+            frameSetCount += fseqFrameSetCount(&e->frames);
+        }
+        assert(count >= frameCount);
+        frameCount = count;
+        if (partial)
+        {
+            ++partialSteps;
+        }
+        else
+        {
+            assert(2 == fseqDirListCount(entry));
+        }
+        fseqDirListDel(entry);
+    }
+    assert(!partial);
+    assert(partialSteps > 0);
+    assert(2001 == frameCount);
+    assert(2000 == frameSetCount);
+
+    // The complete listing is returned again, including the frames.
+    entry = fseqDirCursorList(cursor, &partial, &error);
+    assert(!partial);
+    assert(2 == fseqDirListCount(entry));
+    frameSetCount = 0;
+    for (const struct FSeqDirEntry* e = entry; e; e = e->next)
+    {
+        frameSetCount += fseqFrameSetCount(&e->frames);
+    }
+    assert(2000 == frameSetCount);
+    fseqDirListDel(entry);
+    fseqDirCursorDel(cursor);
+
+    // A listing that stops at the timeout is flagged as partial, which is
+    // not an error.
+    options.partial = &partial;
+    partial = FSEQ_FALSE;
+    entry = fseqDirList("tests/test32", &options, &error);
+    assert(!error);
+    assert(partial);
+    assert(entry);
+    fseqDirListDel(entry);
+    partial = FSEQ_FALSE;
+    fseqDirEntryInit(&find);
+    found = fseqDirFindSequence("tests/test32/seq.1.exr", &find, &options, &error);
+    assert(!error);
+    assert(partial);
+    assert(!found || find.frameCount < 2000);
+    fseqDirEntryDel(&find);
+#if !defined(WIN32) && !defined(_WIN32)
+    partial = FSEQ_FALSE;
+    async = fseqAsyncCreate(1, &error);
+    assert(async);
+    id = fseqAsyncSubmit(async, "tests/test32", &options);
+    assert(id);
+    for (i = 0; i < 10000; ++i)
+    {
+        collected = fseqAsyncPoll(async, NULL, &entry, &error);
+        if (collected)
+        {
+            break;
+        }
+        usleep(1000);
+    }
+    assert(collected);
+    assert(!error);
+    assert(partial);
+    fseqDirListDel(entry);
+    fseqAsyncDel(async);
+#endif // WIN32
+    fseqThrottleDel(throttle);
+    options.throttle = NULL;
+
+    cursor = fseqDirCursorCreate("tests/test32/missing", NULL, &error);
+    assert(NULL == cursor);
+    assert(error);
+
+    // Without a timeout the listing is complete.
+    error = FSEQ_FALSE;
+    options.timeout = 0;
+    entry = fseqDirList("tests/test32", &options, &error);
+    assert(!error);
+    assert(!partial);
+    assert(2 == fseqDirListCount(entry));
+    fseqDirListDel(entry);
+}
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+// Wait for the prefetcher to prefetch a number of frames.
+int64_t fseqPrefetchWait(struct FSeqPrefetch* prefetch, int64_t frames)
+{
+    struct FSeqPrefetchStats stats;
+    int i = 0;
+    for (; i < 1000; ++i)
+    {
+        fseqPrefetchStats(prefetch, &stats);
+        if (stats.frames + stats.failed >= frames)
+        {
+            break;
+        }
+        usleep(1000);
+    }
+
+    // Check that no more frames are prefetched.
+    usleep(20000);
+    fseqPrefetchStats(prefetch, &stats);
+    return stats.frames + stats.failed;
+}
+
+#endif // WIN32
+
+void test33()
+{
+#if !defined(WIN32) && !defined(_WIN32)
+    struct FSeqDirOptions dirOptions;
+    struct FSeqPrefetchOptions options;
+    struct FSeqPrefetchStats stats;
+    struct FSeqPrefetch* prefetch = NULL;
+    struct FSeqDirEntry* entry = NULL;
+    char buf[FSEQ_STRING_LEN];
+    FSeqBool error = FSEQ_FALSE;
+    int64_t frames = 0;
+    int i = 0;
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test33");
+    for (i = 1; i <= 100; ++i)
+    {
+        if (i != 50)
+        {
+            snprintf(buf, FSEQ_STRING_LEN, "tests/test33/seq.%04d.exr", i);
+            fseqTouch(buf);
+        }
+    }
+    fseqDirOptionsInit(&dirOptions);
+    dirOptions.frames = FSEQ_TRUE;
+    entry = fseqDirList("tests/test33", &dirOptions, NULL);
+    assert(entry && NULL == entry->next);
+
+    // Prefetch ahead of the playhead.
+    fseqPrefetchOptionsInit(&options);
+    options.window = 8;
+    options.lead = 0;
+    prefetch = fseqPrefetchCreate("tests/test33", entry, &options, &error);
+    assert(prefetch);
+    assert(!error);
+    fseqPrefetchUpdate(prefetch, 1, 1);
+    frames = fseqPrefetchWait(prefetch, 8);
+    assert(8 == frames);
+    fseqPrefetchUpdate(prefetch, 2, 1);
+    frames = fseqPrefetchWait(prefetch, 9);
+    assert(9 == frames);
+
+    // Seeking skips the queued frames, and the missing frame is skipped.
+    fseqPrefetchUpdate(prefetch, 45, 1);
+    frames = fseqPrefetchWait(prefetch, 16);
+    assert(16 == frames);
+    fseqPrefetchUpdate(prefetch, 45, -1);
+    frames = fseqPrefetchWait(prefetch, 24);
+    assert(24 == frames);
+    fseqPrefetchStats(prefetch, &stats);
+    assert(2 == stats.seeks);
+    assert(0 == stats.failed);
+
+    // Playing every second frame continues with every second frame once
+    // the stride repeats.
+    fseqPrefetchUpdate(prefetch, 60, 1);
+    frames = fseqPrefetchWait(prefetch, 32);
+    assert(32 == frames);
+    fseqPrefetchUpdate(prefetch, 62, 1);
+    frames = fseqPrefetchWait(prefetch, 34);
+    assert(34 == frames);
+    fseqPrefetchUpdate(prefetch, 64, 1);
+    frames = fseqPrefetchWait(prefetch, 42);
+    assert(42 == frames);
+
+    // A single skipped frame does not change the stride.
+    fseqPrefetchUpdate(prefetch, 67, 1);
+    frames = fseqPrefetchWait(prefetch, 44);
+    assert(44 == frames);
+    fseqPrefetchUpdate(prefetch, 69, 1);
+    frames = fseqPrefetchWait(prefetch, 45);
+    assert(45 == frames);
+    fseqPrefetchStats(prefetch, &stats);
+    assert(3 == stats.seeks);
+
+    // Prefetching stops at the end of the sequence.
+    fseqPrefetchUpdate(prefetch, 96, 1);
+    frames = fseqPrefetchWait(prefetch, 49);
+    assert(49 == frames);
+    fseqPrefetchStats(prefetch, &stats);
+    assert(4 == stats.seeks);
+    fseqPrefetchDel(prefetch);
+
+    // The window grows with the rate of playback.
+    options.lead = 1000;
+    prefetch = fseqPrefetchCreate("tests/test33", entry, &options, NULL);
+    for (i = 1; i <= 5; ++i)
+    {
+        fseqPrefetchUpdate(prefetch, i, 1);
+        usleep(10000);
+    }
+    fseqPrefetchStats(prefetch, &stats);
+    assert(stats.window > 8);
+    assert(stats.window <= options.maxWindow);
+    fseqPrefetchDel(prefetch);
+
+    fseqDirListDel(entry);
+#endif // WIN32
+}
+
+void test34()
+{
+#if !defined(WIN32) && !defined(_WIN32)
+    struct FSeqCacheOptions options;
+    struct FSeqCacheStats stats;
+    struct FSeqCache* cache = NULL;
+    struct FSeqCacheSequence* sequence = NULL;
+    struct FSeqDirEntry* entry = NULL;
+    const struct FSeqCacheFrame* frame = NULL;
+    const struct FSeqCacheFrame* held = NULL;
+    char buf[FSEQ_STRING_LEN];
+    char data[10000];
+    FSeqBool error = FSEQ_FALSE;
+    int64_t hits = 0;
+    int i = 0;
+    int j = 0;
+
+    // Each frame is filled with its frame number.
+    fseqMkdir("tests");
+    fseqMkdir("tests/test34");
+    for (i = 1; i <= 10; ++i)
+    {
+        FILE* f = NULL;
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test34/seq.%04d.exr", i);
+        f = fopen(buf, "wb");
+        memset(data, i, sizeof(data));
+        fwrite(data, 1, (size_t)i * 1000, f);
+        fclose(f);
+    }
+    entry = fseqDirList("tests/test34", NULL, NULL);
+    assert(entry && NULL == entry->next);
+
+    for (j = 0; j < 2; ++j)
+    {
+        fseqCacheOptionsInit(&options);
+        options.maxBytes = 20000;
+        options.shards = 4;
+        options.map = 0 == j;
+        cache = fseqCacheCreate(&options, &error);
+        assert(cache);
+        assert(!error);
+        sequence = fseqCacheAddSequence(cache, "tests/test34", entry, &error);
+        assert(sequence);
+
+        // Read a frame and read it again from the cache.
+        frame = fseqCacheGet(cache, sequence, 3, &error);
+        assert(frame);
+        assert(3000 == frame->size);
+        assert(3 == ((const char*)frame->data)[2999]);
+        fseqCacheRelease(cache, frame);
+        frame = fseqCacheGet(cache, sequence, 3, &error);
+        assert(frame);
+        fseqCacheRelease(cache, frame);
+        fseqCacheStats(cache, &stats);
+        assert(1 == stats.hits);
+        assert(1 == stats.misses);
+        assert(3000 == stats.bytes);
+        assert(1 == stats.frames);
+
+        // Frames in use remain valid when they are removed from the cache.
+        held = fseqCacheGet(cache, sequence, 10, NULL);
+        for (i = 1; i <= 9; ++i)
+        {
+            frame = fseqCacheGet(cache, sequence, i, &error);
+            assert(frame);
+            assert((size_t)i * 1000 == frame->size);
+            assert(i == ((const char*)frame->data)[0]);
+            fseqCacheRelease(cache, frame);
+        }
+        fseqCacheStats(cache, &stats);
+        assert(stats.bytes <= options.maxBytes);
+        assert(stats.evictions > 0);
+        assert(10000 == held->size);
+        assert(10 == ((const char*)held->data)[9999]);
+        fseqCacheRelease(cache, held);
+
+        // The least recently used frames are removed across the shards, so
+        // only the last two frames fit.
+        assert(2 == stats.frames);
+        assert(17000 == stats.bytes);
+        for (i = 8; i <= 9; ++i)
+        {
+            frame = fseqCacheGet(cache, sequence, i, &error);
+            assert(frame);
+            fseqCacheRelease(cache, frame);
+        }
+        hits = stats.hits;
+        fseqCacheStats(cache, &stats);
+        assert(hits + 2 == stats.hits);
+
+        // Frames that do not exist.
+        assert(!error);
+        frame = fseqCacheGet(cache, sequence, 11, &error);
+        assert(NULL == frame);
+        assert(error);
+        error = FSEQ_FALSE;
+
+        fseqCacheDel(cache);
+    }
+    fseqDirListDel(entry);
+#endif // WIN32
+}
+
+void test35()
+{
+    struct FSeqDiskUsageOptions options;
+    struct FSeqDiskUsage        usage[4];
+    struct FSeqDirEntry*        list  = NULL;
+    struct FSeqDirEntry*        entry = NULL;
+    struct FSeqDirOptions       dirOptions;
+    char                        buf[FSEQ_STRING_LEN];
+    char                        data[1000];
+    FSeqBool                    error = FSEQ_FALSE;
+    FSeqBool                    ok    = FSEQ_FALSE;
+    size_t                      i     = 0;
+
+    // Create sequences with frame sizes that add up to known totals.
+    fseqMkdir("tests");
+    fseqMkdir("tests/test35");
+    fseqMkdir("tests/test35/dir");
+    memset(data, 0, sizeof(data));
+    for (i = 1; i <= 200; ++i)
+    {
+        FILE* f = NULL;
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test35/a.%04d.exr", (int)i);
+        f = fopen(buf, "wb");
+        fwrite(data, 1, i % 10, f);
+        fclose(f);
+    }
+    for (i = 1; i <= 3; ++i)
+    {
+        FILE* f = NULL;
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test35/b.%04d.exr", (int)i * 2);
+        f = fopen(buf, "wb");
+        fwrite(data, 1, 1000, f);
+        fclose(f);
+    }
+    {
+        FILE* f = fopen("tests/test35/c.txt", "wb");
+        fwrite(data, 1, 3, f);
+        fclose(f);
+    }
+
+    fseqDirOptionsInit(&dirOptions);
+    dirOptions.frames = FSEQ_TRUE;
+    list = fseqDirList("tests/test35", &dirOptions, &error);
+    assert(!error);
+    fseqDiskUsageOptionsInit(&options);
+    options.apparent = FSEQ_TRUE;
+    options.threads = 4;
+    ok = fseqDiskUsage("tests/test35", list, usage, &options, &error);
+    assert(ok);
+    assert(!error);
+    for (entry = list, i = 0; entry; entry = entry->next, ++i)
+    {
+        fseqDirEntryToString(entry, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+        if (0 == strcmp(buf, "a.0001-0200.exr"))
+        {
+            assert(900 == usage[i].bytes);
+            assert(200 == usage[i].files);
+        }
+        else if (0 == strcmp(buf, "b.0002-0006.exr"))
+        {
+            assert(3000 == usage[i].bytes);
+            assert(3 == usage[i].files);
+            assert(0 == usage[i].missing);
+        }
+        else if (0 == strcmp(buf, "c.txt"))
+        {
+            assert(3 == usage[i].bytes);
+            assert(1 == usage[i].files);
+        }
+        else
+        {
+            assert(0 == strcmp(buf, "dir"));
+            assert(0 == usage[i].bytes);
+            assert(0 == usage[i].files);
+        }
+    }
+    assert(4 == i);
+    fseqDirListDel(list);
+
+    // Without the recorded frames the gaps are counted as missing.
+    list = fseqDirEntryParse("tests/test35/b.%04d.exr 2-6", FSEQ_STRING_LEN, NULL, &error);
+    assert(list);
+    ok = fseqDiskUsage(NULL, list, usage, NULL, &error);
+    assert(ok);
+    assert(3 == usage[0].files);
+    assert(2 == usage[0].missing);
+    assert(usage[0].bytes >= 0);
+    fseqDirListDel(list);
+}
+
+// Write a tar header, names longer than 100 characters are split into the
+// ustar prefix.
+void tarWriteHeader(FILE* f, const char* name, char flag, uint64_t size, FSeqBool base256)
+{
+    unsigned char header[512];
+    const size_t  len = strlen(name);
+    unsigned int  sum = 0;
+    memset(header, 0, 512);
+    if (len > 100)
+    {
+        const char* p = name + len - 100;
+        for (; *p != '/'; ++p)
+            ;
+        memcpy(header + 345, name, p - name);
+        memcpy(header, p + 1, len - (p - name) - 1);
+    }
+    else
+    {
+        memcpy(header, name, len);
+    }
+    memcpy(header + 100, "0000644", 7);
+    if (base256)
+    {
+        header[124] = 0x80;
+        for (int i = 0; i < 8; ++i)
+        {
+            header[135 - i] = (unsigned char)(size >> (i * 8));
+        }
+    }
+    else
+    {
+        snprintf((char*)header + 124, 12, "%011" PRIo64, size);
+    }
+    header[156] = (unsigned char)flag;
+    memcpy(header + 257, "ustar", 6);
+    memcpy(header + 263, "00", 2);
+    memset(header + 148, ' ', 8);
+    for (int i = 0; i < 512; ++i)
+    {
+        sum += header[i];
+    }
+    snprintf((char*)header + 148, 8, "%06o", sum);
+    fwrite(header, 1, 512, f);
+}
+
+void tarWriteData(FILE* f, const char* data, size_t size)
+{
+    char zero[512];
+    memset(zero, 0, 512);
+    fwrite(data, 1, size, f);
+    fwrite(zero, 1, (512 - size % 512) % 512, f);
+}
+
+void test36()
+{
+    struct FSeqDirEntry* list  = NULL;
+    struct FSeqDirEntry* entry = NULL;
+    FILE*                f     = NULL;
+    char                 buf[FSEQ_STRING_LEN];
+    char                 data[600];
+    char                 longName[300];
+    FSeqBool             error = FSEQ_FALSE;
+    int                  i     = 0;
+
+    fseqMkdir("tests");
+    memset(data, 'x', sizeof(data));
+    memset(longName, 'a', sizeof(longName));
+    memcpy(longName + 200, "/long.0001.exr", 15);
+
+    f = fopen("tests/test36.tar", "wb");
+    tarWriteHeader(f, "shot/", '5', 0, FSEQ_FALSE);
+    for (i = 1; i <= 10; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "shot/render.%04d.exr", i);
+        tarWriteHeader(f, buf, '0', 600, 5 == i);
+        tarWriteData(f, data, 600);
+    }
+
+    // A name split into the ustar prefix.
+    snprintf(buf, FSEQ_STRING_LEN, "shot/%.*s/split.%04d.exr", 120, longName, 1);
+    tarWriteHeader(f, buf, '0', 0, FSEQ_FALSE);
+
+    // A GNU long name.
+    tarWriteHeader(f, "././@LongLink", 'L', strlen(longName) + 1, FSEQ_FALSE);
+    tarWriteData(f, longName, strlen(longName) + 1);
+    tarWriteHeader(f, "truncated", '0', 1, FSEQ_FALSE);
+    tarWriteData(f, data, 1);
+
+    // A pax extended header with the name and size.
+    snprintf(buf, FSEQ_STRING_LEN, "26 path=shot/pax.0002.exr\n11 size=10\n");
+    tarWriteHeader(f, "PaxHeaders/pax", 'x', strlen(buf), FSEQ_FALSE);
+    tarWriteData(f, buf, strlen(buf));
+    tarWriteHeader(f, "pax", '0', 0, FSEQ_FALSE);
+    tarWriteData(f, data, 10);
+
+    tarWriteHeader(f, "shot/link.0001.exr", '2', 0, FSEQ_FALSE);
+    memset(buf, 0, 1024);
+    fwrite(buf, 1, 1024, f);
+    fclose(f);
+
+    list = fseqArchiveList("tests/test36.tar", NULL, &error);
+    assert(!error);
+    for (entry = list, i = 0; entry; entry = entry->next, ++i)
+    {
+        fseqDirEntryToString(entry, buf, FSEQ_TRUE, FSEQ_STRING_LEN);
+        switch (i)
+        {
+        case 0:
+            assert(0 == strcmp(buf, "shot"));
+            assert(FSEQ_FILE_TYPE_DIR == entry->type);
+            break;
+        case 1:
+            assert(0 == strcmp(buf, "shot/render.0001-0010.exr"));
+            assert(10 == entry->frameCount);
+            break;
+        case 2:
+            assert(0 == strncmp(buf, "shot/aaaa", 9));
+            assert(0 == strcmp(buf + strlen(buf) - 15, "/split.0001.exr"));
+            break;
+        case 3:
+            assert(0 == strcmp(buf, longName));
+            break;
+        case 4:
+            assert(0 == strcmp(buf, "shot/pax.0002.exr"));
+            break;
+        case 5:
+            assert(0 == strcmp(buf, "shot/link.0001.exr"));
+            assert(FSEQ_FILE_TYPE_LINK == entry->type);
+            break;
+        default:
+            assert(0);
+            break;
+        }
+    }
+    assert(6 == i);
+    fseqDirListDel(list);
+
+    // Damaged archives return the entries read so far.
+    f = fopen("tests/test36.tar", "r+b");
+    fseek(f, 512 * 7 + 148, SEEK_SET);
+    fputc('9', f);
+    fclose(f);
+    list = fseqArchiveList("tests/test36.tar", NULL, &error);
+    assert(error);
+    assert(list && list->next);
+    fseqDirListDel(list);
+    error = FSEQ_FALSE;
+
+    // Sizes past the end of the archive fail instead of wrapping the offset
+    // of the next header around to an earlier one.
+    for (i = 0; i < 3; ++i)
+    {
+        f = fopen("tests/test36.tar", "wb");
+        tarWriteHeader(f, "evil.0001.exr", '0', 0, FSEQ_FALSE);
+        switch (i)
+        {
+        case 0:
+            snprintf(buf, FSEQ_STRING_LEN, "29 size=18446744073709550080\n");
+            break;
+        case 1:
+            snprintf(buf, FSEQ_STRING_LEN, "33 size=184467440737095516160000\n");
+            break;
+        default:
+            buf[0] = 0;
+            break;
+        }
+        if (buf[0])
+        {
+            tarWriteHeader(f, "PaxHeaders/evil", 'x', strlen(buf), FSEQ_FALSE);
+            tarWriteData(f, buf, strlen(buf));
+            tarWriteHeader(f, "evil.0002.exr", '0', 0, FSEQ_FALSE);
+        }
+        else
+        {
+            tarWriteHeader(f, "evil.0002.exr", '0', UINT64_MAX - 1535, FSEQ_TRUE);
+        }
+        memset(buf, 0, 1024);
+        fwrite(buf, 1, 1024, f);
+        fclose(f);
+        list = fseqArchiveList("tests/test36.tar", NULL, &error);
+        assert(error);
+        assert(list && NULL == list->next);
+        assert(1 == list->frameCount);
+        fseqDirListDel(list);
+        error = FSEQ_FALSE;
+    }
+
+    list = fseqArchiveList("tests/test36.missing", NULL, &error);
+    assert(!list);
+    assert(error);
+}
+
+// A directory source that fails after the first batch.
+void* failingSourceOpen(void* data, const char* path)
+{
+    (void)path;
+    return data;
+}
+
+size_t failingSourceNext(void* handle, struct FSeqDirSourceEntry* out, size_t max, FSeqBool* error)
+{
+    int* count = (int*)handle;
+    (void)max;
+    if ((*count)++ > 0)
+    {
+        *error = FSEQ_TRUE;
+        return 0;
+    }
+    out[0].name = "render.0001.exr";
+    out[0].len  = 15;
+    out[0].type = FSEQ_FILE_TYPE_FILE;
+    return 1;
+}
+
+void failingSourceClose(void* handle)
+{
+    (void)handle;
+}
+
+void test37()
+{
+    static const char names[] =
+        "render.0003.exr\n"
+        "render.0001.exr\n"
+        ".hidden\n"
+        "shot/\n"
+        "shot/a.1.exr\n"
+        "shot/sub/\n"
+        "shot/sub/b.1.exr\n"
+        "shot/a.2.exr\n"
+        "render.0002.exr\n"
+        "other.txt";
+    struct FSeqDirSource* source = NULL;
+    struct FSeqDirSource  failing;
+    struct FSeqDirOptions options;
+    struct FSeqDirEntry*  list   = NULL;
+    struct FSeqDirCursor* cursor = NULL;
+    struct FSeqDirEntry   entry;
+    char                  buf[FSEQ_STRING_LEN];
+    FSeqBool              found  = FSEQ_FALSE;
+    FSeqBool              error  = FSEQ_FALSE;
+    int                   count  = 0;
+
+    source = fseqDirSourceMemoryCreate(names, sizeof(names) - 1, '\n', &error);
+    assert(source);
+    fseqDirOptionsInit(&options);
+    options.source = source;
+
+    // List the root of the source.
+    list = fseqDirList(".", &options, &error);
+    assert(!error);
+    assert(3 == fseqDirListCount(list));
+    fseqDirEntryToString(list, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "render.0001-0003.exr"));
+    assert(3 == list->frameCount);
+    assert(FSEQ_FILE_TYPE_DIR == list->next->type);
+    assert(0 == strcmp(list->next->fileName.base, "shot"));
+    assert(0 == strcmp(list->next->next->fileName.base, "other"));
+    fseqDirListDel(list);
+
+    // List a sub-directory with a cursor.
+    cursor = fseqDirCursorCreate("./shot/", &options, &error);
+    assert(cursor);
+    list = fseqDirCursorList(cursor, NULL, &error);
+    assert(!error);
+    assert(2 == fseqDirListCount(list));
+    fseqDirEntryToString(list, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "a.1-2.exr"));
+    fseqDirListDel(list);
+    fseqDirCursorDel(cursor);
+
+    list = fseqDirList("shot/sub", &options, &error);
+    assert(1 == fseqDirListCount(list));
+    fseqDirListDel(list);
+    assert(!error);
+
+    // Paths without a directory entry cannot be opened.
+    list = fseqDirList("missing", &options, &error);
+    assert(error);
+    assert(!list);
+    error = FSEQ_FALSE;
+    list = fseqDirList("shot/a.1.exr", &options, &error);
+    assert(error);
+    assert(!list);
+    error = FSEQ_FALSE;
+
+    // Find a sequence through the source.
+    fseqDirEntryInit(&entry);
+    options.frames = FSEQ_TRUE;
+    found = fseqDirFindSequence("render.0002.exr", &entry, &options, &error);
+    assert(found);
+    assert(!error);
+    assert(1 == entry.frameMin);
+    assert(3 == entry.frameMax);
+    assert(3 == fseqFrameSetCount(&entry.frames));
+    found = fseqDirFindSequence("shot/a.2.exr", &entry, &options, &error);
+    assert(found);
+    assert(!error);
+    assert(2 == entry.frameCount);
+    found = fseqDirFindSequence("shot/sub", &entry, &options, &error);
+    assert(found);
+    assert(FSEQ_FILE_TYPE_DIR == entry.type);
+    found = fseqDirFindSequence("shot/c.1.exr", &entry, &options, &error);
+    assert(!found);
+    assert(!error);
+    found = fseqDirFindSequence("missing/a.1.exr", &entry, &options, &error);
+    assert(!found);
+    assert(error);
+    error = FSEQ_FALSE;
+    fseqDirEntryDel(&entry);
+    options.frames = FSEQ_FALSE;
+    fseqDirSourceMemoryDel(source);
+
+    // Errors from the source.
+    failing.open  = failingSourceOpen;
+    failing.next  = failingSourceNext;
+    failing.close = failingSourceClose;
+    failing.data  = &count;
+    options.source = &failing;
+    list = fseqDirList(".", &options, &error);
+    assert(error);
+    assert(!list);
+    error = FSEQ_FALSE;
+
+    // The file system source.
+    assert(fseqDirSourceSystem());
+    options.source = fseqDirSourceSystem();
+    list = fseqDirList(".", &options, &error);
+    assert(!error);
+    fseqDirListDel(list);
+}
+
+void test38()
+{
+    struct FSeqDirSource*      source = NULL;
+    struct FSeqDirOptions      options;
+    struct FSeqLister*         lister = NULL;
+    struct FSeqDirEntry*       list   = NULL;
+    const struct FSeqDirEntry* reused = NULL;
+    char                       names[FSEQ_STRING_LEN * 2];
+    size_t                     size   = 0;
+    FSeqBool                   error  = FSEQ_FALSE;
+    int                        i      = 0;
+
+    // Long names are stored outside of the entries.
+    for (i = 1; i <= 200; ++i)
+    {
+        size += snprintf(names + size, sizeof(names) - size, "render.%04d.exr\n", i);
+    }
+    for (i = 1; i <= 3; ++i)
+    {
+        size += snprintf(names + size, sizeof(names) - size, "a_very_long_file_name_that_is_not_stored_inline.%d.exr\n", i);
+    }
+    size += snprintf(names + size, sizeof(names) - size, "dir/\nfile.txt\n");
+    source = fseqDirSourceMemoryCreate(names, size, '\n', NULL);
+    assert(source);
+    lister = fseqListerCreate(&error);
+    assert(lister);
+
+    // The lists match fseqDirList() with every combination of options, and
+    // the lister is reused between them.
+    fseqDirOptionsInit(&options);
+    options.source = source;
+    for (i = 0; i < 8; ++i)
+    {
+        options.splitFileNames = (i & 1) != 0;
+        options.frames         = (i & 2) != 0;
+        list = fseqDirList(".", &options, &error);
+        assert(!error);
+        reused = fseqListerList(lister, ".", &options, &error);
+        assert(!error);
+        assert(4 == fseqDirListCompare(list, reused));
+        if (options.splitFileNames)
+        {
+            assert(0 == strcmp(reused->fileName.base, "render."));
+            assert(0 == strcmp(reused->fileName.number, "0001"));
+            assert(0 == strcmp(reused->fileName.extension, ".exr"));
+        }
+        if (options.frames)
+        {
+            assert(fseqFrameSetContains(&reused->frames, 200));
+        }
+        fseqDirListDel(list);
+        if (i >= 4)
+        {
+            fseqListerReset(lister);
+        }
+    }
+
+    // Errors.
+    reused = fseqListerList(lister, "tests/test38.missing", NULL, &error);
+    assert(!reused);
+    assert(error);
+    error = FSEQ_FALSE;
+
+    // The file system.
+    list = fseqDirList(".", NULL, NULL);
+    reused = fseqListerList(lister, ".", NULL, NULL);
+    fseqDirListCompare(list, reused);
+    fseqDirListDel(list);
+
+    fseqListerDel(lister);
+    fseqDirSourceMemoryDel(source);
+}
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+// Read snapshots until the last listing is published. Each listing has the
+// version number of frames.
+void* test39Reader(void* data)
+{
+    struct FSeqListing* listing = (struct FSeqListing*)data;
+    int64_t             version = 0;
+    while (version < 200)
+    {
+        const struct FSeqSnapshot* snapshot = fseqSnapshotAcquire(listing);
+        if (snapshot)
+        {
+            assert(snapshot->version >= version);
+            version = snapshot->version;
+            assert(snapshot->entries && NULL == snapshot->entries->next);
+            assert(version == snapshot->entries->frameMax);
+            fseqSnapshotRelease(snapshot);
+        }
+    }
+    return NULL;
+}
+
+#endif // WIN32
+
+void test39()
+{
+#if !defined(WIN32) && !defined(_WIN32)
+    struct FSeqListing*        listing = NULL;
+    const struct FSeqSnapshot* first   = NULL;
+    const struct FSeqSnapshot* second  = NULL;
+    pthread_t                  threads[4];
+    char                       buf[FSEQ_STRING_LEN];
+    FSeqBool                   error   = FSEQ_FALSE;
+    int                        i       = 0;
+
+    fseqMkdir("tests");
+    fseqMkdir("tests/test39");
+    fseqTouch("tests/test39/render.0001.exr");
+    fseqTouch("tests/test39/render.0002.exr");
+    remove("tests/test39/render.0003.exr");
+    listing = fseqListingCreate(&error);
+    assert(listing);
+    assert(!error);
+    first = fseqSnapshotAcquire(listing);
+    assert(!first);
+
+    // Snapshots remain valid after newer snapshots are published.
+    fseqListingRefresh(listing, "tests/test39", NULL, &error);
+    assert(!error);
+    first = fseqSnapshotAcquire(listing);
+    assert(first && 1 == first->version);
+    assert(2 == first->entries->frameMax);
+    fseqTouch("tests/test39/render.0003.exr");
+    fseqListingRefresh(listing, "tests/test39", NULL, &error);
+    assert(!error);
+    second = fseqSnapshotAcquire(listing);
+    assert(second && 2 == second->version);
+    assert(3 == second->entries->frameMax);
+    assert(2 == first->entries->frameMax);
+    fseqSnapshotRelease(first);
+
+    // A directory that cannot be listed keeps the current snapshot.
+    fseqListingRefresh(listing, "tests/test39.missing", NULL, &error);
+    assert(error);
+    error = FSEQ_FALSE;
+    first = fseqSnapshotAcquire(listing);
+    assert(first == second);
+    fseqSnapshotRelease(first);
+    fseqListingDel(listing);
+    assert(3 == second->entries->frameMax);
+    fseqSnapshotRelease(second);
+
+    // Publish while other threads read.
+    listing = fseqListingCreate(NULL);
+    for (i = 0; i < 4; ++i)
+    {
+        pthread_create(&threads[i], NULL, test39Reader, listing);
+    }
+    for (i = 1; i <= 200; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "render.1-%d.exr", i);
+        fseqListingPublish(listing, fseqDirEntryParse(buf, FSEQ_STRING_LEN, NULL, NULL), &error);
+        assert(!error);
+    }
+    for (i = 0; i < 4; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    fseqListingDel(listing);
+#endif // WIN32
+}
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+// Wait for a throttle with a low rate.
+void* test40Wait(void* data)
+{
+    fseqThrottleAcquire((struct FSeqThrottle*)data, 10);
+    return NULL;
+}
+
+#endif // WIN32
+
+void test40()
+{
+    struct FSeqThrottle*        throttle   = NULL;
+    struct FSeqThrottleStats    stats;
+    struct FSeqDirSource*       source     = NULL;
+    struct FSeqDirOptions       options;
+    struct FSeqDiskUsageOptions duOptions;
+    struct FSeqDiskUsage        usage;
+    struct FSeqDirEntry*        list       = NULL;
+    char                        names[FSEQ_STRING_LEN * 2];
+    char                        buf[FSEQ_STRING_LEN];
+    size_t                      size       = 0;
+    int64_t                     throttled  = 0;
+    int64_t                     operations = 0;
+    int64_t                     wait       = 0;
+    FSeqBool                    ok         = FSEQ_FALSE;
+    FSeqBool                    error      = FSEQ_FALSE;
+    int                         i          = 0;
+
+    // The burst does not wait, later operations are limited to the rate.
+    throttle = fseqThrottleCreate(1000.0, 10.0, &error);
+    assert(throttle);
+    assert(!error);
+    wait = fseqThrottleAcquire(throttle, 10);
+    assert(0 == wait);
+    wait = fseqThrottleAcquire(throttle, 10);
+    assert(wait >= 5000);
+    fseqThrottleStats(throttle, &stats);
+    assert(20 == stats.operations);
+    assert(1 == stats.waits);
+    assert(stats.waitTime >= 5000);
+
+    // No limit.
+    fseqThrottleSetRate(throttle, 0.0, 0.0);
+    for (i = 0; i < 100; ++i)
+    {
+        wait = fseqThrottleAcquire(throttle, 10);
+        assert(0 == wait);
+    }
+
+    // Listings are throttled, each read of the directory is an operation.
+    for (i = 1; i <= 200; ++i)
+    {
+        size += snprintf(names + size, sizeof(names) - size, "render.%04d.exr\n", i);
+    }
+    source = fseqDirSourceMemoryCreate(names, size, '\n', NULL);
+    fseqThrottleSetRate(throttle, 100.0, 1.0);
+    fseqDirOptionsInit(&options);
+    options.source    = source;
+    options.throttle  = throttle;
+    options.throttled = &throttled;
+    list = fseqDirList(".", &options, &error);
+    assert(!error);
+    assert(1 == fseqDirListCount(list));
+    fseqThrottleStats(throttle, &stats);
+    assert(stats.operations >= 1020 + 5);
+    assert(throttled >= 30000);
+    fseqDirListDel(list);
+    fseqDirSourceMemoryDel(source);
+
+    // The file status.
+    fseqMkdir("tests");
+    fseqMkdir("tests/test40");
+    for (i = 1; i <= 100; ++i)
+    {
+        snprintf(buf, FSEQ_STRING_LEN, "tests/test40/render.%04d.exr", i);
+        fseqTouch(buf);
+    }
+    fseqThrottleSetRate(throttle, 0.0, 0.0);
+    options.source = NULL;
+    list = fseqDirList("tests/test40", &options, &error);
+    assert(!error);
+    fseqThrottleStats(throttle, &stats);
+    operations = stats.operations;
+    fseqDiskUsageOptionsInit(&duOptions);
+    duOptions.throttle = throttle;
+    ok = fseqDiskUsage("tests/test40", list, &usage, &duOptions, &error);
+    assert(ok);
+    assert(100 == usage.files);
+    fseqThrottleStats(throttle, &stats);
+    assert(operations + 100 == stats.operations);
+    fseqDirListDel(list);
+
+#if !defined(WIN32) && !defined(_WIN32)
+    // Waiting operations use a new rate.
+    {
+        pthread_t thread;
+        fseqThrottleSetRate(throttle, 1.0, 1.0);
+        fseqThrottleAcquire(throttle, 1);
+        pthread_create(&thread, NULL, test40Wait, throttle);
+        usleep(20000);
+        fseqThrottleSetRate(throttle, 0.0, 0.0);
+        pthread_join(thread, NULL);
+        fseqThrottleStats(throttle, &stats);
+        assert(stats.waitTime < 500000);
+    }
+#endif // WIN32
+
+    fseqThrottleDel(throttle);
+}
+
+void test41()
+{
+    static const char* names[][3] =
+    {
+        { "r.0999.exr", "r.0998.exr", "r.1000.exr" },
+        { "r.1000.exr", "r.0999.exr", "r.0998.exr" },
+        { "r.0998.exr", "r.1000.exr", "r.0999.exr" }
+    };
+    struct FSeqGroup*       group  = NULL;
+    struct FSeqDirEntry*    list   = NULL;
+    struct FSeqDirEntry     entry;
+    struct FSeqRemoveOptions options;
+    struct FSeqRemoveResult result;
+    char                    buf[FSEQ_STRING_LEN];
+    FSeqBool                found  = FSEQ_FALSE;
+    FSeqBool                error  = FSEQ_FALSE;
+    int                     i      = 0;
+    int                     j      = 0;
+
+    // The frame padding does not depend on the order of the file names.
+    for (i = 0; i < 3; ++i)
+    {
+        group = fseqGroupCreate(NULL, NULL);
+        for (j = 0; j < 3; ++j)
+        {
+            fseqGroupAdd(group, names[i][j], strlen(names[i][j]), FSEQ_FILE_TYPE_FILE);
+        }
+        list = fseqGroupList(group, &error);
+        assert(!error);
+        assert(list && NULL == list->next);
+        assert(4 == list->framePadding);
+        fseqDirEntryToString(list, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+        assert(0 == strcmp(buf, "r.0998-1000.exr"));
+        fseqDirListDel(list);
+        fseqGroupDel(group);
+    }
+
+    // Unpadded numbers do not change the padding.
+    group = fseqGroupCreate(NULL, NULL);
+    fseqGroupAdd(group, "r.10.exr", 8, FSEQ_FILE_TYPE_FILE);
+    fseqGroupAdd(group, "r.9.exr", 7, FSEQ_FILE_TYPE_FILE);
+    list = fseqGroupList(group, NULL);
+    assert(0 == list->framePadding);
+    fseqDirListDel(list);
+    fseqGroupDel(group);
+
+    // Every frame is found whichever order the directory is read in.
+    fseqMkdir("tests");
+    fseqMkdir("tests/test41");
+    fseqTouch("tests/test41/r.0999.exr");
+    fseqTouch("tests/test41/r.1000.exr");
+    fseqDirEntryInit(&entry);
+    found = fseqDirFindSequence("tests/test41/r.1000.exr", &entry, NULL, &error);
+    assert(found);
+    assert(!error);
+    assert(4 == entry.framePadding);
+    fseqRemoveOptionsInit(&options);
+    options.dryRun = FSEQ_TRUE;
+    fseqRemove(NULL, &entry, &result, &options, &error);
+    assert(!error);
+    assert(2 == result.removed);
+    assert(0 == result.missing);
+    fseqDirEntryDel(&entry);
+}
+
+void test42()
+{
+    struct FSeqDirOptions options;
+    struct FSeqGroup* group = NULL;
+    struct FSeqDirEntry* list = NULL;
+    char buf[FSEQ_STRING_LEN];
+
+    // The padding of the first file is found from the number, not from the
+    // same offset at the start of the file name.
+    group = fseqGroupCreate(NULL, NULL);
+    fseqGroupAdd(group, "shot.0010.exr", 13, FSEQ_FILE_TYPE_FILE);
+    fseqGroupAdd(group, "abc00.100.exr", 13, FSEQ_FILE_TYPE_FILE);
+    list = fseqGroupList(group, NULL);
+    assert(2 == fseqDirListCount(list));
+    assert(4 == list->framePadding);
+    fseqDirEntryToString(list, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "shot.0010.exr"));
+    assert(0 == list->next->framePadding);
+    fseqDirEntryToString(list->next, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+    assert(0 == strcmp(buf, "abc00.100.exr"));
+    fseqDirListDel(list);
+    fseqGroupDel(group);
+
+    // Padded negative numbers are decimal, not octal.
+    fseqDirOptionsInit(&options);
+    options.fileNameOptions.negativeNumbers = FSEQ_TRUE;
+    group = fseqGroupCreate(&options, NULL);
+    fseqGroupAdd(group, "seq.-010.exr", 12, FSEQ_FILE_TYPE_FILE);
+    fseqGroupAdd(group, "seq.-009.exr", 12, FSEQ_FILE_TYPE_FILE);
+    fseqGroupAdd(group, "seq.-008.exr", 12, FSEQ_FILE_TYPE_FILE);
+    list = fseqGroupList(group, NULL);
+    assert(list && NULL == list->next);
+    assert(-10 == list->frameMin);
+    assert(-8 == list->frameMax);
+    assert(3 == list->frameCount);
+    fseqDirListDel(list);
+    fseqGroupDel(group);
+}
+
 int main(int argc, char** argv)
 {
     test0();
@@ -531,6 +2804,33 @@ int main(int argc, char** argv)
     test13();
     test14();
     test15();
+    test16();
+    test17();
+    test18();
+    test19();
+    test20();
+    test21();
+    test22();
+    test23();
+    test24();
+    test25();
+    test26();
+    test27();
+    test28();
+    test29();
+    test30();
+    test31();
+    test32();
+    test33();
+    test34();
+    test35();
+    test36();
+    test37();
+    test38();
+    test39();
+    test40();
+    test41();
+    test42();
     return 0;
 }
 
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2019-2021 Darby Johnston
+// All rights reserved.
+
+#include "fseq.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+static_assert(!std::is_copy_constructible<fseq::DirList>::value);
+static_assert(std::is_nothrow_move_constructible<fseq::DirList>::value);
+static_assert(!std::is_copy_constructible<fseq::FileName>::value);
+
+void test0()
+{
+    fseq::FileName a("/tmp/render.0100.exr");
+    assert(a.path() == "/tmp/");
+    assert(a.base() == "render.");
+    assert(a.number() == "0100");
+    assert(a.extension() == ".exr");
+
+    fseq::FileName b(std::move(a));
+    assert(b.base() == "render.");
+    assert(a.base().empty());
+
+    fseq::FileName c;
+    c = std::move(b);
+    assert(c.number() == "0100");
+}
+
+void test1()
+{
+    fseq::DirList list = fseq::DirList::parse("/tmp/render.0001-0010,0020-0030.exr");
+    assert(!list.error());
+    assert(2 == list.size());
+
+    std::vector<int64_t> frames;
+    for (const auto& entry : list)
+    {
+        assert(entry.path() == "/tmp/");
+        assert(entry.base() == "render.");
+        assert(entry.isSequence());
+        frames.push_back(entry.frameMin());
+        frames.push_back(entry.frameMax());
+    }
+    assert((std::vector<int64_t>{ 1, 10, 20, 30 }) == frames);
+    assert(list.begin()->toString() == "render.0001-0010.exr");
+
+    fseq::DirList list2(std::move(list));
+    assert(list.empty());
+    assert(2 == list2.size());
+
+    list = std::move(list2);
+    assert(2 == list.size());
+
+    FSeqDirEntry* raw = list.release();
+    assert(list.empty());
+    fseqDirListDel(raw);
+}
+
+void test2()
+{
+    fseq::DirList list = fseq::DirList::list("tests/dir4");
+    assert(list.error());
+    assert(list.empty());
+    assert(list.begin() == list.end());
+}
+
+void test3()
+{
+    FSeqDirEntry entry;
+    fseqDirEntryInit(&entry);
+    entry.name = strdup("/tmp/render.0100.exr");
+    fseqFileNameParseSizes(entry.name, &entry.sizes, FSEQ_STRING_LEN, nullptr);
+    fseq::DirEntry view(&entry);
+    assert(view.path() == "/tmp/");
+    assert(view.base() == "render.");
+    assert(view.number() == "0100");
+    assert(view.extension() == ".exr");
+    fseqDirEntryDel(&entry);
+}
+
+void test4()
+{
+    fseq::FrameSet a;
+    fseq::FrameSet b;
+    assert(a.empty());
+    const bool added = a.add(1, 100) && b.add(50, 150);
+    assert(added);
+    const fseq::FrameSet intersection = a & b;
+    const fseq::FrameSet sum = a | b;
+    const fseq::FrameSet difference = a - b;
+    assert(!intersection.error() && 51 == intersection.count());
+    assert(!sum.error() && 150 == sum.count());
+    assert(!difference.error() && 49 == difference.count());
+    int64_t total = 0;
+    difference.forEach([&total](int64_t frame) { total += frame; });
+    assert(49 * 50 / 2 == total);
+
+    fseq::DirList list = fseq::DirList::parse("render.1-10,20-30.exr");
+    fseq::FrameSet frames = fseq::FrameSet::frames(list.begin()->get());
+    assert(!frames.error());
+    assert(10 == frames.count());
+}
+
+int main(int argc, char** argv)
+{
+    test0();
+    test1();
+    test2();
+    test3();
+    test4();
+    return 0;
+}
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2019-2021 Darby Johnston
+// All rights reserved.
+
+// Tests for the snapshot publication. The library is built into the test
+// with FSEQ_SNAPSHOT_TEST, so fseqSnapshotTestStep() is called between each
+// step of acquiring and publishing snapshots and can interleave the threads
+// at any step. Run with the address sanitizer to also catch snapshots that
+// are deleted while they are still being acquired.
+
+#include "fseq.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define READERS    4
+#define PUBLISHERS 3
+#define READS      20000
+
+struct FSeqListing* listing = NULL;
+atomic_int          scripted;
+atomic_int          published;
+atomic_int          readersDone;
+pthread_t           scriptThread;
+int                 scriptState = 0;
+
+void publish(int64_t frames)
+{
+    char     buf[FSEQ_STRING_LEN];
+    FSeqBool error = FSEQ_FALSE;
+    snprintf(buf, FSEQ_STRING_LEN, "render.1-%d.exr", (int)frames);
+    fseqListingPublish(listing, fseqDirEntryParse(buf, FSEQ_STRING_LEN, NULL, NULL), &error);
+    assert(!error);
+}
+
+void* publishThread(void* data)
+{
+    (void)data;
+    publish(3);
+    atomic_store(&published, 1);
+    return NULL;
+}
+
+// The steps are: 0 after a publisher replaces the snapshot, 1 after a
+// reader loads the epoch, 2 after it registers, and 3 after it loads the
+// snapshot.
+void fseqSnapshotTestStep(int step)
+{
+    pthread_t thread;
+    if (!atomic_load(&scripted))
+    {
+        sched_yield();
+        return;
+    }
+    if (!pthread_equal(pthread_self(), scriptThread))
+    {
+        return;
+    }
+    if (1 == step && 0 == scriptState)
+    {
+        // Publish after the reader has loaded the epoch but before it
+        // registers, so the publisher does not wait for it.
+        scriptState = 1;
+        publish(2);
+    }
+    else if (3 == step && 1 == scriptState)
+    {
+        // Publish again after the reader has loaded the snapshot but before
+        // it takes a reference. The publisher must wait for the reader
+        // instead of deleting the snapshot.
+        scriptState = 2;
+        pthread_create(&thread, NULL, publishThread, NULL);
+        usleep(100000);
+        assert(!atomic_load(&published));
+        pthread_detach(thread);
+    }
+}
+
+void* reader(void* data)
+{
+    int64_t version = 0;
+    char    buf[FSEQ_STRING_LEN];
+    (void)data;
+    for (int i = 0; i < READS; ++i)
+    {
+        const struct FSeqSnapshot* snapshot = fseqSnapshotAcquire(listing);
+        assert(snapshot);
+        assert(snapshot->version >= version);
+        version = snapshot->version;
+        assert(snapshot->entries && NULL == snapshot->entries->next);
+        assert(1 == snapshot->entries->frameMin);
+        fseqDirEntryToString(snapshot->entries, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+        assert(0 == strncmp(buf, "render.1-", 9));
+        fseqSnapshotRelease(snapshot);
+    }
+    atomic_fetch_add(&readersDone, 1);
+    return NULL;
+}
+
+void* publisher(void* data)
+{
+    const int publisher = (int)(intptr_t)data;
+    for (int i = 1; atomic_load(&readersDone) < READERS; ++i)
+    {
+        publish(i * PUBLISHERS + publisher);
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    const struct FSeqSnapshot* snapshot = NULL;
+    pthread_t                  readers[READERS];
+    pthread_t                  publishers[PUBLISHERS];
+    int                        i        = 0;
+
+    atomic_init(&scripted, 1);
+    atomic_init(&published, 0);
+    atomic_init(&readersDone, 0);
+
+    // Publish twice while a snapshot is acquired.
+    listing = fseqListingCreate(NULL);
+    assert(listing);
+    publish(1);
+    scriptThread = pthread_self();
+    snapshot = fseqSnapshotAcquire(listing);
+    assert(snapshot && 2 == snapshot->version);
+    while (!atomic_load(&published))
+    {
+        usleep(1000);
+    }
+    assert(2 == snapshot->entries->frameMax);
+    fseqSnapshotRelease(snapshot);
+    fseqListingDel(listing);
+
+    // Readers and publishers yielding at every step.
+    atomic_store(&scripted, 0);
+    listing = fseqListingCreate(NULL);
+    publish(1);
+    for (i = 0; i < PUBLISHERS; ++i)
+    {
+        pthread_create(&publishers[i], NULL, publisher, (void*)(intptr_t)i);
+    }
+    for (i = 0; i < READERS; ++i)
+    {
+        pthread_create(&readers[i], NULL, reader, NULL);
+    }
+    for (i = 0; i < READERS; ++i)
+    {
+        pthread_join(readers[i], NULL);
+    }
+    for (i = 0; i < PUBLISHERS; ++i)
+    {
+        pthread_join(publishers[i], NULL);
+    }
+    fseqListingDel(listing);
+    return 0;
+}
+
+#else // WIN32
+
+int main(int argc, char** argv)
+{
+    return 0;
+}
+
+#endif // WIN32
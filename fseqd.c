@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2019-2021 Darby Johnston
+// All rights reserved.
+
+#include "fseq.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <signal.h>
+#endif // WIN32
+
+void printUsage()
+{
+    printf("usage: fseqd [-s socket] [-n dirs]\n");
+    printf("Cache directory listings and serve them to other processes, for example\n");
+    printf("with \"fseqls -d\". The daemon runs until it is interrupted.\n");
+    printf("  -s  The socket path (default $FSEQD_SOCKET, $XDG_RUNTIME_DIR/fseqd.sock,\n");
+    printf("      or /tmp/fseqd-<uid>.sock)\n");
+    printf("  -n  The maximum number of cached directories (default 1024)\n");
+}
+
+int main(int argc, char** argv)
+{
+#if defined(WIN32) || defined(_WIN32)
+    fprintf(stderr, "fseqd is not available on Windows\n");
+    return 1;
+#else // WIN32
+    struct FSeqDaemonOptions options;
+    struct FSeqDaemon*       daemon     = NULL;
+    const char*              socketPath = NULL;
+    char                     buf[FSEQ_STRING_LEN];
+    sigset_t                 signals;
+    int                      signal     = 0;
+    FSeqBool                 error      = FSEQ_FALSE;
+    int                      i          = 1;
+
+    fseqDaemonOptionsInit(&options);
+
+    // Parse the command line options.
+    for (; i < argc; ++i)
+    {
+        if (0 == strcmp(argv[i], "-s") && i + 1 < argc)
+        {
+            socketPath = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            options.maxDirs = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (!socketPath)
+    {
+        fseqDaemonSocketPath(buf, FSEQ_STRING_LEN);
+        socketPath = buf;
+    }
+
+    // Block the signals before the daemon threads are started, so only the
+    // main thread receives them.
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    daemon = fseqDaemonCreate(socketPath, &options, &error);
+    if (error)
+    {
+        fprintf(stderr, "cannot listen on %s\n", socketPath);
+        return 1;
+    }
+    sigwait(&signals, &signal);
+    fseqDaemonDel(daemon);
+
+    return 0;
+#endif // WIN32
+}
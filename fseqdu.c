@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2019-2021 Darby Johnston
+// All rights reserved.
+
+#include "fseq.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// This struct provides the disk usage of a sequence or directory.
+struct Record
+{
+    char*   name;
+    int64_t bytes;
+    int64_t files;
+};
+
+// This struct provides the command line options and the records collected
+// while walking the directories.
+struct Walk
+{
+    struct FSeqDirOptions       dirOptions;
+    struct FSeqDiskUsageOptions options;
+    FSeqBool                    dirs;
+    size_t                      max;
+    struct Record*              records;
+    size_t                      recordCount;
+    size_t                      recordCapacity;
+    FSeqBool                    result;
+};
+
+int recordCompare(const void* a, const void* b)
+{
+    const struct Record* ra = (const struct Record*)a;
+    const struct Record* rb = (const struct Record*)b;
+    if (ra->bytes != rb->bytes)
+    {
+        return ra->bytes > rb->bytes ? -1 : 1;
+    }
+    return strcmp(ra->name, rb->name);
+}
+
+// Sort the records, largest first, and only keep the maximum number.
+void recordsSort(struct Walk* walk)
+{
+    qsort(walk->records, walk->recordCount, sizeof(struct Record), recordCompare);
+    if (walk->max > 0)
+    {
+        for (size_t i = walk->max; i < walk->recordCount; ++i)
+        {
+            free(walk->records[i].name);
+        }
+        walk->recordCount = FSEQ_MIN(walk->recordCount, walk->max);
+    }
+}
+
+void recordAdd(struct Walk* walk, const char* name, int64_t bytes, int64_t files)
+{
+    struct Record* record = NULL;
+
+    // When only the largest records are printed they are trimmed whenever
+    // twice the maximum have been collected, so the memory used does not
+    // depend on the size of the tree.
+    if (walk->max > 0 && walk->recordCount >= walk->max * 2)
+    {
+        recordsSort(walk);
+    }
+    if (walk->recordCount == walk->recordCapacity)
+    {
+        const size_t   capacity = walk->recordCapacity ? walk->recordCapacity * 2 : 1024;
+        struct Record* records  = (struct Record*)realloc(walk->records, capacity * sizeof(struct Record));
+        if (!records)
+        {
+            walk->result = FSEQ_FALSE;
+            return;
+        }
+        walk->records        = records;
+        walk->recordCapacity = capacity;
+    }
+    record        = &walk->records[walk->recordCount];
+    record->name  = (char*)malloc(strlen(name) + 1);
+    record->bytes = bytes;
+    record->files = files;
+    if (!record->name)
+    {
+        walk->result = FSEQ_FALSE;
+        return;
+    }
+    memcpy(record->name, name, strlen(name) + 1);
+    ++walk->recordCount;
+}
+
+// Measure a directory and its subdirectories. The path buffer is shared by
+// every level, the names are appended to it and removed on return.
+void walkDir(struct Walk* walk, char* path, size_t len, struct FSeqDiskUsage* out)
+{
+    struct FSeqDirEntry*  entries = NULL;
+    struct FSeqDirEntry*  entry   = NULL;
+    struct FSeqDiskUsage* usage   = NULL;
+    size_t                count   = 0;
+    size_t                i       = 0;
+    FSeqBool              error   = FSEQ_FALSE;
+    static char           buf[FSEQ_STRING_LEN];
+
+    fseqDiskUsageInit(out);
+    entries = fseqDirList(path, &walk->dirOptions, &error);
+    if (error)
+    {
+        fprintf(stderr, "cannot list %s\n", path);
+        walk->result = FSEQ_FALSE;
+    }
+    for (entry = entries; entry; entry = entry->next)
+    {
+        ++count;
+    }
+    usage = (struct FSeqDiskUsage*)malloc((count + 1) * sizeof(struct FSeqDiskUsage));
+    if (!usage)
+    {
+        fseqDirListDel(entries);
+        walk->result = FSEQ_FALSE;
+        return;
+    }
+    if (!fseqDiskUsage(path, entries, usage, &walk->options, NULL))
+    {
+        fprintf(stderr, "cannot read the files in %s\n", path);
+        walk->result = FSEQ_FALSE;
+    }
+
+    for (entry = entries, i = 0; entry; entry = entry->next, ++i)
+    {
+        const size_t sep     = len > 0 && path[len - 1] != '/' ? 1 : 0;
+        size_t       nameLen = 0;
+        fseqDirEntryToString(entry, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
+        nameLen = strlen(buf);
+        if (len + sep + nameLen >= FSEQ_STRING_LEN)
+        {
+            fprintf(stderr, "path too long: %s/%s\n", path, buf);
+            walk->result = FSEQ_FALSE;
+            continue;
+        }
+        path[len] = '/';
+        memcpy(path + len + sep, buf, nameLen + 1);
+        if (FSEQ_FILE_TYPE_DIR == entry->type)
+        {
+            walkDir(walk, path, len + sep + nameLen, &usage[i]);
+        }
+        else if (!walk->dirs)
+        {
+            recordAdd(walk, path, usage[i].bytes, usage[i].files);
+        }
+        path[len] = 0;
+        out->bytes   += usage[i].bytes;
+        out->files   += usage[i].files;
+        out->missing += usage[i].missing;
+        out->failed  += usage[i].failed;
+    }
+    free(usage);
+    fseqDirListDel(entries);
+
+    if (walk->dirs)
+    {
+        recordAdd(walk, path, out->bytes, out->files);
+    }
+}
+
+// Format a number of bytes with a binary unit suffix.
+void formatBytes(int64_t value, FSeqBool human, char* out, size_t max)
+{
+    static const char units[] = "KMGTPE";
+    double            d       = (double)value;
+    int               unit    = -1;
+    if (!human || value < 1024)
+    {
+        snprintf(out, max, "%" PRId64, value);
+        return;
+    }
+    while (d >= 1024.0 && unit < 5)
+    {
+        d /= 1024.0;
+        ++unit;
+    }
+    snprintf(out, max, d < 10.0 ? "%.1f%c" : "%.0f%c", d, units[unit]);
+}
+
+void printUsage()
+{
+    printf("usage: fseqdu [-d] [-b] [-h] [-c] [-n count] [-j threads] [-r rate] [path ...]\n");
+    printf("Print the disk usage of the file sequences in directory trees, largest\n");
+    printf("first. Each line has the number of bytes, the number of files, and the name.\n");
+    printf("  -d  Print the directories, including their subdirectories, instead of the\n");
+    printf("      sequences\n");
+    printf("  -b  Count the file sizes instead of the allocated blocks\n");
+    printf("  -h  Human readable sizes (K, M, G, ...)\n");
+    printf("  -c  Print the total for all of the paths\n");
+    printf("  -n  Only print the largest count entries\n");
+    printf("  -j  The number of threads (default 16)\n");
+    printf("  -r  Limit the directory reads and file status to rate operations per second,\n");
+    printf("      and print the time spent waiting\n");
+}
+
+int main(int argc, char** argv)
+{
+    struct Walk          walk;
+    struct FSeqDiskUsage total;
+    struct FSeqThrottle* throttle  = NULL;
+    int64_t              throttled = 0;
+    FSeqBool             human     = FSEQ_FALSE;
+    FSeqBool             printSum  = FSEQ_FALSE;
+    int                  i         = 1;
+    static char          path[FSEQ_STRING_LEN];
+    static char          buf[64];
+
+    memset(&walk, 0, sizeof(struct Walk));
+    fseqDirOptionsInit(&walk.dirOptions);
+    walk.dirOptions.dotFiles       = FSEQ_TRUE;
+    walk.dirOptions.splitFileNames = FSEQ_FALSE;
+    walk.dirOptions.frames         = FSEQ_TRUE;
+    fseqDiskUsageOptionsInit(&walk.options);
+    walk.result = FSEQ_TRUE;
+
+    // Parse the command line options.
+    for (; i < argc && '-' == argv[i][0] && argv[i][1]; ++i)
+    {
+        if (0 == strcmp(argv[i], "-d"))
+        {
+            walk.dirs = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-b"))
+        {
+            walk.options.apparent = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-h"))
+        {
+            human = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-c"))
+        {
+            printSum = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            walk.max = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "-j") && i + 1 < argc)
+        {
+            walk.options.threads = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "-r") && i + 1 < argc && !throttle)
+        {
+            throttle = fseqThrottleCreate(strtod(argv[++i], NULL), 0.0, NULL);
+            if (!throttle)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // The directory reads and the file status share the throttle.
+    walk.dirOptions.throttle  = throttle;
+    walk.dirOptions.throttled = &throttled;
+    walk.options.throttle     = throttle;
+    walk.options.throttled    = &throttled;
+
+    // Walk the directories.
+    fseqDiskUsageInit(&total);
+    do
+    {
+        struct FSeqDiskUsage usage;
+        const char*          arg = i < argc ? argv[i] : ".";
+        const size_t         len = strlen(arg);
+        if (len >= FSEQ_STRING_LEN)
+        {
+            fprintf(stderr, "path too long: %.64s...\n", arg);
+            walk.result = FSEQ_FALSE;
+            continue;
+        }
+        memcpy(path, arg, len + 1);
+        walkDir(&walk, path, len, &usage);
+        total.bytes += usage.bytes;
+        total.files += usage.files;
+    }
+    while (++i < argc);
+
+    // Print the records.
+    recordsSort(&walk);
+    for (size_t j = 0; j < walk.recordCount; ++j)
+    {
+        formatBytes(walk.records[j].bytes, human, buf, 64);
+        printf("%s\t%" PRId64 "\t%s\n", buf, walk.records[j].files, walk.records[j].name);
+        free(walk.records[j].name);
+    }
+    free(walk.records);
+    if (printSum)
+    {
+        formatBytes(total.bytes, human, buf, 64);
+        printf("%s\t%" PRId64 "\ttotal\n", buf, total.files);
+    }
+    if (throttle)
+    {
+        fprintf(stderr, "throttled for %.1f seconds\n", (double)throttled / 1000000.0);
+        fseqThrottleDel(throttle);
+    }
+
+    return walk.result ? 0 : 1;
+}
@@ -0,0 +1,435 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2019-2021 Darby Johnston
+// All rights reserved.
+
+#include "fseq.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else // WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+// The output is written through a single large buffer instead of calling
+// printf() for each line.
+#define WRITER_SIZE (1024 * 1024)
+
+static char   writerBuf[WRITER_SIZE];
+static size_t writerSize = 0;
+
+static void writerFlush()
+{
+    fwrite(writerBuf, 1, writerSize, stdout);
+    writerSize = 0;
+}
+
+static void writeData(const char* value, size_t size)
+{
+    if (writerSize + size > WRITER_SIZE)
+    {
+        writerFlush();
+        if (size > WRITER_SIZE)
+        {
+            fwrite(value, 1, size, stdout);
+            return;
+        }
+    }
+    memcpy(writerBuf + writerSize, value, size);
+    writerSize += size;
+}
+
+static void writeString(const char* value)
+{
+    writeData(value, strlen(value));
+}
+
+static void writeChar(char value)
+{
+    if (writerSize == WRITER_SIZE)
+    {
+        writerFlush();
+    }
+    writerBuf[writerSize++] = value;
+}
+
+static void writeInt(int64_t value)
+{
+    char buf[32];
+    const int len = snprintf(buf, 32, "%" PRId64, value);
+    writeData(buf, (size_t)len);
+}
+
+// This struct provides the contents of the input, either mapped into memory
+// or read into a buffer.
+struct Input
+{
+    const char* data;
+    size_t      size;
+    FSeqBool    mapped;
+#if defined(WIN32) || defined(_WIN32)
+    HANDLE      file;
+    HANDLE      mapping;
+#endif // WIN32
+};
+
+static FSeqBool inputRead(FILE* f, struct Input* out)
+{
+    char*  buf      = NULL;
+    size_t capacity = 0;
+    size_t count    = 0;
+    while (!feof(f))
+    {
+        if (capacity - out->size < WRITER_SIZE)
+        {
+            capacity = capacity ? capacity * 2 : WRITER_SIZE * 2;
+            buf = (char*)realloc((void*)out->data, capacity);
+            if (!buf)
+            {
+                return FSEQ_FALSE;
+            }
+            out->data = buf;
+        }
+        count = fread((char*)out->data + out->size, 1, capacity - out->size, f);
+        if (0 == count && ferror(f))
+        {
+            return FSEQ_FALSE;
+        }
+        out->size += count;
+    }
+    return FSEQ_TRUE;
+}
+
+static FSeqBool inputOpen(const char* fileName, struct Input* out)
+{
+    memset(out, 0, sizeof(struct Input));
+    if (!fileName)
+    {
+        return inputRead(stdin, out);
+    }
+
+#if defined(WIN32) || defined(_WIN32)
+
+    {
+        LARGE_INTEGER size;
+        int           wLen = MultiByteToWideChar(CP_UTF8, 0, fileName, -1, NULL, 0);
+        wchar_t*      wBuf = malloc(wLen * sizeof(wchar_t));
+        MultiByteToWideChar(CP_UTF8, 0, fileName, -1, wBuf, wLen);
+        out->file = CreateFileW(
+            wBuf,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_FLAG_SEQUENTIAL_SCAN,
+            NULL);
+        free(wBuf);
+        if (INVALID_HANDLE_VALUE == out->file || !GetFileSizeEx(out->file, &size))
+        {
+            return FSEQ_FALSE;
+        }
+        out->size = (size_t)size.QuadPart;
+        if (out->size > 0)
+        {
+            out->mapping = CreateFileMappingW(out->file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (!out->mapping)
+            {
+                return FSEQ_FALSE;
+            }
+            out->data = (const char*)MapViewOfFile(out->mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!out->data)
+            {
+                return FSEQ_FALSE;
+            }
+            out->mapped = FSEQ_TRUE;
+        }
+    }
+
+#else // WIN32
+
+    {
+        struct stat st;
+        const int   fd = open(fileName, O_RDONLY);
+        if (-1 == fd)
+        {
+            return FSEQ_FALSE;
+        }
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            return FSEQ_FALSE;
+        }
+        if (!S_ISREG(st.st_mode))
+        {
+            // Pipes and other special files cannot be mapped.
+            FILE*    f      = fdopen(fd, "rb");
+            FSeqBool result = f ? inputRead(f, out) : FSEQ_FALSE;
+            if (f)
+            {
+                fclose(f);
+            }
+            return result;
+        }
+        out->size = (size_t)st.st_size;
+        if (out->size > 0)
+        {
+            void* data = mmap(NULL, out->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED == data)
+            {
+                close(fd);
+                return FSEQ_FALSE;
+            }
+#if defined(MADV_SEQUENTIAL)
+            madvise(data, out->size, MADV_SEQUENTIAL);
+#endif // MADV_SEQUENTIAL
+            out->data = (const char*)data;
+            out->mapped = FSEQ_TRUE;
+        }
+        close(fd);
+    }
+
+#endif // WIN32
+
+    return FSEQ_TRUE;
+}
+
+static void inputClose(struct Input* value)
+{
+#if defined(WIN32) || defined(_WIN32)
+    if (value->mapped)
+    {
+        UnmapViewOfFile(value->data);
+    }
+    else
+    {
+        free((void*)value->data);
+    }
+    if (value->mapping)
+    {
+        CloseHandle(value->mapping);
+    }
+    if (value->file && value->file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(value->file);
+    }
+#else // WIN32
+    if (value->mapped)
+    {
+        munmap((void*)value->data, value->size);
+    }
+    else
+    {
+        free((void*)value->data);
+    }
+#endif // WIN32
+}
+
+// This struct provides a set of the paths that have been grouped, so
+// repeated paths are only counted once. The paths point into the input.
+struct PathSet
+{
+    const char** paths;
+    size_t*      lens;
+    size_t       size;
+};
+
+static FSeqBool pathSetInit(struct PathSet* value, const struct Input* input, char delimiter)
+{
+    size_t count = 1;
+    for (const char* p = input->data, *end = input->data + input->size;
+        (p = (const char*)memchr(p, delimiter, end - p)); ++p)
+    {
+        ++count;
+    }
+    value->size = 1;
+    while (value->size < count * 2)
+    {
+        value->size *= 2;
+    }
+    value->paths = (const char**)calloc(value->size, sizeof(const char*));
+    value->lens  = (size_t*)calloc(value->size, sizeof(size_t));
+    return value->paths && value->lens;
+}
+
+static void pathSetDel(struct PathSet* value)
+{
+    free(value->paths);
+    free(value->lens);
+}
+
+// Add a path to the set.
+// Returns:
+// * Whether the path was added, or false if it is already in the set
+static FSeqBool pathSetAdd(struct PathSet* value, const char* path, size_t len)
+{
+    size_t i = (size_t)fseqHash64(path, len, 0) & (value->size - 1);
+    for (; value->paths[i]; i = (i + 1) & (value->size - 1))
+    {
+        if (len == value->lens[i] && 0 == memcmp(path, value->paths[i], len))
+        {
+            return FSEQ_FALSE;
+        }
+    }
+    value->paths[i] = path;
+    value->lens[i]  = len;
+    return FSEQ_TRUE;
+}
+
+static void printUsage()
+{
+    printf("usage: fseqgroup [-0] [-l] [file]\n");
+    printf("Group a list of paths into file sequences. The paths are read from\n");
+    printf("the file, or the standard input if no file is given. Repeated paths\n");
+    printf("are only counted once.\n");
+    printf("  -0  Paths separated by NUL characters instead of new lines\n");
+    printf("  -l  Long output: frame count, minimum, maximum, padding, missing, and name\n");
+}
+
+int main(int argc, char** argv)
+{
+    struct FSeqDirOptions options;
+    struct Input          input;
+    struct PathSet        paths;
+    struct FSeqGroup*     group     = NULL;
+    struct FSeqDirEntry*  entries   = NULL;
+    struct FSeqDirEntry*  entry     = NULL;
+    const char*           fileName  = NULL;
+    char                  delimiter = '\n';
+    FSeqBool              longMode  = FSEQ_FALSE;
+    FSeqBool              error     = FSEQ_FALSE;
+    int                   result    = 0;
+    int                   i         = 1;
+
+    fseqDirOptionsInit(&options);
+    options.splitFileNames = FSEQ_FALSE;
+
+    // Parse the command line options.
+    for (; i < argc && '-' == argv[i][0] && argv[i][1]; ++i)
+    {
+        if (0 == strcmp(argv[i], "-0"))
+        {
+            delimiter = 0;
+        }
+        else if (0 == strcmp(argv[i], "-l"))
+        {
+            longMode = FSEQ_TRUE;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (i < argc)
+    {
+        fileName = argv[i++];
+    }
+    if (i < argc)
+    {
+        printUsage();
+        return 1;
+    }
+
+    // Read the input.
+    if (!inputOpen(fileName, &input))
+    {
+        fprintf(stderr, "cannot read %s\n", fileName ? fileName : "standard input");
+        inputClose(&input);
+        return 1;
+    }
+
+    // Group the paths in place, lines are never copied.
+    memset(&paths, 0, sizeof(struct PathSet));
+    if (!pathSetInit(&paths, &input, delimiter))
+    {
+        error = FSEQ_TRUE;
+    }
+    else
+    {
+        group = fseqGroupCreate(&options, &error);
+    }
+    if (group)
+    {
+        const char*       p   = input.data;
+        const char* const end = input.data + input.size;
+        while (p < end)
+        {
+            const char* next = (const char*)memchr(p, delimiter, end - p);
+            size_t      len  = 0;
+            if (!next)
+            {
+                next = end;
+            }
+            len = next - p;
+            if (len > 0 && '\n' == delimiter && '\r' == p[len - 1])
+            {
+                --len;
+            }
+            if (len >= FSEQ_STRING_LEN)
+            {
+                fprintf(stderr, "path too long: %.64s...\n", p);
+                result = 1;
+            }
+            else if (len > 0 &&
+                pathSetAdd(&paths, p, len) &&
+                !fseqGroupAdd(group, p, len, FSEQ_FILE_TYPE_UNKNOWN))
+            {
+                error = FSEQ_TRUE;
+                break;
+            }
+            p = next + 1;
+        }
+        if (!error)
+        {
+            entries = fseqGroupList(group, &error);
+        }
+        fseqGroupDel(group);
+    }
+    pathSetDel(&paths);
+    inputClose(&input);
+    if (error)
+    {
+        fprintf(stderr, "cannot group paths\n");
+        fseqDirListDel(entries);
+        return 1;
+    }
+
+    // Print the sequences.
+    for (entry = entries; entry; entry = entry->next)
+    {
+        static char buf[FSEQ_STRING_LEN];
+        fseqDirEntryToString(entry, buf, FSEQ_TRUE, FSEQ_STRING_LEN);
+        if (longMode)
+        {
+            const int64_t missing = entry->sizes.number ?
+                FSEQ_MAX(entry->frameMax - entry->frameMin + 1 - entry->frameCount, 0) :
+                0;
+            writeInt(entry->frameCount);
+            writeChar('\t');
+            writeInt(entry->frameMin);
+            writeChar('\t');
+            writeInt(entry->frameMax);
+            writeChar('\t');
+            writeInt(entry->framePadding);
+            writeChar('\t');
+            writeInt(missing);
+            writeChar('\t');
+        }
+        writeString(buf);
+        writeChar(delimiter);
+    }
+    writerFlush();
+    fseqDirListDel(entries);
+
+    return result;
+}
@@ -4,54 +4,474 @@
 
 #include "fseq.h"
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-void printDir(const char* path, const struct FSeqDirOptions* options)
+// Output modes.
+#define OUTPUT_DEFAULT 0
+#define OUTPUT_LONG    1
+#define OUTPUT_JSON    2
+#define OUTPUT_NUL     3
+#define OUTPUT_SUM     4
+#define OUTPUT_SUMS    5
+
+// The output is written through a single large buffer instead of calling
+// printf() for each line.
+#define WRITER_SIZE (1024 * 1024)
+
+static char   writerBuf[WRITER_SIZE];
+static size_t writerSize = 0;
+
+void writerFlush()
+{
+    fwrite(writerBuf, 1, writerSize, stdout);
+    writerSize = 0;
+}
+
+void writeData(const char* value, size_t size)
+{
+    if (writerSize + size > WRITER_SIZE)
+    {
+        writerFlush();
+        if (size > WRITER_SIZE)
+        {
+            fwrite(value, 1, size, stdout);
+            return;
+        }
+    }
+    memcpy(writerBuf + writerSize, value, size);
+    writerSize += size;
+}
+
+void writeString(const char* value)
+{
+    writeData(value, strlen(value));
+}
+
+void writeChar(char value)
+{
+    if (writerSize == WRITER_SIZE)
+    {
+        writerFlush();
+    }
+    writerBuf[writerSize++] = value;
+}
+
+void writeInt(int64_t value)
+{
+    char buf[32];
+    const int len = snprintf(buf, 32, "%" PRId64, value);
+    writeData(buf, (size_t)len);
+}
+
+void writeHex(uint64_t value)
+{
+    char buf[32];
+    const int len = snprintf(buf, 32, "%016" PRIx64, value);
+    writeData(buf, (size_t)len);
+}
+
+// Get the length of the UTF-8 sequence at the start of a string, or zero if
+// it is not valid. Overlong encodings, surrogates, and code points past
+// U+10FFFF are not valid.
+size_t utf8Length(const unsigned char* value)
+{
+    size_t   len = 0;
+    uint32_t min = 0;
+    uint32_t c   = 0;
+    if (value[0] >= 0xc2 && value[0] <= 0xdf)
+    {
+        len = 2;
+        min = 0x80;
+        c   = value[0] & 0x1f;
+    }
+    else if (value[0] >= 0xe0 && value[0] <= 0xef)
+    {
+        len = 3;
+        min = 0x800;
+        c   = value[0] & 0x0f;
+    }
+    else if (value[0] >= 0xf0 && value[0] <= 0xf4)
+    {
+        len = 4;
+        min = 0x10000;
+        c   = value[0] & 0x07;
+    }
+    else
+    {
+        return 0;
+    }
+    for (size_t i = 1; i < len; ++i)
+    {
+        if ((value[i] & 0xc0) != 0x80)
+        {
+            return 0;
+        }
+        c = (c << 6) | (value[i] & 0x3f);
+    }
+    if (c < min || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+    {
+        return 0;
+    }
+    return len;
+}
+
+// Write a JSON string. File names are not always valid UTF-8, so each byte
+// that is not part of a valid UTF-8 sequence is escaped as a lone low
+// surrogate, "\udc80" to "\udcff", like the Python surrogateescape error
+// handler. The original bytes can be recovered from the escapes.
+void writeJSONString(const char* value)
+{
+    writeChar('"');
+    while (*value)
+    {
+        const unsigned char c   = (unsigned char)*value;
+        size_t              len = 1;
+        if ('"' == c || '\\' == c)
+        {
+            writeChar('\\');
+            writeChar((char)c);
+        }
+        else if (c < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, 8, "\\u%04x", c);
+            writeData(buf, 6);
+        }
+        else if (c < 0x80)
+        {
+            writeChar((char)c);
+        }
+        else if ((len = utf8Length((const unsigned char*)value)) > 0)
+        {
+            writeData(value, len);
+        }
+        else
+        {
+            char buf[8];
+            snprintf(buf, 8, "\\udc%02x", c);
+            writeData(buf, 6);
+            len = 1;
+        }
+        value += len;
+    }
+    writeChar('"');
+}
+
+void writeName(const char* path, const char* name, FSeqBool fullPath)
+{
+    if (fullPath)
+    {
+        const size_t len = strlen(path);
+        writeString(path);
+        if (len > 0 && path[len - 1] != '/' && path[len - 1] != '\\')
+        {
+            writeChar('/');
+        }
+    }
+    writeString(name);
+}
+
+const char* typeName(FSeqFileType value)
+{
+    switch (value)
+    {
+    case FSEQ_FILE_TYPE_FILE: return "file";
+    case FSEQ_FILE_TYPE_DIR: return "dir";
+    case FSEQ_FILE_TYPE_LINK: return "link";
+    case FSEQ_FILE_TYPE_OTHER: return "other";
+    default: break;
+    }
+    return "unknown";
+}
+
+char typeChar(FSeqFileType value)
+{
+    switch (value)
+    {
+    case FSEQ_FILE_TYPE_FILE: return '-';
+    case FSEQ_FILE_TYPE_DIR: return 'd';
+    case FSEQ_FILE_TYPE_LINK: return 'l';
+    case FSEQ_FILE_TYPE_OTHER: return 'o';
+    default: break;
+    }
+    return '?';
+}
+
+static FSeqBool firstJSON = FSEQ_TRUE;
+
+// Write the checksums of a directory entry.
+FSeqBool printChecksums(
+    const char*                entryPath,
+    const struct FSeqDirEntry* entry,
+    const char*                name,
+    int                        mode,
+    FSeqBool                   fullPath)
+{
+    struct FSeqChecksums checksums;
+    FSeqBool             result = FSEQ_TRUE;
+
+    fseqChecksumsInit(&checksums);
+    result = fseqChecksum(entryPath, entry, &checksums, NULL, NULL);
+    if (OUTPUT_SUMS == mode)
+    {
+        for (size_t i = 0; i < checksums.frameCount; ++i)
+        {
+            static char buf[FSEQ_STRING_LEN];
+            fseqDirEntryFrameName(entry, checksums.frames[i].frame, FSEQ_FALSE, buf, FSEQ_STRING_LEN);
+            if (checksums.frames[i].error)
+            {
+                writerFlush();
+                fprintf(stderr, "cannot read %s\n", buf);
+                continue;
+            }
+            writeHex(checksums.frames[i].digest);
+            writeString("  ");
+            writeName(entryPath, buf, fullPath);
+            writeChar('\n');
+        }
+    }
+    else if (result)
+    {
+        writeHex(checksums.digest);
+        writeString("  ");
+        writeName(entryPath, name, fullPath);
+        writeChar('\n');
+    }
+    else
+    {
+        writerFlush();
+        fprintf(stderr, "cannot read %s\n", name);
+    }
+    fseqChecksumsDel(&checksums);
+    return result;
+}
+
+// The connection to the listing daemon, if enabled.
+static struct FSeqDaemonClient* daemonClient = NULL;
+
+// Whether the inputs are tar archives instead of directories.
+static FSeqBool archive = FSEQ_FALSE;
+
+FSeqBool printDir(
+    const char*                  path,
+    const struct FSeqDirOptions* options,
+    int                          mode,
+    FSeqBool                     fullPath)
 {
     struct FSeqDirEntry* entries = NULL;
     struct FSeqDirEntry* entry   = NULL;
     FSeqBool             error   = FSEQ_FALSE;
+    FSeqBool             result  = FSEQ_TRUE;
 
-    entries = fseqDirList(path, options, &error);
+    if (archive)
+    {
+        entries = fseqArchiveList(path, options, &error);
+    }
+    else if (daemonClient)
+    {
+        entries = fseqDaemonList(daemonClient, path, options, &error);
+    }
+    if (!archive && (!daemonClient || error))
+    {
+        // Fall back to listing the directory directly.
+        fseqDirListDel(entries);
+        error = FSEQ_FALSE;
+        entries = fseqDirList(path, options, &error);
+    }
     if (error)
     {
-        printf("cannot read %s\n", path);
-        return;
+        fseqDirListDel(entries);
+        writerFlush();
+        fprintf(stderr, "cannot read %s\n", path);
+        return FSEQ_FALSE;
     }
 
     entry = entries;
     while (entry)
     {
         static char buf[FSEQ_STRING_LEN];
+        const int64_t missing = entry->sizes.number ?
+            FSEQ_MAX(entry->frameMax - entry->frameMin + 1 - entry->frameCount, 0) :
+            0;
         fseqDirEntryToString(entry, buf, FSEQ_FALSE, FSEQ_STRING_LEN);
-        printf("%s\n", buf);
+        switch (mode)
+        {
+        case OUTPUT_LONG:
+            writeChar(typeChar(entry->type));
+            writeChar('\t');
+            writeInt(entry->frameCount);
+            writeChar('\t');
+            writeInt(entry->frameMin);
+            writeChar('\t');
+            writeInt(entry->frameMax);
+            writeChar('\t');
+            writeInt(entry->framePadding);
+            writeChar('\t');
+            writeInt(missing);
+            writeChar('\t');
+            writeName(path, buf, fullPath);
+            writeChar('\n');
+            break;
+        case OUTPUT_JSON:
+            writeString(firstJSON ? "\n" : ",\n");
+            firstJSON = FSEQ_FALSE;
+            writeString("{\"dir\":");
+            writeJSONString(path);
+            writeString(",\"name\":");
+            writeJSONString(buf);
+            writeString(",\"type\":");
+            writeJSONString(typeName(entry->type));
+            writeString(",\"base\":");
+            writeJSONString(entry->fileName.base);
+            writeString(",\"number\":");
+            writeJSONString(entry->fileName.number);
+            writeString(",\"extension\":");
+            writeJSONString(entry->fileName.extension);
+            writeString(",\"frameMin\":");
+            writeInt(entry->frameMin);
+            writeString(",\"frameMax\":");
+            writeInt(entry->frameMax);
+            writeString(",\"framePadding\":");
+            writeInt(entry->framePadding);
+            writeString(",\"frameCount\":");
+            writeInt(entry->frameCount);
+            writeString(",\"missing\":");
+            writeInt(missing);
+            writeChar('}');
+            break;
+        case OUTPUT_SUM:
+        case OUTPUT_SUMS:
+            if (entry->type != FSEQ_FILE_TYPE_DIR)
+            {
+                result &= printChecksums(path, entry, buf, mode, fullPath);
+            }
+            break;
+        case OUTPUT_NUL:
+            writeName(path, buf, fullPath);
+            writeChar(0);
+            break;
+        default:
+            writeName(path, buf, fullPath);
+            writeChar('\n');
+            break;
+        }
         entry = entry->next;
     }
 
     fseqDirListDel(entries);
+    return result;
+}
+
+void printUsage()
+{
+    printf("usage: fseqls [-l | -json | -0 | -sum | -sums] [-p] [-d | -t] (directories | archives)\n");
+    printf("  -l     Long output: type, frame count, minimum, maximum, padding, missing, and name\n");
+    printf("  -json  JSON output; bytes that are not UTF-8 are escaped as \\udc80-\\udcff\n");
+    printf("  -0     Names separated by NUL characters\n");
+    printf("  -sum   Checksum of each sequence\n");
+    printf("  -sums  Checksum of each frame\n");
+    printf("  -p     Include the directory in the names\n");
+    printf("  -d     List through the fseqd daemon if it is running\n");
+    printf("  -t     List the contents of tar archives\n");
 }
 
 int main(int argc, char** argv)
 {
     struct FSeqDirOptions options;
+    int                   mode     = OUTPUT_DEFAULT;
+    FSeqBool              fullPath = FSEQ_FALSE;
+    FSeqBool              daemon   = FSEQ_FALSE;
+    FSeqBool              result   = FSEQ_TRUE;
+    int                   i        = 1;
 
     fseqDirOptionsInit(&options);
 
-    if (argc > 1)
+    // Parse the command line options.
+    for (; i < argc && '-' == argv[i][0] && argv[i][1]; ++i)
+    {
+        if (0 == strcmp(argv[i], "-l"))
+        {
+            mode = OUTPUT_LONG;
+        }
+        else if (0 == strcmp(argv[i], "-json"))
+        {
+            mode = OUTPUT_JSON;
+        }
+        else if (0 == strcmp(argv[i], "-0"))
+        {
+            mode = OUTPUT_NUL;
+        }
+        else if (0 == strcmp(argv[i], "-sum"))
+        {
+            mode = OUTPUT_SUM;
+        }
+        else if (0 == strcmp(argv[i], "-sums"))
+        {
+            mode = OUTPUT_SUMS;
+        }
+        else if (0 == strcmp(argv[i], "-p"))
+        {
+            fullPath = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-d"))
+        {
+            daemon = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-t"))
+        {
+            archive = FSEQ_TRUE;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // The frames in an archive cannot be read.
+    if (archive && (OUTPUT_SUM == mode || OUTPUT_SUMS == mode))
+    {
+        printUsage();
+        return 1;
+    }
+
+    // Only the JSON output needs the file name components.
+    options.splitFileNames = OUTPUT_JSON == mode;
+
+    // Only checksum the frames that exist.
+    options.frames = OUTPUT_SUM == mode || OUTPUT_SUMS == mode;
+
+    if (daemon)
+    {
+        daemonClient = fseqDaemonConnect(NULL, NULL);
+    }
+
+    if (OUTPUT_JSON == mode)
+    {
+        writeChar('[');
+    }
+    if (i < argc)
     {
         // List the input directories.
-        for (int i = 1; i < argc; ++i)
+        for (; i < argc; ++i)
         {
-            printDir(argv[i], &options);
+            result &= printDir(argv[i], &options, mode, fullPath);
         }
     }
     else
     {
         // List the current directory.
-        printDir(".", &options);
+        result = printDir(".", &options, mode, fullPath);
+    }
+    if (OUTPUT_JSON == mode)
+    {
+        writeString("\n]\n");
     }
+    writerFlush();
+    fseqDaemonDisconnect(daemonClient);
 
-    return 0;
+    return result ? 0 : 1;
 }
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2019-2021 Darby Johnston
+// All rights reserved.
+
+#include "fseq.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+FSeqBool removeSequences(
+    const char*                     value,
+    const struct FSeqRemoveOptions* options,
+    FSeqBool                        verbose)
+{
+    struct FSeqDirEntry* entries = NULL;
+    struct FSeqDirEntry* entry   = NULL;
+    FSeqBool             error   = FSEQ_FALSE;
+    FSeqBool             result  = FSEQ_TRUE;
+
+    entries = fseqDirEntryParse(value, FSEQ_STRING_LEN, NULL, &error);
+    if (error)
+    {
+        fprintf(stderr, "cannot parse %s\n", value);
+        fseqDirListDel(entries);
+        return FSEQ_FALSE;
+    }
+    for (entry = entries; entry; entry = entry->next)
+    {
+        static char             buf[FSEQ_STRING_LEN];
+        struct FSeqRemoveResult counts;
+        fseqDirEntryToString(entry, buf, FSEQ_TRUE, FSEQ_STRING_LEN);
+        if (0 == entry->frameCount)
+        {
+            fprintf(stderr, "no frame range given for %s\n", buf);
+            result = FSEQ_FALSE;
+            continue;
+        }
+        if (!fseqRemove(NULL, entry, &counts, options, NULL))
+        {
+            result = FSEQ_FALSE;
+        }
+        if (verbose || counts.failed > 0)
+        {
+            printf(
+                "%" PRId64 "\t%" PRId64 "\t%" PRId64 "\t%s\n",
+                counts.removed,
+                counts.missing,
+                counts.failed,
+                buf);
+        }
+    }
+    fseqDirListDel(entries);
+    return result;
+}
+
+void printUsage()
+{
+    printf("usage: fseqrm [-n] [-v] [-j threads] (sequences | -)\n");
+    printf("Remove every frame of file sequences, for example:\n");
+    printf("    fseqrm /show/render.0001-0100.exr\n");
+    printf("    fseqls -p /show | grep v001 | fseqrm -\n");
+    printf("  -n  Dry run, count the frames that would be removed (implies -v)\n");
+    printf("  -v  Print the number of frames removed, missing, and failed, and the name\n");
+    printf("  -j  The number of threads (default 16)\n");
+    printf("  -   Read the sequences from the standard input, one per line\n");
+}
+
+int main(int argc, char** argv)
+{
+    struct FSeqRemoveOptions options;
+    FSeqBool                 verbose = FSEQ_FALSE;
+    FSeqBool                 result  = FSEQ_TRUE;
+    int                      i       = 1;
+
+    fseqRemoveOptionsInit(&options);
+
+    // Parse the command line options.
+    for (; i < argc && '-' == argv[i][0] && argv[i][1]; ++i)
+    {
+        if (0 == strcmp(argv[i], "-n"))
+        {
+            options.dryRun = FSEQ_TRUE;
+            verbose = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-v"))
+        {
+            verbose = FSEQ_TRUE;
+        }
+        else if (0 == strcmp(argv[i], "-j") && i + 1 < argc)
+        {
+            options.threads = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (i == argc)
+    {
+        printUsage();
+        return 1;
+    }
+
+    for (; i < argc; ++i)
+    {
+        if (0 == strcmp(argv[i], "-"))
+        {
+            static char line[FSEQ_STRING_LEN];
+            while (fgets(line, FSEQ_STRING_LEN, stdin))
+            {
+                size_t len = strlen(line);
+                while (len > 0 && ('\n' == line[len - 1] || '\r' == line[len - 1]))
+                {
+                    line[--len] = 0;
+                }
+                if (len > 0)
+                {
+                    result &= removeSequences(line, &options, verbose);
+                }
+            }
+        }
+        else
+        {
+            result &= removeSequences(argv[i], &options, verbose);
+        }
+    }
+
+    return result ? 0 : 1;
+}